@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+namespace RenderEngine {
+
+/**
+ * @brief Heap allocation counters, process-wide and per thread
+ * 
+ * When the engine is built with RENDERENGINE_COUNT_ALLOCATIONS the global
+ * operator new, including its aligned forms, is replaced with a counting
+ * version, which lets the game verify that its steady-state loop does not
+ * touch the heap. In regular builds the replacement is compiled out and
+ * the counts always read zero.
+ *
+ * getThreadCount() only sees the calling thread, so a delta taken around
+ * the game loop is not disturbed by loader or parser workers allocating
+ * at the same time; getCount() includes every thread.
+ *
+ * The peak resident set size comes from the OS and is always available
+ * (0 where the platform does not report it); loaders use it to report
+ * their memory cost.
+ */
+class AllocationCounter {
+public:
+    static bool isEnabled();
+    static std::uint64_t getCount();
+    static std::uint64_t getThreadCount();
+    static std::uint64_t getPeakResidentBytes();
+};
+
+} // namespace RenderEngine
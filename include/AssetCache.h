@@ -0,0 +1,121 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+namespace RenderEngine {
+
+class Model;
+
+/**
+ * @brief Counters of an AssetCache since it was created
+ */
+struct AssetCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    size_t residentBytes = 0;   // Geometry of all cached models
+    size_t budgetBytes = 0;
+    size_t entryCount = 0;
+};
+
+/**
+ * @brief Shares models built from the same source or parameters
+ *
+ * Models are keyed by a string naming what they were built from: the
+ * factory and its parameters, such as "sphere:32:3", or the kind, content
+ * hash and size of a loaded file, so the same geometry loaded from two
+ * paths is uploaded once. Every caller asking for a key gets the same
+ * model, which must therefore be treated as immutable.
+ *
+ * Content keys are not verified against the bytes: two files of the same
+ * kind and size whose 64-bit FNV-1a hashes match would share one model.
+ * FNV-1a is not collision resistant, so this is only safe for assets the
+ * game ships, not for content an adversary can choose; by chance alone,
+ * a million distinct files of one size collide with odds near 1 in 4e7.
+ *
+ * Hashing means reading the whole file, so loaders first look a file up
+ * by its path, modification time and size (findFile()) and hash it only
+ * on a miss; addFileKey() then remembers which content the file held.
+ *
+ * Entries are kept in least recently used order. Whenever the geometry
+ * of all entries exceeds the budget, trim() drops the oldest entries
+ * whose model and meshes no one else holds. Dropping the last reference
+ * releases the meshes' GeometryArena allocations, and the arena frees
+ * pages left empty, so the budget holds for GPU memory too; models still
+ * in use stay resident even over budget.
+ *
+ * The Renderer owns the cache, makes it current for its lifetime and
+ * trims it at the end of every frame; the Model factories and loaders go
+ * through the current cache.
+ */
+class AssetCache {
+public:
+    static constexpr size_t kDefaultBudgetBytes = 256 * 1024 * 1024;
+
+    explicit AssetCache(size_t budgetBytes = kDefaultBudgetBytes);
+    ~AssetCache();
+
+    // Non-copyable
+    AssetCache(const AssetCache&) = delete;
+    AssetCache& operator=(const AssetCache&) = delete;
+
+    // Null while no Renderer exists
+    static AssetCache* current();
+    void makeCurrent();
+
+    // Returns the cached model and marks it recently used, or nullptr;
+    // counts a hit or a miss either way
+    std::shared_ptr<Model> find(const std::string& key);
+    // Returns the cached model, or the factory's result after caching it.
+    // A null result is returned as-is and not cached.
+    std::shared_ptr<Model> getOrCreate(const std::string& key, const std::function<std::shared_ptr<Model>()>& factory);
+    // Adds the model or replaces the one with the same key, charging its
+    // geometry bytes against the budget
+    void insert(const std::string& key, std::shared_ptr<Model> model);
+    // Same, with the size charged given by the caller
+    void insert(const std::string& key, std::shared_ptr<Model> model, size_t bytes);
+
+    // Returns the model cached for the content last seen under a file key
+    // and marks it recently used, or nullptr; counts hits only, since a
+    // miss is followed by a lookup of the content key
+    std::shared_ptr<Model> findFile(const std::string& fileKey);
+    // Remembers that the file behind fileKey holds the content cached as key
+    void addFileKey(const std::string& fileKey, const std::string& key);
+
+    void setBudget(size_t budgetBytes);
+    size_t getBudget() const { return m_stats.budgetBytes; }
+    // Evicts unused entries, oldest first, until the budget is met
+    void trim();
+    // Drops every entry; models still held elsewhere stay valid
+    void clear();
+
+    const AssetCacheStats& getStats() const { return m_stats; }
+
+    // Key of a file's content, e.g. "glb:<hash>:<size>"
+    static std::string makeContentKey(const char* kind, const void* data, size_t size);
+    // Key of a file's identity, e.g. "glb:/models/ship.glb:<mtime>:<size>";
+    // empty if the file cannot be queried
+    static std::string makeFileKey(const char* kind, const std::string& path);
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<Model> model;
+        size_t bytes;
+    };
+
+    // Most recently used first
+    std::list<Entry> m_entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+    // File key -> content key
+    std::unordered_map<std::string, std::string> m_fileKeys;
+    AssetCacheStats m_stats;
+};
+
+} // namespace RenderEngine
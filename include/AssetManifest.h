@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace RenderEngine {
+
+/**
+ * @brief One cooked asset listed in an AssetManifest
+ */
+struct AssetManifestEntry {
+    std::string name;          // Unique asset name, the source file's stem
+    std::string path;          // Cooked file, relative to the manifest
+    std::uint64_t sourceHash;  // ContentHash of the source and cook settings
+    std::uint64_t bytes;       // Size of the cooked file
+    std::string source;        // Source file as given to the cooker
+};
+
+/**
+ * @brief Index of the cooked assets in a directory
+ *
+ * Written by the asset cooker next to its output and read by the runtime
+ * to find and preload cooked files by name. The file is plain text: a
+ * version line, then one tab-separated line per asset. Does not depend
+ * on GL, so tools can use it.
+ */
+class AssetManifest {
+public:
+    static constexpr const char* kFileName = "manifest.txt";
+
+    bool load(const std::string& path, std::string& error);
+    bool save(const std::string& path, std::string& error) const;
+
+    const std::vector<AssetManifestEntry>& getEntries() const { return m_entries; }
+    const AssetManifestEntry* find(const std::string& name) const;
+    // Adds the entry or replaces the one with the same name
+    void set(const AssetManifestEntry& entry);
+    // Returns false if no entry has the name
+    bool remove(const std::string& name);
+    void clear() { m_entries.clear(); }
+
+    // Path of an entry's cooked file, given the manifest's own path
+    static std::string resolve(const std::string& manifestPath, const AssetManifestEntry& entry);
+
+private:
+    std::vector<AssetManifestEntry> m_entries;
+};
+
+} // namespace RenderEngine
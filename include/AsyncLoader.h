@@ -0,0 +1,164 @@
+#pragma once
+
+#include "StagedModel.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace RenderEngine {
+
+class Model;
+class Shader;
+class AsyncLoader;
+
+enum class LoadState {
+    Pending,
+    Ready,
+    Failed
+};
+
+/**
+ * @brief Result of an AsyncLoader request
+ *
+ * Resolves during AsyncLoader::update(); poll it from the GL thread. Copies
+ * share the same result.
+ */
+template <typename T>
+class LoadHandle {
+public:
+    bool isValid() const { return m_slot != nullptr; }
+    LoadState getState() const { return m_slot ? m_slot->state : LoadState::Failed; }
+    bool isReady() const { return getState() == LoadState::Ready; }
+    bool hasFailed() const { return getState() == LoadState::Failed; }
+    // Null until ready
+    std::shared_ptr<T> get() const { return m_slot ? m_slot->asset : nullptr; }
+
+private:
+    friend class AsyncLoader;
+
+    struct Slot {
+        LoadState state = LoadState::Pending;
+        std::shared_ptr<T> asset;
+    };
+
+    std::shared_ptr<Slot> m_slot;
+};
+
+/**
+ * @brief Counters of an AsyncLoader; the upload fields cover the last update()
+ */
+struct AsyncLoaderStats {
+    size_t pending = 0;             // Requested and not yet resolved
+    size_t uploadedMeshes = 0;
+    size_t uploadedBytes = 0;
+    double uploadMilliseconds = 0.0;
+    std::uint64_t completed = 0;
+    std::uint64_t failed = 0;
+};
+
+/**
+ * @brief Loads models and shaders without stalling the GL thread
+ *
+ * Worker threads map, hash, parse and decode files into a StagedModel,
+ * or read shader sources, and hand the result to a bounded upload queue:
+ * when kMaxStagedAssets wait for upload, the workers stop decoding until
+ * the GL thread catches up, which caps the staging memory.
+ *
+ * update(), called once per frame on the GL thread, works through the
+ * queue one mesh (or one shader program) at a time until its millisecond
+ * budget is spent. It always makes some progress, so a single mesh larger
+ * than the budget still loads, at the cost of one long frame.
+ *
+ * Finished models go into the current AssetCache. A request for a file
+ * whose path, modification time and size are already cached resolves at
+ * once without reaching the workers; otherwise a worker stages and hashes
+ * the file, and content cached under another path then resolves to the
+ * cached model without any upload.
+ *
+ * Requests are made and polled on the GL thread. The loader must be
+ * stopped or destroyed before the Renderer; requests still pending then
+ * resolve as failed.
+ */
+class AsyncLoader {
+public:
+    static constexpr unsigned int kDefaultWorkerCount = 2;
+    static constexpr size_t kMaxStagedAssets = 4;
+    static constexpr double kDefaultUploadBudgetMs = 2.0;
+
+    explicit AsyncLoader(unsigned int workerCount = kDefaultWorkerCount);
+    ~AsyncLoader();
+
+    // Non-copyable
+    AsyncLoader(const AsyncLoader&) = delete;
+    AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+    // Asynchronous counterparts of the Model loaders
+    LoadHandle<Model> loadOBJ(const std::string& path, VertexPacking packing = VertexPacking::Compact);
+    LoadHandle<Model> loadGLB(const std::string& path);
+    LoadHandle<Model> loadCooked(const std::string& path);
+    // Asynchronous Shader::loadFromFiles
+    LoadHandle<Shader> loadShader(const std::string& vertexPath, const std::string& fragmentPath);
+    // Requests every cooked asset an AssetManifest lists, in manifest order;
+    // returns no handles if the manifest cannot be read
+    std::vector<LoadHandle<Model>> preload(const std::string& manifestPath);
+
+    // GL thread only: uploads staged assets until the budget is spent
+    void update(double budgetMilliseconds = kDefaultUploadBudgetMs);
+    bool isIdle() const { return m_stats.pending == 0; }
+    // Joins the workers and resolves every unfinished request as failed;
+    // later requests fail at once. The destructor calls it.
+    void stop();
+
+    // Staged assets waiting for update(); at most kMaxStagedAssets
+    size_t getStagedCount() const;
+
+    const AsyncLoaderStats& getStats() const { return m_stats; }
+
+private:
+    struct Request {
+        ModelFileType type = ModelFileType::OBJ;
+        VertexPacking packing = VertexPacking::Compact;
+        std::string path;
+        std::string fragmentPath;     // Set for shaders only
+        std::shared_ptr<LoadHandle<Model>::Slot> model;
+        std::shared_ptr<LoadHandle<Shader>::Slot> shader;
+    };
+
+    struct StagedAsset {
+        Request request;
+        std::string error;            // Set if staging failed
+        StagedModel model;
+        std::string vertexSource;
+        std::string fragmentSource;
+        // Upload progress
+        std::shared_ptr<Model> result;
+        size_t nextMesh = 0;
+    };
+
+    LoadHandle<Model> requestModel(const std::string& path, ModelFileType type, VertexPacking packing);
+    void enqueue(Request request);
+    void workerLoop();
+    std::unique_ptr<StagedAsset> stage(Request request) const;
+    // Uploads one mesh or shader; returns true once the asset is resolved
+    bool uploadStep(StagedAsset& asset);
+    void resolveFailed(const Request& request);
+
+    std::vector<std::thread> m_workers;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_requestAvailable;
+    std::condition_variable m_stagingSpace;
+    std::deque<Request> m_requests;
+    std::deque<std::unique_ptr<StagedAsset>> m_staged;
+    // Taken off m_staged but not fully uploaded; GL thread only
+    std::unique_ptr<StagedAsset> m_uploading;
+    unsigned int m_parserThreads;
+    bool m_stopping;
+    AsyncLoaderStats m_stats;
+};
+
+} // namespace RenderEngine
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "Frustum.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+namespace RenderEngine {
+
+/**
+ * @brief Bounding volume hierarchy over bounding spheres
+ *
+ * Like SpatialHash, objects are identified by caller-chosen small integer
+ * ids. The tree is built with a binned surface area heuristic over the
+ * spheres' boxes; moving objects only need update() followed by refit(),
+ * which recomputes node bounds bottom-up without changing the topology.
+ *
+ * Objects inserted after the last build sit in a pending list that
+ * queries scan linearly until the next rebuild. requestRebuild() builds a
+ * new tree from a snapshot on a worker thread while the current one stays
+ * in use; pollRebuild() swaps it in once it is finished. The worker thread
+ * persists between builds, and the two trees trade buffers on every swap,
+ * so after reserve() inserting and rebuilding never allocate.
+ */
+class BVH {
+public:
+    using Id = std::uint32_t;
+
+    BVH();
+    ~BVH();
+
+    // Non-copyable
+    BVH(const BVH&) = delete;
+    BVH& operator=(const BVH&) = delete;
+
+    void insert(Id id, const glm::vec3& center, float radius);
+    void remove(Id id);
+    void update(Id id, const glm::vec3& center, float radius);
+    void clear();
+    // Sizes storage for ids below capacity and starts the rebuild worker
+    void reserve(size_t capacity);
+
+    bool contains(Id id) const;
+    size_t size() const { return m_count; }
+    size_t getPendingCount() const { return m_pending.size(); }
+    size_t getNodeCount() const { return m_nodes.size(); }
+
+    // Recomputes node bounds after update() calls
+    void refit();
+
+    // Synchronous build including all pending objects
+    void rebuild();
+
+    // Starts a background build unless one is already running; pollRebuild
+    // installs a finished build and reports whether it did
+    void requestRebuild();
+    bool pollRebuild();
+    bool isRebuilding() const { return m_rebuilding; }
+
+    // Invoke fn(id) for every object overlapping the query volume
+    template <typename Fn>
+    void forEachInSphere(const glm::vec3& center, float radius, Fn&& fn) const;
+    template <typename Fn>
+    void forEachInFrustum(const Frustum& frustum, float margin, Fn&& fn) const;
+
+    // Nearest object hit by the ray within maxDistance; direction must be
+    // normalized
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                 Id& hitId, float& hitDistance) const;
+
+private:
+    static constexpr std::uint32_t kMaxDepth = 64;
+    static constexpr std::uint32_t kMaxLeafSize = 8;
+
+    struct Node {
+        glm::vec3 min;
+        std::uint32_t leftOrFirst;  // Left child, or first primitive of a leaf
+        glm::vec3 max;
+        std::uint32_t count;        // Primitive count; 0 for inner nodes
+
+        bool isLeaf() const { return count > 0; }
+    };
+
+    struct Entry {
+        glm::vec3 center;
+        float radius;
+        bool active;
+        bool inTree;
+    };
+
+    struct BuildPrimitive {
+        glm::vec3 center;
+        float radius;
+        Id id;
+    };
+
+    static void build(std::vector<BuildPrimitive>& primitives, std::vector<Node>& nodes,
+                      std::vector<Id>& order);
+    void snapshot(std::vector<BuildPrimitive>& primitives) const;
+    void install(std::vector<Node>& nodes, std::vector<Id>& order);
+    void startWorker();
+    void workerLoop();
+    // Waits for a requested build and discards it
+    void cancelRebuild();
+
+    static bool overlapsSphere(const Node& node, const glm::vec3& center, float radius);
+
+    std::vector<Entry> m_entries;
+    std::vector<Node> m_nodes;
+    std::vector<Id> m_order;        // Leaf primitives, referenced by Node ranges
+    std::vector<Id> m_pending;      // Active objects not in the tree yet
+    size_t m_count;
+
+    std::thread m_worker;
+    std::mutex m_workerMutex;
+    std::condition_variable m_workerWake;
+    std::condition_variable m_workerFinished;
+    bool m_buildRequested;          // Guarded by m_workerMutex
+    bool m_workerStopping;          // Guarded by m_workerMutex
+    std::atomic<bool> m_workerDone;
+    bool m_rebuilding;              // Requested and not yet installed
+    std::vector<BuildPrimitive> m_workerPrimitives;
+    std::vector<Node> m_workerNodes;
+    std::vector<Id> m_workerOrder;
+};
+
+template <typename Fn>
+void BVH::forEachInSphere(const glm::vec3& center, float radius, Fn&& fn) const {
+    auto overlaps = [&](const Entry& entry) {
+        glm::vec3 d = entry.center - center;
+        float r = radius + entry.radius;
+        return glm::dot(d, d) < r * r;
+    };
+
+    if (!m_nodes.empty()) {
+        std::uint32_t stack[kMaxDepth + 2];
+        std::uint32_t top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = m_nodes[stack[--top]];
+            if (!overlapsSphere(node, center, radius)) continue;
+
+            if (node.isLeaf()) {
+                for (std::uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                    Id id = m_order[i];
+                    const Entry& entry = m_entries[id];
+                    if (entry.active && entry.inTree && overlaps(entry)) {
+                        fn(id);
+                    }
+                }
+            } else {
+                stack[top++] = node.leftOrFirst;
+                stack[top++] = node.leftOrFirst + 1;
+            }
+        }
+    }
+
+    for (Id id : m_pending) {
+        if (overlaps(m_entries[id])) {
+            fn(id);
+        }
+    }
+}
+
+template <typename Fn>
+void BVH::forEachInFrustum(const Frustum& frustum, float margin, Fn&& fn) const {
+    if (!m_nodes.empty()) {
+        // Each stack entry carries the planes its box is not yet known to
+        // be fully inside of; subtrees inside all six skip plane tests
+        struct Item { std::uint32_t node; std::uint32_t planeMask; };
+        Item stack[kMaxDepth + 2];
+        std::uint32_t top = 0;
+        stack[top++] = {0, 0x3F};
+
+        while (top > 0) {
+            Item item = stack[--top];
+            const Node& node = m_nodes[item.node];
+            glm::vec3 lo = node.min - glm::vec3(margin);
+            glm::vec3 hi = node.max + glm::vec3(margin);
+
+            bool outside = false;
+            std::uint32_t mask = item.planeMask;
+            for (int p = 0; p < 6 && !outside; ++p) {
+                if (!(mask & (1u << p))) continue;
+                const glm::vec4& plane = frustum.getPlane(p);
+                glm::vec3 positive(plane.x >= 0.0f ? hi.x : lo.x,
+                                   plane.y >= 0.0f ? hi.y : lo.y,
+                                   plane.z >= 0.0f ? hi.z : lo.z);
+                glm::vec3 negative(plane.x >= 0.0f ? lo.x : hi.x,
+                                   plane.y >= 0.0f ? lo.y : hi.y,
+                                   plane.z >= 0.0f ? lo.z : hi.z);
+                if (plane.x * positive.x + plane.y * positive.y + plane.z * positive.z + plane.w < 0.0f) {
+                    outside = true;
+                } else if (plane.x * negative.x + plane.y * negative.y + plane.z * negative.z + plane.w >= 0.0f) {
+                    mask &= ~(1u << p);
+                }
+            }
+            if (outside) continue;
+
+            if (node.isLeaf()) {
+                for (std::uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                    Id id = m_order[i];
+                    const Entry& entry = m_entries[id];
+                    if (entry.active && entry.inTree &&
+                        (mask == 0 || frustum.intersectsSphere(entry.center, entry.radius + margin))) {
+                        fn(id);
+                    }
+                }
+            } else {
+                stack[top++] = {node.leftOrFirst, mask};
+                stack[top++] = {node.leftOrFirst + 1, mask};
+            }
+        }
+    }
+
+    for (Id id : m_pending) {
+        const Entry& entry = m_entries[id];
+        if (frustum.intersectsSphere(entry.center, entry.radius + margin)) {
+            fn(id);
+        }
+    }
+}
+
+} // namespace RenderEngine
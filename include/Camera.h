@@ -22,6 +22,7 @@ public:
            float pitch = 0.0f);
 
     glm::mat4 getViewMatrix() const;
+    glm::mat4 getViewMatrix(const glm::vec3& eyePosition) const;
     glm::mat4 getProjectionMatrix(float aspectRatio) const;
     glm::vec3 getPosition() const { return m_position; }
     glm::vec3 getFront() const { return m_front; }
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace RenderEngine {
+
+/**
+ * @brief Fixed-capacity structure-of-arrays pool for collectible objects
+ * 
+ * Keeps every per-object component in its own contiguous array so the
+ * update, collision and render loops stream through memory linearly
+ * instead of chasing one heap allocation per object.
+ * 
+ * Objects are addressed externally through generational handles. A handle
+ * names a slot that stays fixed for the object's lifetime, while the
+ * component arrays remain dense: removal is swap-and-pop and only the
+ * slot-to-index table is patched. Freed slots go onto a free list and are
+ * reused by the next add(), and all storage is allocated up front by
+ * reset(), so adding and removing never touch the heap.
+ */
+class CollectibleStore {
+public:
+    struct Handle {
+        std::uint32_t slot;
+        std::uint32_t generation;
+
+        bool operator==(const Handle& other) const {
+            return slot == other.slot && generation == other.generation;
+        }
+        bool operator!=(const Handle& other) const { return !(*this == other); }
+    };
+
+    static constexpr size_t kInvalidIndex = static_cast<size_t>(-1);
+    static constexpr Handle kInvalidHandle = { 0xFFFFFFFFu, 0u };
+
+    explicit CollectibleStore(size_t capacity = 0);
+
+    // Drops every object and preallocates storage for capacity objects
+    void reset(size_t capacity);
+
+    // Returns kInvalidHandle when the pool is full
+    Handle add(const glm::vec3& position, const glm::vec3& scale, float rotation, float bobOffset);
+    bool remove(Handle handle);
+
+    bool isValid(Handle handle) const;
+    Handle getHandle(std::uint32_t slot) const;
+    size_t getIndex(Handle handle) const;
+
+    // Bounding radii are modelRadius times the largest scale component;
+    // changing it recomputes the radius of every live object
+    void setModelRadius(float modelRadius);
+    float getModelRadius() const { return m_modelRadius; }
+
+    // Advances rotation and bobbing of every live object
+    void update(float deltaTime);
+
+    size_t size() const { return m_positions.size(); }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_positions.empty(); }
+    bool full() const { return m_positions.size() >= m_capacity; }
+
+    // Dense component arrays, indexed by 0..size()-1
+    const std::vector<glm::vec3>& getPositions() const { return m_positions; }
+    const std::vector<glm::vec3>& getScales() const { return m_scales; }
+    const std::vector<float>& getRotations() const { return m_rotations; }
+    const std::vector<float>& getBobOffsets() const { return m_bobOffsets; }
+    const std::vector<float>& getBoundingRadii() const { return m_boundingRadii; }
+
+    bool isCollected(size_t index) const { return m_collected[index] != 0; }
+    void setCollected(size_t index, bool collected) { m_collected[index] = collected ? 1 : 0; }
+
+    // Level of detail chosen for the object last frame; kept per object so
+    // selection can apply hysteresis
+    std::uint8_t getLodLevel(size_t index) const { return m_lodLevels[index]; }
+    void setLodLevel(size_t index, std::uint8_t level) { m_lodLevels[index] = level; }
+
+private:
+    size_t m_capacity;
+
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec3> m_scales;
+    std::vector<float> m_rotations;
+    std::vector<float> m_bobOffsets;
+    std::vector<float> m_boundingRadii;
+    std::vector<std::uint8_t> m_collected;
+    std::vector<std::uint8_t> m_lodLevels;
+    std::vector<std::uint32_t> m_indexToSlot;
+
+    // Per-slot bookkeeping, sized to capacity
+    std::vector<std::uint32_t> m_slotToIndex;
+    std::vector<std::uint32_t> m_generations;
+    std::vector<std::uint32_t> m_freeSlots;
+
+    float m_rotationSpeed;
+    float m_bobSpeed;
+    float m_modelRadius;
+};
+
+} // namespace RenderEngine
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace RenderEngine {
+
+constexpr std::uint64_t kContentHashSeed = 14695981039346656037ull;
+
+/**
+ * @brief 64-bit FNV-1a hash of a byte range
+ *
+ * Pass the previous result as seed to hash several ranges as one.
+ */
+inline std::uint64_t hashContent(const void* data, size_t size, std::uint64_t seed = kContentHashSeed) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace RenderEngine
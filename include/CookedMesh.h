@@ -0,0 +1,133 @@
+#pragma once
+
+#include "VertexFormat.h"
+#include "Vertex.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace RenderEngine {
+
+/**
+ * @brief On-disk layout of a cooked mesh file (.rmesh)
+ *
+ * A file is a header, a LOD table, a mesh table and the vertex and index
+ * blobs, each blob starting on a kCookedBlobAlignment boundary. The blobs
+ * hold exactly what the geometry arena uploads (packed vertices, 16- or
+ * 32-bit indices), so loading is a memory map and one copy to the GPU per
+ * blob. Offsets are relative to the start of the file; all values are
+ * little-endian, as on every platform the engine targets.
+ */
+constexpr char kCookedMeshMagic[4] = {'R', 'M', 'S', 'H'};
+constexpr std::uint32_t kCookedMeshVersion = 1;
+constexpr size_t kCookedBlobAlignment = 16;
+constexpr size_t kCookedMaxAttributes = 4;
+
+struct CookedMeshHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t lodCount;
+    std::uint32_t meshCount;
+    std::uint64_t lodTableOffset;
+    std::uint64_t meshTableOffset;
+    std::uint64_t fileSize;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct CookedLodEntry {
+    std::uint32_t firstMesh;
+    std::uint32_t meshCount;
+    // Projected radius in pixels at and above which this level is
+    // preferred over the next, as in Model::setLodThresholds; 0 for the last
+    float screenRadius;
+    std::uint32_t reserved;
+};
+
+struct CookedAttribute {
+    std::uint32_t location;
+    std::uint32_t components;
+    std::uint32_t type;
+    std::uint32_t normalized;
+    std::uint32_t offset;
+};
+
+struct CookedMeshEntry {
+    // Vertex format descriptor
+    std::uint32_t packing;
+    std::uint32_t stride;
+    std::uint32_t planar;
+    std::uint32_t attributeCount;
+    CookedAttribute attributes[kCookedMaxAttributes];
+
+    std::uint32_t indexType;
+    std::uint32_t reserved;
+    std::uint64_t vertexOffset;
+    std::uint64_t vertexCount;
+    std::uint64_t indexOffset;
+    std::uint64_t indexCount;
+
+    float positionTransform[16];
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+static_assert(sizeof(CookedMeshHeader) == 64, "CookedMeshHeader layout changed");
+static_assert(sizeof(CookedLodEntry) == 16, "CookedLodEntry layout changed");
+static_assert(sizeof(CookedMeshEntry) == 224, "CookedMeshEntry layout changed");
+
+/**
+ * @brief One mesh in its GPU-ready form, as written to a cooked file
+ */
+struct CookedGeometry {
+    VertexPacking packing = VertexPacking::Float;
+    VertexFormat format;
+    glm::mat4 positionTransform = glm::mat4(1.0f);
+    std::vector<unsigned char> vertices;
+    size_t vertexCount = 0;
+    std::vector<unsigned char> indices;
+    size_t indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+};
+
+/**
+ * @brief Validated view of a cooked mesh file in memory
+ */
+struct CookedMeshView {
+    const char* data = nullptr;
+    const CookedMeshHeader* header = nullptr;
+    const CookedLodEntry* lods = nullptr;
+    const CookedMeshEntry* meshes = nullptr;
+};
+
+/**
+ * @brief Writes and validates cooked mesh files
+ *
+ * Does not call GL, so tools can use it.
+ */
+class CookedMeshFile {
+public:
+    // Optimizes, packs and narrows the indices exactly like the Mesh
+    // constructor does at runtime
+    static CookedGeometry cook(std::vector<Vertex> vertices, std::vector<unsigned int> indices,
+                               VertexPacking packing, bool optimize = true);
+
+    // lods[i] holds the meshes of level i; lodThresholds follows
+    // Model::setLodThresholds (one entry per level but the last). The file
+    // is written to path + ".tmp" and renamed into place.
+    static bool write(const std::string& path, const std::vector<std::vector<CookedGeometry>>& lods,
+                      const std::vector<float>& lodThresholds, std::string& error);
+
+    // Checks the header, that every table and blob lies inside the data,
+    // that vertex formats read only inside their blob and that indices are
+    // in range; the view points into data and is valid as long as it is
+    static bool open(const char* data, size_t size, CookedMeshView& view, std::string& error);
+
+    static VertexFormat getVertexFormat(const CookedMeshEntry& entry);
+};
+
+} // namespace RenderEngine
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace RenderEngine {
+
+/**
+ * @brief Per-frame shader constants shared by every program
+ *
+ * Mirrors the std140 layout of the FrameData uniform block declared by
+ * kFrameUniformsGLSL. The Renderer owns a single uniform buffer with this
+ * content, uploads it once per frame and keeps it bound at
+ * kFrameUniformsBinding; Shader binds the block of every linked program
+ * to that point, so no per-draw camera or light uniforms are needed.
+ */
+struct FrameUniforms {
+    glm::mat4 view = glm::mat4(1.0f);          // offset 0
+    glm::mat4 projection = glm::mat4(1.0f);    // offset 64
+    glm::vec3 viewPos = glm::vec3(0.0f);       // offset 128
+    float time = 0.0f;                         // offset 140
+    glm::vec3 lightPos = glm::vec3(5.0f, 10.0f, 5.0f); // offset 144
+    float padding0 = 0.0f;
+    glm::vec3 lightColor = glm::vec3(1.0f);    // offset 160
+    float padding1 = 0.0f;
+};
+
+static_assert(sizeof(FrameUniforms) == 176, "FrameUniforms must match the std140 FrameData block");
+
+constexpr unsigned int kFrameUniformsBinding = 0;
+constexpr const char* kFrameUniformsBlockName = "FrameData";
+
+// Block declaration spliced into shader sources right after #version
+constexpr const char* kFrameUniformsGLSL = R"(
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float time;
+    vec3 lightPos;
+    vec3 lightColor;
+};
+)";
+
+} // namespace RenderEngine
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace RenderEngine {
+
+/**
+ * @brief View frustum as six inward-facing planes
+ *
+ * Planes are extracted from a combined projection * view matrix
+ * (Gribb-Hartmann) and normalized, so plane distances are in world units
+ * and can be compared against sphere radii directly.
+ *
+ * cullSpheres() tests eight spheres per iteration with AVX2 or four with
+ * SSE2, chosen at compile time, and falls back to scalar code elsewhere.
+ */
+class Frustum {
+public:
+    Frustum();
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    void update(const glm::mat4& viewProjection);
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const;
+
+    // Writes the indices of spheres at least partly inside the frustum to
+    // visible (which must hold count entries) and returns how many there
+    // are. Every radius is grown by margin.
+    size_t cullSpheres(const glm::vec3* centers, const float* radii, size_t count,
+                       float margin, uint32_t* visible) const;
+
+    const glm::vec4& getPlane(int index) const { return m_planes[index]; }
+
+    // Instruction set used by cullSpheres: "AVX2", "SSE2" or "scalar"
+    static const char* getSimdPath();
+
+private:
+    size_t cullScalar(const glm::vec3* centers, const float* radii, size_t begin, size_t end,
+                      float margin, uint32_t* visible) const;
+
+    // left, right, bottom, top, near, far; xyz = normal, w = distance
+    glm::vec4 m_planes[6];
+};
+
+} // namespace RenderEngine
@@ -0,0 +1,84 @@
+#pragma once
+
+#ifdef __APPLE__
+    #include <OpenGL/gl3.h>
+#else
+    #include <glad/glad.h>
+#endif
+#include <glm/glm.hpp>
+
+namespace RenderEngine {
+
+/**
+ * @brief Number of GL state calls forwarded to the driver versus filtered out
+ */
+struct GLStateStats {
+    unsigned int issued = 0;
+    unsigned int elided = 0;
+};
+
+/**
+ * @brief Shadow copy of frequently changed GL state
+ *
+ * Tracks the bound program, vertex array, array and element buffers,
+ * depth test and blend enables, and the clear colour, and drops calls
+ * that would not change anything. All values start out unknown, so the
+ * first call for each piece of state always reaches the driver.
+ *
+ * The element buffer binding belongs to the bound vertex array; it is
+ * forgotten whenever the vertex array changes. Objects must be reported
+ * through the forget*() methods when deleted, because GL reuses names.
+ *
+ * Code paths call GLStateCache::current(); the Renderer makes its own
+ * cache current for its lifetime, and a process-wide fallback covers
+ * anything that runs without one.
+ */
+class GLStateCache {
+public:
+    GLStateCache();
+    ~GLStateCache();
+
+    // Non-copyable
+    GLStateCache(const GLStateCache&) = delete;
+    GLStateCache& operator=(const GLStateCache&) = delete;
+
+    static GLStateCache& current();
+    void makeCurrent();
+
+    void useProgram(unsigned int program);
+    void bindVertexArray(unsigned int vao);
+    void bindBuffer(GLenum target, unsigned int buffer);
+    void setDepthTest(bool enable);
+    void setBlending(bool enable);
+    void setClearColor(const glm::vec4& color);
+
+    void forgetProgram(unsigned int program);
+    void forgetVertexArray(unsigned int vao);
+    void forgetBuffer(unsigned int buffer);
+
+    // Marks every value unknown, e.g. after code that bypassed the cache
+    void invalidate();
+
+    const GLStateStats& getStats() const { return m_stats; }
+    void resetStats() { m_stats = GLStateStats(); }
+
+private:
+    static constexpr unsigned int kUnknown = 0xFFFFFFFFu;
+
+    enum class Toggle : unsigned char { Unknown, Off, On };
+
+    void setCapability(GLenum capability, Toggle& state, bool enable);
+    bool elide(bool redundant);
+
+    unsigned int m_program;
+    unsigned int m_vertexArray;
+    unsigned int m_arrayBuffer;
+    unsigned int m_elementBuffer;
+    Toggle m_depthTest;
+    Toggle m_blending;
+    glm::vec4 m_clearColor;
+    bool m_clearColorKnown;
+    GLStateStats m_stats;
+};
+
+} // namespace RenderEngine
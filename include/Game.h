@@ -3,14 +3,96 @@
 #include <memory>
 #include <vector>
 #include <random>
+#include <cstdint>
+#include <string>
 #include "Window.h"
 #include "Camera.h"
 #include "Renderer.h"
 #include "GameObject.h"
 #include "Shader.h"
+#include "InstanceBuffer.h"
+#include "SpatialHash.h"
+#include "CollectibleStore.h"
+#include "SyntheticInput.h"
+#include "Frustum.h"
+#include "BVH.h"
+#include "AsyncLoader.h"
 
 namespace RenderEngine {
 
+/**
+ * @brief Per-instance data streamed to the GPU for each visible collectible
+ * 
+ * Packs the world position with the Y rotation (degrees) and the scale
+ * with the bob phase (radians) into two vec4 attributes; the vertex
+ * shader rebuilds the model matrix from them.
+ */
+struct CollectibleInstance {
+    glm::vec4 positionRotation;
+    glm::vec4 scaleBobPhase;
+};
+
+/**
+ * @brief Packs the visible collectibles into one instance list per LOD
+ *
+ * CPU side of the instanced path in Game::render. Clears every list, then
+ * picks a level for each visible, uncollected object from its projected
+ * radius (radius * pixelScale / distance to eyePosition), records it in
+ * the store for next frame's hysteresis and appends the object's record.
+ * Rotation and bob phase are rewound by renderLag seconds of animation.
+ * instances must hold one list per level of model.
+ */
+void packCollectibleInstances(CollectibleStore& store, const std::uint32_t* visible, size_t visibleCount,
+                              const Model& model, const glm::vec3& eyePosition, float pixelScale,
+                              float renderLag, std::vector<std::vector<CollectibleInstance>>& instances);
+
+/**
+ * @brief Tunable parameters for a game session
+ */
+struct GameSettings {
+    // Step the simulation in fixed ticks instead of once per rendered frame
+    bool fixedTimestep = false;
+    float tickRate = 60.0f;
+    // Spiral-of-death guard: simulation time beyond this many ticks per
+    // frame is dropped rather than caught up
+    int maxTicksPerFrame = 5;
+
+    // World setup
+    int maxCollectibles = 15;
+    float worldSize = 20.0f;
+    std::uint32_t seed = 0;  // 0 picks a random seed
+
+    // Simulation-only mode without Window, Renderer or GL context. Runs one
+    // fixed tick per frame as fast as possible, driven by SyntheticInput,
+    // for headlessFrames frames or headlessDuration seconds of wall time.
+    bool headless = false;
+    long headlessFrames = 0;
+    float headlessDuration = 0.0f;
+
+    // Chrome trace-event JSON capture of the whole session; empty disables
+    std::string tracePath;
+
+    // Index collectibles in a BVH instead of the spatial hash, for both
+    // collision queries and frustum culling
+    bool useBvh = false;
+
+    // Model files (.obj, .glb or .rmesh) replacing the built-in ground plane
+    // and collectible sphere once loaded in the background; empty keeps the
+    // built-in shape. Ignored in headless mode.
+    std::string groundModelPath;
+    std::string collectibleModelPath;
+};
+
+/**
+ * @brief Accumulated wall time spent in each simulation phase, in seconds
+ */
+struct PhaseTimings {
+    double input = 0.0;
+    double update = 0.0;
+    double collisions = 0.0;
+    double respawn = 0.0;
+};
+
 /**
  * @brief Main game class managing game state, objects, and gameplay
  * 
@@ -23,17 +105,29 @@ namespace RenderEngine {
  */
 class Game {
 public:
-    Game();
+    explicit Game(const GameSettings& settings = GameSettings());
     ~Game();
 
     bool initialize();
     void run();
     void shutdown();
 
+    int getCollectiblesCollected() const { return m_collectiblesCollected; }
+    // Heap allocations made inside update(); counted only in builds with
+    // RENDERENGINE_COUNT_ALLOCATIONS
+    std::uint64_t getUpdateAllocations() const { return m_updateAllocations; }
+
 private:
     void update(float deltaTime);
     void render();
     void processInput(float deltaTime);
+    void processMouseInput();
+    void stepFixed(float frameTime);
+    void runHeadless();
+    bool initializeGraphics();
+    bool useGroundModel(std::shared_ptr<Model> model);
+    bool useCollectibleModel(std::shared_ptr<Model> model);
+    void adoptLoadedModels();
     void checkCollisions();
     void spawnCollectible();
     void updateUI();
@@ -41,23 +135,57 @@ private:
     std::unique_ptr<Window> m_window;
     std::unique_ptr<Camera> m_camera;
     std::unique_ptr<Renderer> m_renderer;
+    std::unique_ptr<AsyncLoader> m_assetLoader;
+    std::unique_ptr<SyntheticInput> m_syntheticInput;
 
-    std::vector<std::shared_ptr<GameObject>> m_collectibles;
+    CollectibleStore m_collectibles;
     std::shared_ptr<Model> m_groundModel;
     std::shared_ptr<Model> m_collectibleModel;
     std::shared_ptr<Shader> m_groundShader;
     std::shared_ptr<Shader> m_collectibleShader;
+    UniformHandle<float> m_collectibleShininessUniform;
+    std::vector<std::unique_ptr<InstanceBuffer>> m_collectibleInstanceBuffers;  // One per LOD
+    std::vector<std::vector<CollectibleInstance>> m_collectibleInstances;      // One per LOD
+    LoadHandle<Model> m_groundModelLoad;
+    LoadHandle<Model> m_collectibleModelLoad;
+
+    GameSettings m_settings;
 
     // Game state
     int m_score;
     int m_collectiblesCollected;
     float m_gameTime;
     bool m_running;
+    bool m_initialized;
+    std::uint64_t m_updateAllocations;
 
     // World bounds
     float m_worldSize;
     int m_maxCollectibles;
 
+    // Collision broadphase, keyed by collectible handle slot
+    float m_collisionRadius;
+    SpatialHash m_collectibleGrid;
+    BVH m_collectibleBvh;
+    std::vector<CollectibleStore::Handle> m_collectedHandles;
+    std::vector<uint32_t> m_visibleCollectibles;
+    Frustum m_frustum;
+
+    // Fixed timestep state; render interpolates between the last two ticks
+    float m_tickAccumulator;
+    float m_interpolationAlpha;
+    glm::vec3 m_previousCameraPosition;
+
+    // Frame statistics since the last UI print
+    int m_statsFrames;
+    int m_statsTicks;
+    int m_statsMaxTicks;
+    PhaseTimings m_phaseTimings;
+    std::uint64_t m_frameNumber;
+    size_t m_statsVisible;
+    size_t m_statsCulled;
+    std::vector<size_t> m_statsLodCounts;
+
     // Input state
     bool m_firstMouse;
     double m_lastMouseX;
@@ -18,6 +18,10 @@ namespace RenderEngine {
  */
 class GameObject {
 public:
+    static constexpr float kDefaultRotationSpeed = 45.0f;
+    static constexpr float kDefaultBobSpeed = 2.0f;
+    static constexpr float kBobAmplitude = 0.1f;
+
     GameObject(std::shared_ptr<Model> model, 
               const glm::vec3& position = glm::vec3(0.0f),
               const glm::vec3& scale = glm::vec3(1.0f));
@@ -39,6 +43,13 @@ public:
 
     float getBoundingRadius() const { return m_boundingRadius; }
 
+    // Shared by GameObject and the batched CollectibleStore update
+    static void advanceAnimation(float& rotation, float& bobOffset,
+                                 float rotationSpeed, float bobSpeed, float deltaTime);
+    // modelRadius is Model::getBoundingRadius(); the default is the unit
+    // sphere's
+    static float computeBoundingRadius(const glm::vec3& scale, float modelRadius = 0.5f);
+
 private:
     std::shared_ptr<Model> m_model;
     glm::vec3 m_position;
@@ -0,0 +1,126 @@
+#pragma once
+
+#ifdef __APPLE__
+    #include <OpenGL/gl3.h>
+#else
+    #include <glad/glad.h>
+#endif
+#include "VertexFormat.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace RenderEngine {
+
+class InstanceBuffer;
+
+/**
+ * @brief Location of one mesh's geometry inside the arena
+ */
+struct GeometryAllocation {
+    static constexpr std::uint32_t kInvalidPage = 0xFFFFFFFFu;
+
+    std::uint32_t page = kInvalidPage;
+    std::uint32_t baseVertex = 0;
+    std::uint32_t vertexCount = 0;
+    size_t indexOffset = 0;         // In bytes
+    size_t indexBytes = 0;
+
+    bool isValid() const { return page != kInvalidPage; }
+};
+
+/**
+ * @brief Shared vertex and index storage for meshes
+ *
+ * Geometry lives in a few large pages, each a VBO/EBO pair with a VAO
+ * describing one VertexFormat. Meshes receive a sub-allocation and draw
+ * with glDrawElementsBaseVertex, so every mesh of a format in the same
+ * page renders without switching vertex arrays. Pages are created on
+ * demand and freed when their last mesh is released; a mesh larger than
+ * the default page size gets a page of its own.
+ *
+ * Instance attributes are VAO state and therefore shared by all meshes of
+ * a page. bindInstanceBuffer() tracks what each location currently points
+ * at and re-points it only when a draw needs different data; locations the
+ * buffer does not use are disabled, so instanced draws must bind their
+ * buffer right before drawing.
+ *
+ * The Renderer owns the arena and makes it current for its lifetime; all
+ * meshes must be destroyed before it.
+ */
+class GeometryArena {
+public:
+    static constexpr size_t kPageVertexBytes = 4 * 1024 * 1024;
+    static constexpr size_t kPageIndexBytes = 2 * 1024 * 1024;
+
+    GeometryArena();
+    ~GeometryArena();
+
+    // Non-copyable
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    // Null while no Renderer exists
+    static GeometryArena* current();
+    void makeCurrent();
+
+    // Copies the vertices and indices into a page of the format; returns an
+    // invalid allocation for empty geometry
+    GeometryAllocation allocate(const VertexFormat& format, const void* vertices, size_t vertexCount,
+                                const void* indices, size_t indexBytes);
+    // Same with separate streams: one pointer for interleaved formats, one
+    // tightly packed array per attribute for planar ones
+    GeometryAllocation allocate(const VertexFormat& format, const void* const* streams, size_t vertexCount,
+                                const void* indices, size_t indexBytes);
+    void release(const GeometryAllocation& allocation);
+
+    unsigned int getVertexArray(const GeometryAllocation& allocation) const;
+    void bindInstanceBuffer(const GeometryAllocation& allocation, const InstanceBuffer& buffer,
+                            size_t firstInstance);
+    void forgetInstanceBuffer(unsigned int buffer);
+
+    size_t getPageCount() const { return m_livePageCount; }
+    size_t getUsedBytes() const { return m_usedBytes; }
+
+private:
+    static constexpr unsigned int kMaxAttributes = 16;
+
+    // First-fit free list of [offset, offset + size) ranges, sorted by offset
+    class RangeAllocator {
+    public:
+        explicit RangeAllocator(size_t capacity = 0);
+        bool allocate(size_t size, size_t alignment, size_t& offset);
+        void release(size_t offset, size_t size);
+
+    private:
+        struct Range { size_t offset; size_t size; };
+        std::vector<Range> m_free;
+    };
+
+    struct InstanceAttributeState {
+        unsigned int buffer;
+        size_t offset;
+    };
+
+    struct Page {
+        VertexFormat format;
+        size_t vertexCapacity;
+        size_t allocationCount;
+        unsigned int vao;           // 0 once the page is freed
+        unsigned int vbo;
+        unsigned int ebo;
+        RangeAllocator vertices;    // In vertices
+        RangeAllocator indices;     // In bytes
+        InstanceAttributeState instanceAttributes[kMaxAttributes];
+    };
+
+    // Reuses the slot of a freed page, since allocations refer to pages by index
+    std::uint32_t createPage(const VertexFormat& format, size_t vertexCapacity, size_t indexCapacity);
+    void destroyPage(Page& page);
+
+    std::vector<Page> m_pages;
+    size_t m_livePageCount;
+    size_t m_usedBytes;
+};
+
+} // namespace RenderEngine
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Vertex.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace RenderEngine {
+
+/**
+ * @brief Element layout of a glTF accessor, pointing into the GLB file
+ *
+ * glTF component types are the GL type enums (GL_FLOAT is 5126), so
+ * componentType can be handed to glVertexAttribPointer directly.
+ */
+struct GltfAccessor {
+    const unsigned char* data = nullptr;     // First element
+    const unsigned char* viewEnd = nullptr;  // End of the buffer view holding the elements
+    size_t count = 0;
+    size_t stride = 0;                       // Bytes between elements
+    size_t elementSize = 0;                  // Bytes of one element
+    unsigned int componentType = 0;
+    int components = 0;
+    int bufferView = -1;
+    bool normalized = false;
+
+    bool isValid() const { return data != nullptr; }
+    bool isTight() const { return stride == elementSize; }
+};
+
+/**
+ * @brief Triangle list primitive of a glTF mesh
+ *
+ * Missing attributes have invalid accessors; a missing index accessor
+ * means the vertices are drawn in order.
+ */
+struct GltfPrimitive {
+    GltfAccessor position;
+    GltfAccessor normal;
+    GltfAccessor texCoords;
+    GltfAccessor indices;
+};
+
+struct GltfMesh {
+    std::string name;
+    std::vector<GltfPrimitive> primitives;
+};
+
+/**
+ * @brief Parser for binary glTF 2.0 (.glb) containers
+ *
+ * Reads the JSON chunk and resolves every mesh primitive's accessors to
+ * pointers into the BIN chunk, after checking that they stay inside their
+ * buffer views. No vertex data is copied, so the accessors are only valid
+ * while the parsed memory is (typically a MappedFile).
+ *
+ * Only triangle list primitives whose indices are all in range are
+ * returned; other modes, sparse accessors and external buffers are
+ * skipped with a note in warnings.
+ * Node transforms are not applied. Does not depend on GL, so tools can
+ * use it.
+ */
+class GlbParser {
+public:
+    static bool parse(const char* data, size_t size, std::vector<GltfMesh>& meshes, std::string& error,
+                      std::vector<std::string>* warnings = nullptr);
+
+    // Widens the indices of a primitive to 32 bits; non-indexed
+    // primitives get 0..n-1
+    static void readIndices(const GltfPrimitive& primitive, std::vector<unsigned int>& indices);
+    // Decodes any parsed primitive into engine vertices. Flat normals are
+    // generated when it has none, as glTF requires.
+    static void decode(const GltfPrimitive& primitive, std::vector<Vertex>& vertices,
+                       std::vector<unsigned int>& indices);
+};
+
+} // namespace RenderEngine
@@ -0,0 +1,78 @@
+#pragma once
+
+#ifdef __APPLE__
+    #include <OpenGL/gl3.h>
+#else
+    #include <glad/glad.h>
+#endif
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace RenderEngine {
+
+/**
+ * @brief GPU time spent in one named render pass
+ */
+struct GpuPassTiming {
+    const char* name;
+    double milliseconds;
+};
+
+/**
+ * @brief Pool of GL_TIME_ELAPSED queries measuring named render passes
+ * 
+ * Each frame records its passes into one of kFrameLatency query sets.
+ * A set is only read back when the ring wraps around to it again, by
+ * which point the GPU has long finished those commands, so reading the
+ * results never stalls the pipeline. If a set is still not available
+ * (the GPU is more than kFrameLatency frames behind) its results are
+ * dropped instead of waited for.
+ * 
+ * Time-elapsed queries cannot nest, so beginning a pass implicitly ends
+ * the previous one.
+ */
+class GpuTimer {
+public:
+    static constexpr int kFrameLatency = 4;
+
+    GpuTimer();
+    ~GpuTimer();
+
+    // Non-copyable
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void beginFrame();
+    void beginPass(const char* name);
+    void endPass();
+
+    // Results of the most recently resolved frame; hasNewResults() reports
+    // whether they changed during the last beginFrame()
+    const std::vector<GpuPassTiming>& getResults() const { return m_results; }
+    bool hasNewResults() const { return m_hasNewResults; }
+    std::uint64_t getDroppedFrames() const { return m_droppedFrames; }
+
+private:
+    struct PassQuery {
+        const char* name;
+        unsigned int query;
+    };
+
+    struct FrameQueries {
+        std::vector<PassQuery> passes;
+        std::vector<unsigned int> pool;
+    };
+
+    bool resolve(FrameQueries& frame);
+
+    std::array<FrameQueries, kFrameLatency> m_frames;
+    int m_current;
+    bool m_passOpen;
+    bool m_hasNewResults;
+    std::uint64_t m_droppedFrames;
+    std::vector<GpuPassTiming> m_results;
+};
+
+} // namespace RenderEngine
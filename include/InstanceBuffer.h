@@ -0,0 +1,54 @@
+#pragma once
+
+#ifdef __APPLE__
+    #include <OpenGL/gl3.h>
+#else
+    #include <glad/glad.h>
+#endif
+#include <vector>
+#include <cstddef>
+
+namespace RenderEngine {
+
+/**
+ * @brief Layout of a single per-instance vertex attribute
+ */
+struct InstanceAttribute {
+    unsigned int location;
+    int components;
+    size_t offset;
+};
+
+/**
+ * @brief Streaming vertex buffer holding per-instance data
+ * 
+ * Meshes point their VAO's per-instance attributes at the buffer with a
+ * divisor of 1; the contents can be re-uploaded every frame and drawn
+ * with a single instanced call. Uploads orphan the previous storage so
+ * the driver never waits for the GPU to finish reading last frame's data.
+ */
+class InstanceBuffer {
+public:
+    InstanceBuffer(size_t stride, const std::vector<InstanceAttribute>& attributes);
+    ~InstanceBuffer();
+
+    // Non-copyable
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    void upload(const void* data, size_t count);
+
+    unsigned int getId() const { return m_VBO; }
+    size_t getStride() const { return m_stride; }
+    size_t getCount() const { return m_count; }
+    const std::vector<InstanceAttribute>& getAttributes() const { return m_attributes; }
+
+private:
+    unsigned int m_VBO;
+    size_t m_stride;
+    size_t m_capacity;
+    size_t m_count;
+    std::vector<InstanceAttribute> m_attributes;
+};
+
+} // namespace RenderEngine
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace RenderEngine {
+
+/**
+ * @brief Minimal JSON document tree
+ *
+ * Enough of RFC 8259 for asset headers such as glTF: objects, arrays,
+ * strings (with \u escapes, surrogate pairs included), numbers, booleans
+ * and null. Object members keep their file order and are looked up
+ * linearly, which is fast for the handful of keys an asset object has.
+ * Does not depend on GL, so tools can use it.
+ */
+class JsonValue {
+public:
+    enum class Type {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    JsonValue() = default;
+
+    // On failure error describes the problem and its byte offset
+    static bool parse(const char* text, size_t size, JsonValue& value, std::string& error);
+
+    Type getType() const { return m_type; }
+    bool isNull() const { return m_type == Type::Null; }
+    bool isNumber() const { return m_type == Type::Number; }
+    bool isString() const { return m_type == Type::String; }
+    bool isArray() const { return m_type == Type::Array; }
+    bool isObject() const { return m_type == Type::Object; }
+
+    // Typed access; the fallback is returned when the value has another type
+    bool asBool(bool fallback = false) const { return m_type == Type::Bool ? m_bool : fallback; }
+    double asNumber(double fallback = 0.0) const { return m_type == Type::Number ? m_number : fallback; }
+    const std::string& asString() const { return m_string; }
+
+    // Arrays; size() is 0 for every other type
+    size_t size() const { return m_type == Type::Array ? m_elements.size() : 0; }
+    const JsonValue& at(size_t index) const;
+
+    // Objects; missing members read as a shared null value
+    const JsonValue& operator[](const char* key) const;
+    bool has(const char* key) const { return !(*this)[key].isNull(); }
+    const std::vector<std::pair<std::string, JsonValue>>& getMembers() const { return m_members; }
+
+private:
+    friend class JsonReader;
+
+    Type m_type = Type::Null;
+    bool m_bool = false;
+    double m_number = 0.0;
+    std::string m_string;
+    std::vector<JsonValue> m_elements;
+    std::vector<std::pair<std::string, JsonValue>> m_members;
+};
+
+} // namespace RenderEngine
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace RenderEngine {
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * The contents are paged in by the OS on first access instead of being
+ * read into a heap buffer. Empty files open successfully with a null
+ * data pointer and a size of 0.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Non-copyable
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return m_open; }
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    bool m_open;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
+
+} // namespace RenderEngine
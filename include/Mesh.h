@@ -5,6 +5,9 @@
 #else
     #include <glad/glad.h>
 #endif
+#include "Vertex.h"
+#include "GeometryArena.h"
+#include "MeshOptimizer.h"
 #include <glm/glm.hpp>
 #include <vector>
 #include <string>
@@ -12,27 +15,41 @@
 
 namespace RenderEngine {
 
-/**
- * @brief Vertex structure for 3D meshes
- */
-struct Vertex {
-    glm::vec3 position;
-    glm::vec3 normal;
-    glm::vec2 texCoords;
-
-    Vertex(const glm::vec3& pos, const glm::vec3& norm, const glm::vec2& tex)
-        : position(pos), normal(norm), texCoords(tex) {}
-};
+class InstanceBuffer;
+struct StagedMesh;
 
 /**
- * @brief 3D mesh with vertex data and OpenGL buffers
+ * @brief 3D mesh with vertex data stored in the GeometryArena
  * 
- * Manages vertex buffer objects (VBO), vertex array objects (VAO),
- * and element buffer objects (EBO) for efficient rendering.
+ * The vertices and indices are copied into a shared arena page; the mesh
+ * only records where they live and draws with a base vertex, so meshes
+ * sharing a page also share one vertex array object. Vertices are packed
+ * into the requested VertexPacking on upload; shaders declare their
+ * inputs with getVertexInputGLSL() for the same packing.
+ *
+ * Unless told otherwise, construction runs MeshOptimizer over the data,
+ * and meshes with at most 65536 vertices are drawn with 16-bit indices.
+ * No CPU copy is kept once the data is uploaded.
+ *
+ * Loaders whose data is already in a drawable layout can pass raw
+ * attribute streams with their own VertexFormat instead; those are
+ * uploaded as-is, without packing or optimization.
  */
 class Mesh {
 public:
-    Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+    static constexpr VertexPacking kDefaultPacking = VertexPacking::Compact;
+
+    // Takes the vectors by value; move them in to avoid copying large meshes
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices,
+         VertexPacking packing = kDefaultPacking, bool optimize = true);
+    // streams holds one pointer for interleaved formats and one per
+    // attribute for planar ones. packing names the shader inputs the format
+    // is compatible with. indexType is GL_UNSIGNED_BYTE, _SHORT or _INT.
+    Mesh(const VertexFormat& format, VertexPacking packing, const void* const* streams, size_t vertexCount,
+         const void* indices, size_t indexCount, GLenum indexType,
+         const glm::mat4& positionTransform = glm::mat4(1.0f));
+    // Uploads a mesh prepared by StagedModel
+    explicit Mesh(const StagedMesh& staged);
     ~Mesh();
 
     // Non-copyable, movable
@@ -42,15 +59,54 @@ public:
     Mesh& operator=(Mesh&& other) noexcept;
 
     void draw() const;
-    unsigned int getVAO() const { return m_VAO; }
-    size_t getIndexCount() const { return m_indices.size(); }
+    void drawInstanced(size_t instanceCount) const;
+    // Points the buffer's per-instance attributes into this mesh's VAO,
+    // starting at instance firstInstance of the buffer. The VAO is shared
+    // with other meshes, so bind right before each instanced draw.
+    void bindInstanceBuffer(const InstanceBuffer& buffer, size_t firstInstance = 0) const;
+    unsigned int getVAO() const;
+    size_t getIndexCount() const { return m_indexCount; }
+    size_t getVertexCount() const { return m_vertexCount; }
+    // Unique per mesh, unlike the VAO
+    unsigned int getId() const { return m_id; }
+
+    VertexPacking getPacking() const { return m_packing; }
+    // Maps the stored positions back to model space; identity unless the
+    // packing is Quantized, in which case it must follow the model matrix
+    const glm::mat4& getPositionTransform() const { return m_positionTransform; }
+    // Distance from the model-space origin to the farthest vertex; 0 for
+    // raw streams, whose positions are not read on the CPU
+    float getBoundingRadius() const { return m_boundingRadius; }
+    size_t getVertexBytes() const { return m_vertexBytes; }
+    GLenum getIndexType() const { return m_indexType; }
+    // Vertex and index bytes held in the arena
+    size_t getGeometryBytes() const;
+    // Vertex cache statistics from construction; before equals after when
+    // the mesh was not optimized, and both are zero for raw streams
+    const MeshOptimizationReport& getOptimizationReport() const { return m_optimizationReport; }
+
+    // Draw calls issued by all meshes since the last reset
+    static unsigned int getDrawCallCount() { return s_drawCallCount; }
+    static void resetDrawCallCount() { s_drawCallCount = 0; }
 
 private:
-    void setupMesh();
+    void setupMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+    void upload(const VertexFormat& format, const void* const* streams, const void* indices, size_t indexBytes);
+    void releaseGeometry();
+
+    VertexPacking m_packing;
+    glm::mat4 m_positionTransform;
+    float m_boundingRadius;
+    GLenum m_indexType;
+    size_t m_vertexCount;
+    size_t m_indexCount;
+    size_t m_vertexBytes;
+    MeshOptimizationReport m_optimizationReport;
+    GeometryAllocation m_allocation;
+    unsigned int m_id;
 
-    std::vector<Vertex> m_vertices;
-    std::vector<unsigned int> m_indices;
-    unsigned int m_VAO, m_VBO, m_EBO;
+    static unsigned int s_drawCallCount;
+    static unsigned int s_nextId;
 };
 
 } // namespace RenderEngine
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+
+namespace RenderEngine {
+
+struct Vertex;
+
+/**
+ * @brief Post-transform vertex cache efficiency of an index buffer
+ *
+ * ACMR is vertex shader invocations per triangle (0.5 is ideal for large
+ * regular meshes, 3 is the worst case); ATVR is invocations per unique
+ * vertex (1 is ideal).
+ */
+struct VertexCacheStats {
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+/**
+ * @brief Cache statistics of a mesh before and after optimization
+ */
+struct MeshOptimizationReport {
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+/**
+ * @brief Reorders triangles and vertices for faster rendering
+ *
+ * optimize() runs the full pipeline:
+ * 1. Vertex cache ordering after Forsyth's linear-speed algorithm
+ * 2. Overdraw ordering: the cache-ordered triangles are split into
+ *    clusters where the cache restarts, and clusters facing away from the
+ *    mesh center are drawn first so they occlude the rest
+ * 3. Vertex fetch ordering: vertices are renumbered in first-use order so
+ *    the vertex buffer is read front to back; unused vertices are dropped
+ *
+ * The individual passes are available for callers that need a subset.
+ *
+ * simplify() builds coarser levels of detail by vertex clustering: all
+ * vertices in one cell of a uniform grid merge into their average, and
+ * triangles that collapse are dropped. It is fast and robust on any
+ * input, at the cost of less faithful results than edge collapse.
+ */
+class MeshOptimizer {
+public:
+    // FIFO cache size used for statistics; close to current GPUs
+    static constexpr size_t kAnalysisCacheSize = 16;
+    // Clusters split only where their ACMR stays below this multiple of the whole mesh's
+    static constexpr float kOverdrawThreshold = 1.05f;
+
+    static MeshOptimizationReport optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+    static void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+                                 float threshold = kOverdrawThreshold);
+    static void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    // Moves no vertex further than cellSize * sqrt(3); returns false when
+    // nothing is left of the mesh
+    static bool simplify(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, float cellSize);
+
+    static VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount,
+                                               size_t cacheSize = kAnalysisCacheSize);
+
+    // 16-bit indices address up to 65536 vertices (no primitive restart is used)
+    static bool fitsShortIndices(size_t vertexCount) { return vertexCount <= 0x10000; }
+};
+
+} // namespace RenderEngine
@@ -5,6 +5,7 @@
 #else
     #include <glad/glad.h>
 #endif
+#include "VertexFormat.h"
 #include <glm/glm.hpp>
 #include <vector>
 #include <memory>
@@ -13,6 +14,7 @@
 namespace RenderEngine {
     class Mesh;
     class Shader;
+    class InstanceBuffer;
 }
 
 namespace RenderEngine {
@@ -20,28 +22,73 @@ namespace RenderEngine {
 /**
  * @brief 3D model container holding multiple meshes
  * 
- * Can load models from files (using Assimp) or be constructed
- * programmatically. For this demo, we'll create simple geometric
- * models programmatically.
+ * Can load Wavefront OBJ files through loadOBJ(), binary glTF files
+ * through loadGLB(), cooked .rmesh files through loadCooked(), or be
+ * constructed programmatically from the simple shape factories.
+ * 
+ * A model may carry a chain of levels of detail, each a full set of
+ * meshes; level 0 is the most detailed and is what draw() uses. Levels are
+ * picked by projected screen-space radius against per-level thresholds.
+ *
+ * While a Renderer exists, the factories and loaders return models shared
+ * through its AssetCache: the shapes are keyed by their parameters and
+ * files by their content, so repeated calls upload nothing new, and an
+ * unchanged file is recognized without being read again. Models
+ * obtained this way must not be modified.
  */
 class Model {
 public:
+    // Fraction a threshold must be crossed by before the level changes
+    static constexpr float kLodHysteresis = 0.15f;
+
     Model();
     ~Model() = default;
 
-    void addMesh(std::shared_ptr<Mesh> mesh);
+    void addMesh(std::shared_ptr<Mesh> mesh, size_t lod = 0);
     void draw(std::shared_ptr<Shader> shader) const;
     void draw() const;
+    void drawInstanced(size_t instanceCount, size_t lod = 0) const;
+    void bindInstanceBuffer(const InstanceBuffer& buffer, size_t lod = 0);
 
-    size_t getMeshCount() const { return m_meshes.size(); }
+    size_t getMeshCount() const { return m_lods[0].size(); }
+    // Arena bytes of the meshes of all levels
+    size_t getGeometryBytes() const;
+    // True if a mesh is also held outside this model, so destroying the
+    // model would not release its arena allocation
+    bool sharesGeometry() const;
+    // Radius of the sphere around the model-space origin that encloses
+    // every mesh of every level; scale it by the instance scale for culling,
+    // collision and the projected radius selectLod() takes
+    float getBoundingRadius() const { return m_boundingRadius; }
+    const std::vector<std::shared_ptr<Mesh>>& getMeshes(size_t lod = 0) const { return m_lods[lod]; }
+
+    // Level of detail
+    size_t getLodCount() const { return m_lods.size(); }
+    // screenRadii[i] is the projected radius in pixels at and above which
+    // level i is preferred over level i + 1 (one entry per level but the last)
+    void setLodThresholds(const std::vector<float>& screenRadii) { m_lodThresholds = screenRadii; }
+    size_t selectLod(float screenRadius, size_t currentLod) const;
 
     // Factory methods for creating simple shapes
     static std::shared_ptr<Model> createCube();
-    static std::shared_ptr<Model> createSphere(int segments = 32);
+    // Each further LOD level halves the segment count (minimum 4)
+    static std::shared_ptr<Model> createSphere(int segments = 32, int lodLevels = 1);
     static std::shared_ptr<Model> createPlane(float size = 1.0f);
 
+    // One mesh per OBJ object/group; returns nullptr on failure
+    static std::shared_ptr<Model> loadOBJ(const std::string& path,
+                                          VertexPacking packing = VertexPacking::Compact);
+    // One mesh per glTF primitive, uploaded straight from the mapped file
+    // where its layout allows; returns nullptr on failure
+    static std::shared_ptr<Model> loadGLB(const std::string& path);
+    // Meshes, LOD levels and thresholds of a CookedMeshFile, uploaded
+    // straight from the mapped blobs; returns nullptr on failure
+    static std::shared_ptr<Model> loadCooked(const std::string& path);
+
 private:
-    std::vector<std::shared_ptr<Mesh>> m_meshes;
+    std::vector<std::vector<std::shared_ptr<Mesh>>> m_lods;
+    std::vector<float> m_lodThresholds;
+    float m_boundingRadius;
 };
 
 } // namespace RenderEngine
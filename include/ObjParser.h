@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Vertex.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace RenderEngine {
+
+/**
+ * @brief Faces of an OBJ file between two o/g statements, ready for Mesh
+ */
+struct ObjGroup {
+    std::string name;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+/**
+ * @brief Multithreaded Wavefront OBJ parser
+ *
+ * The text is split at line boundaries into one range per thread; each
+ * range is parsed into flat position, normal, texture coordinate and face
+ * arrays with a hand-rolled number parser (no locale, no iostreams).
+ * Relative indices are resolved once every range's counts are known.
+ * Identical position/texcoord/normal triplets are then merged through an
+ * open-addressing hash table into indexed vertices.
+ *
+ * Supports v, vt, vn, f (polygons are fan-triangulated), o and g; other
+ * statements are ignored. Faces without normals get smooth area-weighted
+ * normals. Does not depend on GL, so tools can use it.
+ */
+class ObjParser {
+public:
+    // Each thread parses at least this many bytes
+    static constexpr size_t kMinChunkBytes = 1024 * 1024;
+
+    // threadCount 0 uses the hardware concurrency. Groups without faces are
+    // dropped; on failure error describes the problem.
+    static bool parse(const char* text, size_t size, std::vector<ObjGroup>& groups, std::string& error,
+                      unsigned int threadCount = 0);
+};
+
+} // namespace RenderEngine
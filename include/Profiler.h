@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Tracer.h"
+#include <cstdint>
+#include <iosfwd>
+
+namespace RenderEngine {
+
+/**
+ * @brief Hierarchical CPU frame profiler with scoped timing zones
+ * 
+ * Zones are opened and closed with the PROFILE_SCOPE macro. Each thread
+ * records completed zones into its own lock-free ring buffer; nesting is
+ * tracked per thread so every zone is identified by its path from the root
+ * (e.g. "update/checkCollisions"). Once per frame PROFILE_FRAME drains all
+ * ring buffers, sums each path's time for the frame and folds the result
+ * into per-path statistics. PROFILE_REPORT prints a min/avg/p99/max table.
+ * 
+ * The profiler parts of the macros compile to nothing unless the engine is
+ * built with RENDERENGINE_ENABLE_PROFILER. PROFILE_SCOPE also opens a
+ * TraceScope in every build, so a Tracer capture records the same zones
+ * with or without the profiler, and none are lost when a ring overflows.
+ */
+class Profiler {
+public:
+    static void beginZone(const char* name);
+    static void endZone();
+
+    // Closes the current frame: drains every thread's events and aggregates them
+    static void endFrame();
+
+    // Adds externally measured time (e.g. GPU timers) to the current frame
+    static void recordSample(const char* name, double milliseconds);
+
+    static void printReport(std::ostream& out);
+    static void reset();
+};
+
+/**
+ * @brief RAII helper opening a profiler zone for the enclosing scope
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) { Profiler::beginZone(name); }
+    ~ProfileScope() { Profiler::endZone(); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+} // namespace RenderEngine
+
+#ifdef RENDERENGINE_ENABLE_PROFILER
+    #define RE_PROFILE_CONCAT_INNER(a, b) a##b
+    #define RE_PROFILE_CONCAT(a, b) RE_PROFILE_CONCAT_INNER(a, b)
+    // name must be a string literal or otherwise outlive the program
+    #define PROFILE_SCOPE(name) \
+        ::RenderEngine::ProfileScope RE_PROFILE_CONCAT(profileScope_, __LINE__)(name); \
+        ::RenderEngine::TraceScope RE_PROFILE_CONCAT(traceScope_, __LINE__)(name)
+    #define PROFILE_FRAME() ::RenderEngine::Profiler::endFrame()
+    #define PROFILE_SAMPLE(name, milliseconds) ::RenderEngine::Profiler::recordSample(name, milliseconds)
+    #define PROFILE_REPORT(stream) ::RenderEngine::Profiler::printReport(stream)
+#else
+    #define RE_PROFILE_CONCAT_INNER(a, b) a##b
+    #define RE_PROFILE_CONCAT(a, b) RE_PROFILE_CONCAT_INNER(a, b)
+    #define PROFILE_SCOPE(name) ::RenderEngine::TraceScope RE_PROFILE_CONCAT(traceScope_, __LINE__)(name)
+    #define PROFILE_FRAME() ((void)0)
+    #define PROFILE_SAMPLE(name, milliseconds) ((void)0)
+    #define PROFILE_REPORT(stream) ((void)0)
+#endif
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "InstanceBuffer.h"
+
+namespace RenderEngine {
+
+class Shader;
+class Mesh;
+
+/**
+ * @brief Per-draw surface parameters set through the shader's
+ * "objectColor" and "shininess" uniforms
+ */
+struct Material {
+    glm::vec3 color = glm::vec3(0.8f);
+    float shininess = 32.0f;
+
+    bool operator==(const Material& other) const {
+        return color == other.color && shininess == other.shininess;
+    }
+};
+
+/**
+ * @brief Everything needed to issue one draw of a mesh
+ *
+ * The shader must read its model matrix from the per-instance mat4 at
+ * RenderQueue::kInstanceTransformLocation instead of a uniform; the
+ * mesh's position transform is folded in for quantized vertices. Depth is
+ * the view-space distance used to order the draw.
+ */
+struct DrawPacket {
+    const Shader* shader = nullptr;
+    const Mesh* mesh = nullptr;
+    Material material;
+    glm::mat4 transform = glm::mat4(1.0f);
+    float depth = 0.0f;
+    bool transparent = false;
+};
+
+/**
+ * @brief Deferred, sorted list of draw packets
+ *
+ * Packets collected by submit() are ordered on flush() by 64-bit keys
+ * with an LSD radix sort. Opaque keys group by program, mesh and
+ * material and then go front-to-back; transparent keys sort back-to-front
+ * first. Consecutive packets sharing program, mesh and material become
+ * one instanced draw: all transforms are uploaded in a single buffer and
+ * each run re-points the mesh's instance attributes at its slice.
+ */
+class RenderQueue {
+public:
+    static constexpr unsigned int kInstanceTransformLocation = 5;
+
+    RenderQueue();
+
+    // Non-copyable
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    void submit(const DrawPacket& packet);
+    void flush();
+
+    size_t size() const { return m_packets.size(); }
+
+    // Instanced draws issued and packets drawn by flushes since the last reset
+    unsigned int getBatchCount() const { return m_batchCount; }
+    unsigned int getPacketCount() const { return m_packetCount; }
+    void resetStats() { m_batchCount = 0; m_packetCount = 0; }
+
+private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    uint64_t makeKey(const DrawPacket& packet);
+    uint32_t getMaterialIndex(const Material& material);
+    void sortEntries();
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<SortEntry> m_entries;
+    std::vector<SortEntry> m_scratch;
+    std::vector<Material> m_materials;
+    std::vector<glm::mat4> m_transforms;
+    InstanceBuffer m_transformBuffer;
+    unsigned int m_batchCount;
+    unsigned int m_packetCount;
+};
+
+} // namespace RenderEngine
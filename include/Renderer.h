@@ -1,14 +1,31 @@
 #pragma once
 
+#include "FrameUniforms.h"
+#include "Shader.h"
+#include "GLStateCache.h"
+#include "GeometryArena.h"
+#include "AssetCache.h"
+#include "RenderQueue.h"
 #include <glm/glm.hpp>
 #include <vector>
 #include <memory>
 
 namespace RenderEngine {
 
-class Shader;
 class Mesh;
 class Model;
+class GpuTimer;
+struct GpuPassTiming;
+
+/**
+ * @brief Per-frame rendering statistics
+ */
+struct RenderStats {
+    unsigned int drawCalls = 0;
+    unsigned int queuedPackets = 0;
+    unsigned int queueBatches = 0;
+    GLStateStats stateCalls;
+};
 
 /**
  * @brief High-level rendering system managing shaders, meshes, and draw calls
@@ -23,23 +40,62 @@ public:
 
     void beginFrame();
     void endFrame();
+
+    // GPU timing of named passes; pass names must be string literals.
+    // Results arrive a few frames late and are published to the profiler.
+    void beginPass(const char* name);
+    void endPass();
+    const std::vector<GpuPassTiming>& getGpuPassTimings() const;
     
     void setViewMatrix(const glm::mat4& view);
     void setProjectionMatrix(const glm::mat4& projection);
     void setViewPosition(const glm::vec3& position);
+    void setLight(const glm::vec3& position, const glm::vec3& color);
+    void setTime(float time);
 
+    // Uploads the per-frame uniform block if any value changed since the
+    // last upload; call once after the camera is set, before drawing
+    void updateFrameUniforms();
+    const FrameUniforms& getFrameUniforms() const { return m_frameUniforms; }
+
+    // Draws are queued and executed sorted and batched by flush(), which
+    // endFrame() calls for anything still pending. Shaders passed here
+    // must take the model matrix as RenderQueue's per-instance attribute.
+    void submit(const DrawPacket& packet);
     void drawMesh(const Mesh& mesh, const glm::mat4& model = glm::mat4(1.0f));
     void drawModel(const Model& model, const glm::mat4& modelMatrix = glm::mat4(1.0f));
+    void drawModel(const Model& model, const glm::mat4& modelMatrix, const Shader& shader,
+                   const Material& material = Material(), bool transparent = false);
+    void flush();
+
+    // The built-in lit shader for meshes of the given vertex packing
+    const Shader& getDefaultShader(VertexPacking packing) const;
 
     void enableDepthTest(bool enable = true);
     void enableBlending(bool enable = true);
     void setClearColor(float r, float g, float b, float a);
 
+    // Statistics of the last frame closed by endFrame()
+    const RenderStats& getFrameStats() const { return m_frameStats; }
+
+    GLStateCache& getStateCache() { return m_stateCache; }
+    GeometryArena& getGeometryArena() { return m_geometryArena; }
+    AssetCache& getAssetCache() { return m_assetCache; }
+
 private:
-    std::shared_ptr<Shader> m_defaultShader;
-    glm::mat4 m_viewMatrix;
-    glm::mat4 m_projectionMatrix;
-    glm::vec3 m_viewPosition;
+    float getViewDepth(const glm::mat4& transform) const;
+
+    GLStateCache m_stateCache;
+    GeometryArena m_geometryArena;
+    // Declared after the arena so cached meshes are released before it
+    AssetCache m_assetCache;
+    std::shared_ptr<Shader> m_defaultShaders[3];
+    RenderQueue m_renderQueue;
+    std::unique_ptr<GpuTimer> m_gpuTimer;
+    FrameUniforms m_frameUniforms;
+    unsigned int m_frameUBO;
+    bool m_frameUniformsDirty;
+    RenderStats m_frameStats;
 };
 
 } // namespace RenderEngine
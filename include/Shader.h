@@ -7,17 +7,51 @@
 #endif
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "UniformTable.h"
 #include <string>
+#include <vector>
+#include <cstdint>
 #include <iostream>
 
 namespace RenderEngine {
 
+/**
+ * @brief Typed location of a uniform in one shader program
+ *
+ * Resolved once from the program's reflection table; an invalid handle
+ * (uniform missing, optimized out or of another type) is ignored by set().
+ */
+template <typename T>
+struct UniformHandle {
+    int location = -1;
+
+    bool isValid() const { return location >= 0; }
+};
+
+// GL type each handle type must match in the reflected program
+template <typename T> struct UniformGLType;
+template <> struct UniformGLType<bool> { static constexpr GLenum value = GL_BOOL; };
+template <> struct UniformGLType<int> { static constexpr GLenum value = GL_INT; };
+template <> struct UniformGLType<float> { static constexpr GLenum value = GL_FLOAT; };
+template <> struct UniformGLType<glm::vec2> { static constexpr GLenum value = GL_FLOAT_VEC2; };
+template <> struct UniformGLType<glm::vec3> { static constexpr GLenum value = GL_FLOAT_VEC3; };
+template <> struct UniformGLType<glm::vec4> { static constexpr GLenum value = GL_FLOAT_VEC4; };
+template <> struct UniformGLType<glm::mat2> { static constexpr GLenum value = GL_FLOAT_MAT2; };
+template <> struct UniformGLType<glm::mat3> { static constexpr GLenum value = GL_FLOAT_MAT3; };
+template <> struct UniformGLType<glm::mat4> { static constexpr GLenum value = GL_FLOAT_MAT4; };
+
 /**
  * @brief OpenGL shader program wrapper with uniform management
  * 
  * Handles shader compilation, linking, and provides convenient
  * methods for setting uniforms. Includes error checking and
  * informative error messages.
+ *
+ * Active uniforms are reflected once at link time into a UniformTable
+ * keyed by name hash; a program whose active uniforms share a hash fails
+ * to load, so a handle never resolves to the wrong uniform. Hot paths resolve a
+ * UniformHandle up front and call set(), which neither builds strings nor
+ * queries the driver for locations.
  */
 class Shader {
 public:
@@ -36,7 +70,24 @@ public:
     void use() const;
     unsigned int getId() const { return m_id; }
 
-    // Uniform setters
+    // Typed handles, resolved once after loading from a constexpr
+    // hashUniformName() constant
+    template <typename T>
+    UniformHandle<T> getUniform(uint32_t nameHash) const {
+        return UniformHandle<T>{findUniform(nameHash, UniformGLType<T>::value)};
+    }
+
+    void set(UniformHandle<bool> handle, bool value) const;
+    void set(UniformHandle<int> handle, int value) const;
+    void set(UniformHandle<float> handle, float value) const;
+    void set(UniformHandle<glm::vec2> handle, const glm::vec2& value) const;
+    void set(UniformHandle<glm::vec3> handle, const glm::vec3& value) const;
+    void set(UniformHandle<glm::vec4> handle, const glm::vec4& value) const;
+    void set(UniformHandle<glm::mat2> handle, const glm::mat2& value) const;
+    void set(UniformHandle<glm::mat3> handle, const glm::mat3& value) const;
+    void set(UniformHandle<glm::mat4> handle, const glm::mat4& value) const;
+
+    // Name-based uniform setters (looked up in the reflection table)
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
     void setFloat(const std::string& name, float value) const;
@@ -47,9 +98,17 @@ public:
     void setMat3(const std::string& name, const glm::mat3& value) const;
     void setMat4(const std::string& name, const glm::mat4& value) const;
 
+    // Binds a named uniform block to a buffer binding point; no-op if the
+    // program does not declare the block
+    void bindUniformBlock(const std::string& blockName, unsigned int bindingPoint) const;
+
 private:
     unsigned int m_id;
+    UniformTable m_uniforms;
     
+    // Fails if two active uniform names share a hash
+    bool reflectUniforms();
+    int findUniform(uint32_t nameHash, GLenum expectedType) const;
     bool compileShader(unsigned int& shader, const std::string& source, GLenum type);
     bool linkProgram(unsigned int program);
     std::string readFile(const std::string& filepath);
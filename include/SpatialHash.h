@@ -0,0 +1,144 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+namespace RenderEngine {
+
+/**
+ * @brief Uniform spatial hash grid for sphere and box broadphase queries
+ * 
+ * Objects are identified by small integer ids chosen by the caller (for
+ * example a slot index) and stored as bounding spheres in the cell that
+ * contains their centre. Cells are hashed into a fixed bucket table and
+ * entries are linked intrusively, so insert and remove are O(1) and do not
+ * allocate once the id range has been seen.
+ * 
+ * Queries expand their range by the largest radius inserted so far, which
+ * keeps them exact as long as the cell size is chosen from the largest
+ * expected bounding radius.
+ */
+class SpatialHash {
+public:
+    using Id = std::uint32_t;
+
+    explicit SpatialHash(float cellSize, size_t bucketCount = 4096);
+
+    void insert(Id id, const glm::vec3& center, float radius);
+    void remove(Id id);
+    void update(Id id, const glm::vec3& center, float radius);
+    void clear();
+
+    bool contains(Id id) const;
+    size_t size() const { return m_count; }
+    float getCellSize() const { return m_cellSize; }
+
+    // Collects ids whose bounding sphere overlaps the query volume
+    void querySphere(const glm::vec3& center, float radius, std::vector<Id>& results) const;
+    void queryAABB(const glm::vec3& min, const glm::vec3& max, std::vector<Id>& results) const;
+
+    // Allocation-free variants invoking fn(id) for every overlapping object
+    template <typename Fn>
+    void forEachInSphere(const glm::vec3& center, float radius, Fn&& fn) const;
+    template <typename Fn>
+    void forEachInAABB(const glm::vec3& min, const glm::vec3& max, Fn&& fn) const;
+
+private:
+    static constexpr Id kInvalidId = 0xFFFFFFFFu;
+
+    struct Entry {
+        glm::vec3 center;
+        float radius;
+        std::int32_t cellX, cellY, cellZ;
+        Id prev;
+        Id next;
+        bool active;
+    };
+
+    std::int32_t cellCoord(float value) const {
+        return static_cast<std::int32_t>(std::floor(value * m_invCellSize));
+    }
+    size_t bucketIndex(std::int32_t x, std::int32_t y, std::int32_t z) const;
+
+    // Visits every entry whose cell lies in [min, max] after expanding the
+    // range by the largest inserted radius; fn filters exact overlap
+    template <typename Fn>
+    void forEachCandidate(const glm::vec3& min, const glm::vec3& max, Fn&& fn) const;
+
+    std::vector<Entry> m_entries;
+    std::vector<Id> m_buckets;
+    size_t m_bucketMask;
+    size_t m_count;
+    float m_cellSize;
+    float m_invCellSize;
+    float m_maxRadius;
+};
+
+template <typename Fn>
+void SpatialHash::forEachCandidate(const glm::vec3& min, const glm::vec3& max, Fn&& fn) const {
+    if (m_count == 0) return;
+
+    glm::vec3 margin(m_maxRadius);
+    glm::vec3 lo = min - margin;
+    glm::vec3 hi = max + margin;
+    std::int32_t x0 = cellCoord(lo.x), x1 = cellCoord(hi.x);
+    std::int32_t y0 = cellCoord(lo.y), y1 = cellCoord(hi.y);
+    std::int32_t z0 = cellCoord(lo.z), z1 = cellCoord(hi.z);
+
+    // A query covering more cells than there are buckets is cheaper as a
+    // single pass over the table
+    double cellCount = double(x1 - x0 + 1) * double(y1 - y0 + 1) * double(z1 - z0 + 1);
+    if (cellCount > static_cast<double>(m_buckets.size())) {
+        for (Id head : m_buckets) {
+            for (Id id = head; id != kInvalidId; id = m_entries[id].next) {
+                fn(id, m_entries[id]);
+            }
+        }
+        return;
+    }
+
+    for (std::int32_t z = z0; z <= z1; ++z) {
+        for (std::int32_t y = y0; y <= y1; ++y) {
+            for (std::int32_t x = x0; x <= x1; ++x) {
+                Id id = m_buckets[bucketIndex(x, y, z)];
+                for (; id != kInvalidId; id = m_entries[id].next) {
+                    const Entry& entry = m_entries[id];
+                    // Buckets are shared between cells; skip entries that
+                    // belong to a different cell so nothing is reported twice
+                    if (entry.cellX == x && entry.cellY == y && entry.cellZ == z) {
+                        fn(id, entry);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename Fn>
+void SpatialHash::forEachInSphere(const glm::vec3& center, float radius, Fn&& fn) const {
+    forEachCandidate(center - glm::vec3(radius), center + glm::vec3(radius),
+        [&](Id id, const Entry& entry) {
+            glm::vec3 d = entry.center - center;
+            float r = radius + entry.radius;
+            if (glm::dot(d, d) < r * r) {
+                fn(id);
+            }
+        });
+}
+
+template <typename Fn>
+void SpatialHash::forEachInAABB(const glm::vec3& min, const glm::vec3& max, Fn&& fn) const {
+    forEachCandidate(min, max,
+        [&](Id id, const Entry& entry) {
+            glm::vec3 closest = glm::clamp(entry.center, min, max);
+            glm::vec3 d = entry.center - closest;
+            if (glm::dot(d, d) <= entry.radius * entry.radius) {
+                fn(id);
+            }
+        });
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "VertexFormat.h"
+#include "CookedMesh.h"
+#include "MappedFile.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace RenderEngine {
+
+/**
+ * @brief File formats Model can load
+ */
+enum class ModelFileType {
+    OBJ,
+    GLB,
+    Cooked
+};
+
+/**
+ * @brief One mesh in GPU-ready form, as the Mesh raw stream constructor takes it
+ */
+struct StagedMesh {
+    VertexFormat format;
+    VertexPacking packing = VertexPacking::Float;
+    const void* streams[kCookedMaxAttributes] = {};
+    size_t vertexCount = 0;
+    const void* indices = nullptr;
+    size_t indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    glm::mat4 positionTransform = glm::mat4(1.0f);
+    float boundingRadius = 0.0f;  // As in Mesh::getBoundingRadius, in model space
+    size_t lod = 0;
+    bool mapped = false;        // Streams point into the file rather than decoded copies
+
+    size_t getGeometryBytes() const;
+};
+
+/**
+ * @brief A model file read and decoded without calling GL
+ *
+ * open() maps the file and keys it by path, modification time and size;
+ * getContentKey() hashes the content on first use, which callers skip
+ * when the file key is already cached. stage() parses it and prepares every mesh exactly as Model uploads it:
+ * OBJ groups are optimized and packed, GLB primitives point into the
+ * mapped file where their layout allows and are decoded like OBJ groups
+ * otherwise, and cooked meshes always point into the file. Staged streams
+ * stay valid as long as the StagedModel, which must therefore outlive
+ * the upload.
+ *
+ * Everything up to the upload can run on any thread; the Model loaders
+ * use it inline and AsyncLoader on its workers.
+ */
+class StagedModel {
+public:
+    StagedModel() = default;
+
+    // Non-copyable
+    StagedModel(const StagedModel&) = delete;
+    StagedModel& operator=(const StagedModel&) = delete;
+
+    // packing applies to OBJ files, which are packed while staging
+    bool open(const std::string& path, ModelFileType type, VertexPacking packing = VertexPacking::Compact);
+    // The file key open() would assign, without opening the file
+    static std::string makeFileKey(const std::string& path, ModelFileType type, VertexPacking packing);
+    // parserThreads is passed to ObjParser; on failure error describes the problem
+    bool stage(std::string& error, unsigned int parserThreads = 0);
+
+    const std::string& getPath() const { return m_path; }
+    // AssetCache::makeFileKey of the opened file
+    const std::string& getFileKey() const { return m_fileKey; }
+    // AssetCache::makeContentKey of the file; reads and hashes the whole
+    // file on the first call
+    const std::string& getContentKey();
+    const std::vector<StagedMesh>& getMeshes() const { return m_meshes; }
+    // As in Model::setLodThresholds
+    const std::vector<float>& getLodThresholds() const { return m_lodThresholds; }
+    // Parts of the file that could not be loaded
+    const std::vector<std::string>& getWarnings() const { return m_warnings; }
+    size_t getGeometryBytes() const;
+
+private:
+    bool stageOBJ(std::string& error, unsigned int parserThreads);
+    bool stageGLB(std::string& error);
+    bool stageCooked(std::string& error);
+    void addDecoded(CookedGeometry geometry, size_t lod);
+    const void* keep(std::vector<unsigned char> bytes);
+
+    std::string m_path;
+    ModelFileType m_type = ModelFileType::OBJ;
+    VertexPacking m_packing = VertexPacking::Compact;
+    MappedFile m_file;
+    std::string m_fileKey;
+    std::string m_contentKey;
+    std::vector<StagedMesh> m_meshes;
+    std::vector<float> m_lodThresholds;
+    std::vector<std::string> m_warnings;
+    // Decoded vertex and index data; moving a vector keeps its buffer, so
+    // the staged pointers survive growth of this list
+    std::vector<std::vector<unsigned char>> m_storage;
+};
+
+} // namespace RenderEngine
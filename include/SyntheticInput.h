@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <random>
+#include <cstdint>
+
+namespace RenderEngine {
+
+/**
+ * @brief One tick's worth of player input
+ */
+struct InputFrame {
+    int direction;        // Camera::processKeyboard movement bits
+    float mouseOffsetX;
+    float mouseOffsetY;
+};
+
+/**
+ * @brief Deterministic input stream standing in for a player in headless runs
+ * 
+ * Holds a movement direction for a random duration, sweeps the view with
+ * small mouse offsets and steers back toward the origin whenever the
+ * camera leaves the play area, so soak tests keep walking through the
+ * collectibles. The same seed always produces the same stream.
+ */
+class SyntheticInput {
+public:
+    SyntheticInput(std::uint32_t seed, float areaRadius, float mouseSensitivity);
+
+    InputFrame next(float deltaTime, const glm::vec3& position, const glm::vec3& front);
+
+private:
+    std::mt19937 m_rng;
+    float m_areaRadius;
+    float m_mouseSensitivity;
+    int m_direction;
+    float m_holdTime;
+    float m_turnRate;  // degrees per second
+};
+
+} // namespace RenderEngine
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace RenderEngine {
+
+/**
+ * @brief Chrome trace-event / Perfetto JSON exporter
+ * 
+ * While a capture is running, every TraceScope (which PROFILE_SCOPE opens
+ * whether or not the Profiler is compiled in) is emitted as a complete
+ * ("X") event when it closes, and game code can add counters, instant
+ * events and frame markers. The calling thread only appends a small
+ * binary record to an in-memory chunk; full chunks are handed to a
+ * background writer thread that formats the JSON and does the file I/O,
+ * so neither blocks the game loop. Event names are stored by pointer and
+ * must be string literals or otherwise outlive the capture. Every entry
+ * point is a single relaxed atomic load when no capture is active.
+ * 
+ * The resulting file opens directly in ui.perfetto.dev or chrome://tracing.
+ */
+class Tracer {
+public:
+    static bool start(const std::string& path);
+    // Safe to call when no capture is running
+    static void stop();
+    static bool isActive() { return s_active.load(std::memory_order_relaxed); }
+
+    // Timestamps are steady_clock nanoseconds, as nowNs() returns them
+    static void zone(const char* name, std::uint32_t threadId, std::uint64_t startNs, std::uint64_t endNs);
+    static void counter(const char* name, double value);
+    static void instant(const char* name);
+    static void frame(std::uint64_t frameNumber);
+
+    static std::uint64_t nowNs();
+    // Small id of the calling thread for the "tid" field, in order of first use
+    static std::uint32_t getThreadId();
+
+private:
+    static std::atomic<bool> s_active;
+};
+
+/**
+ * @brief RAII helper emitting the enclosing scope as a trace zone
+ *
+ * Costs one relaxed atomic load when no capture is running. Scopes opened
+ * before a capture starts are not recorded.
+ */
+class TraceScope {
+public:
+    // name must be a string literal or otherwise outlive the capture
+    explicit TraceScope(const char* name)
+        : m_name(Tracer::isActive() ? name : nullptr)
+        , m_startNs(m_name ? Tracer::nowNs() : 0) {
+    }
+    ~TraceScope() {
+        if (m_name) {
+            Tracer::zone(m_name, Tracer::getThreadId(), m_startNs, Tracer::nowNs());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    std::uint64_t m_startNs;
+};
+
+} // namespace RenderEngine
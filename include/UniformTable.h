@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RenderEngine {
+
+/**
+ * @brief 32-bit FNV-1a hash of a uniform name
+ *
+ * Hot paths keep the result in a constexpr constant so the name is hashed
+ * at compile time.
+ */
+constexpr uint32_t hashUniformName(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name != '\0') {
+        hash ^= static_cast<uint8_t>(*name++);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Uniforms of one program, searched by name hash
+ *
+ * Shader fills it from the program's reflection at link time; it holds no
+ * GL state, so the table and its search are usable without a context.
+ * Lookups only see hashes, so build() rejects a program whose names share
+ * a hash rather than letting a handle resolve to the wrong uniform.
+ */
+class UniformTable {
+public:
+    struct UniformInfo {
+        uint32_t nameHash;
+        int location;
+        unsigned int type;      // GLenum of the reflected uniform
+    };
+
+    void clear();
+
+    // Names are kept until build() has checked them for collisions
+    void add(const std::string& name, int location, unsigned int type);
+
+    // Sorts by name hash; clears the table and fails if two names share one
+    bool build();
+
+    const UniformInfo* find(uint32_t nameHash) const;
+    const UniformInfo* find(const std::string& name) const { return find(hashUniformName(name.c_str())); }
+
+    size_t size() const { return m_uniforms.size(); }
+    bool empty() const { return m_uniforms.empty(); }
+
+private:
+    std::vector<UniformInfo> m_uniforms;    // Sorted by nameHash after build()
+    std::vector<std::string> m_names;       // Parallel to m_uniforms until build()
+};
+
+} // namespace RenderEngine
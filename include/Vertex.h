@@ -0,0 +1,21 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace RenderEngine {
+
+/**
+ * @brief Vertex structure for 3D meshes
+ *
+ * Kept free of GL headers so asset parsing code can be shared with tools.
+ */
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+
+    Vertex(const glm::vec3& pos, const glm::vec3& norm, const glm::vec2& tex)
+        : position(pos), normal(norm), texCoords(tex) {}
+};
+
+} // namespace RenderEngine
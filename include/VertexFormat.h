@@ -0,0 +1,116 @@
+#pragma once
+
+#ifdef __APPLE__
+    #include <OpenGL/gl3.h>
+#else
+    #include <glad/glad.h>
+#endif
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace RenderEngine {
+
+// Shader input locations below this hold per-vertex data; instance
+// attributes use the ones above
+constexpr unsigned int kVertexInputLocations = 3;
+
+/**
+ * @brief One per-vertex attribute as passed to glVertexAttribPointer
+ */
+struct VertexAttribute {
+    unsigned int location;
+    int components;
+    GLenum type;
+    bool normalized;
+    size_t offset;
+
+    bool operator==(const VertexAttribute& other) const {
+        return location == other.location && components == other.components &&
+               type == other.type && normalized == other.normalized && offset == other.offset;
+    }
+};
+
+/**
+ * @brief Bytes of one attribute value
+ */
+inline size_t getAttributeSize(const VertexAttribute& attribute) {
+    switch (attribute.type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return attribute.components;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return attribute.components * 2;
+        default:
+            return attribute.components * 4;
+    }
+}
+
+/**
+ * @brief Memory layout of one vertex
+ *
+ * Meshes with equal formats share vertex buffers and a VAO in the
+ * GeometryArena. Interleaved formats store whole vertices stride bytes
+ * apart. Planar formats store each attribute in its own tightly packed
+ * array; offsets are unused and stride is the sum of the attribute sizes.
+ */
+struct VertexFormat {
+    size_t stride = 0;
+    std::vector<VertexAttribute> attributes;
+    bool planar = false;
+
+    bool operator==(const VertexFormat& other) const {
+        return stride == other.stride && planar == other.planar && attributes == other.attributes;
+    }
+    bool operator!=(const VertexFormat& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief How Mesh stores its vertices on the GPU
+ *
+ * Float is the 32-byte Vertex layout as-is. Compact keeps float positions
+ * but stores normals octahedral-encoded in two snorm16 values and texture
+ * coordinates as half floats (20 bytes). Quantized additionally stores
+ * positions as unorm16 relative to the mesh bounds (16 bytes); the mesh
+ * then reports a position transform that must be applied on top of the
+ * model matrix, which RenderQueue does automatically.
+ */
+enum class VertexPacking {
+    Float,
+    Compact,
+    Quantized
+};
+
+/**
+ * @brief GLSL vertex inputs for a packing
+ *
+ * Declares the attributes at locations 0-2 and defines vertexPosition(),
+ * vertexNormal() and vertexTexCoords(), which shaders should use instead
+ * of reading the attributes directly. Compact and Quantized share the
+ * same declarations.
+ */
+const char* getVertexInputGLSL(VertexPacking packing);
+
+struct Vertex;
+
+/**
+ * @brief GPU layout of a packing, interleaved
+ */
+const VertexFormat& getVertexFormat(VertexPacking packing);
+
+/**
+ * @brief Converts vertices to a packing's layout
+ *
+ * Returns the transform that maps the stored positions back to model
+ * space, which is the identity for every packing but Quantized.
+ */
+glm::mat4 packVertices(const std::vector<Vertex>& vertices, VertexPacking packing, std::vector<unsigned char>& packed);
+
+// Encoders for the packed attributes
+void encodeOctahedral(const glm::vec3& normal, std::int16_t encoded[2]);
+std::uint16_t encodeHalf(float value);
+
+} // namespace RenderEngine
@@ -0,0 +1,154 @@
+#include "AllocationCounter.h"
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+#ifdef RENDERENGINE_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> g_allocationCount{0};
+// Constant-initialized, so reading it never allocates
+thread_local std::uint64_t t_allocationCount = 0;
+
+void countAllocation() {
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    ++t_allocationCount;
+}
+
+void* allocateAligned(std::size_t size, std::size_t alignment) {
+#ifdef _WIN32
+    return _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, alignment, size == 0 ? 1 : size) == 0 ? ptr : nullptr;
+#endif
+}
+
+void freeAligned(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    countAllocation();
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+// Over-aligned types go through these; without them they would bypass
+// the count
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    countAllocation();
+    if (void* ptr = allocateAligned(size, static_cast<std::size_t>(alignment))) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    freeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    freeAligned(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    freeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    freeAligned(ptr);
+}
+#endif
+
+namespace RenderEngine {
+
+bool AllocationCounter::isEnabled() {
+#ifdef RENDERENGINE_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::uint64_t AllocationCounter::getCount() {
+#ifdef RENDERENGINE_COUNT_ALLOCATIONS
+    return g_allocationCount.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+std::uint64_t AllocationCounter::getThreadCount() {
+#ifdef RENDERENGINE_COUNT_ALLOCATIONS
+    return t_allocationCount;
+#else
+    return 0;
+#endif
+}
+
+std::uint64_t AllocationCounter::getPeakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    // Linux reports kilobytes
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,151 @@
+#include "AssetCache.h"
+#include "Model.h"
+#include "ContentHash.h"
+#include <cstdio>
+#include <filesystem>
+
+namespace RenderEngine {
+
+namespace {
+
+AssetCache* s_current = nullptr;
+
+} // namespace
+
+AssetCache::AssetCache(size_t budgetBytes) {
+    m_stats.budgetBytes = budgetBytes;
+}
+
+AssetCache::~AssetCache() {
+    if (s_current == this) {
+        s_current = nullptr;
+    }
+}
+
+AssetCache* AssetCache::current() {
+    return s_current;
+}
+
+void AssetCache::makeCurrent() {
+    s_current = this;
+}
+
+std::shared_ptr<Model> AssetCache::find(const std::string& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        m_stats.misses++;
+        return nullptr;
+    }
+    m_stats.hits++;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->model;
+}
+
+std::shared_ptr<Model> AssetCache::getOrCreate(const std::string& key,
+                                               const std::function<std::shared_ptr<Model>()>& factory) {
+    if (std::shared_ptr<Model> model = find(key)) {
+        return model;
+    }
+
+    std::shared_ptr<Model> model = factory();
+    if (model) {
+        insert(key, model);
+    }
+    return model;
+}
+
+void AssetCache::insert(const std::string& key, std::shared_ptr<Model> model) {
+    size_t bytes = model->getGeometryBytes();
+    insert(key, std::move(model), bytes);
+}
+
+void AssetCache::insert(const std::string& key, std::shared_ptr<Model> model, size_t bytes) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_stats.residentBytes -= it->second->bytes;
+        it->second->model = std::move(model);
+        it->second->bytes = bytes;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+    } else {
+        m_entries.push_front({key, std::move(model), bytes});
+        m_index[key] = m_entries.begin();
+    }
+    m_stats.residentBytes += bytes;
+    m_stats.entryCount = m_entries.size();
+    trim();
+}
+
+std::shared_ptr<Model> AssetCache::findFile(const std::string& fileKey) {
+    auto file = m_fileKeys.find(fileKey);
+    if (file == m_fileKeys.end()) {
+        return nullptr;
+    }
+    auto it = m_index.find(file->second);
+    if (it == m_index.end()) {
+        return nullptr;
+    }
+    m_stats.hits++;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->model;
+}
+
+void AssetCache::addFileKey(const std::string& fileKey, const std::string& key) {
+    if (!fileKey.empty()) {
+        m_fileKeys[fileKey] = key;
+    }
+}
+
+void AssetCache::setBudget(size_t budgetBytes) {
+    m_stats.budgetBytes = budgetBytes;
+    trim();
+}
+
+void AssetCache::trim() {
+    // Only entries this cache holds the last reference to free any memory;
+    // erasing one destroys its meshes, which returns their arena space
+    for (auto it = m_entries.end(); it != m_entries.begin() && m_stats.residentBytes > m_stats.budgetBytes;) {
+        --it;
+        if (it->model.use_count() > 1 || it->model->sharesGeometry()) continue;
+
+        for (auto file = m_fileKeys.begin(); file != m_fileKeys.end();) {
+            file = file->second == it->key ? m_fileKeys.erase(file) : std::next(file);
+        }
+        m_stats.residentBytes -= it->bytes;
+        m_stats.evictions++;
+        m_index.erase(it->key);
+        it = m_entries.erase(it);
+    }
+    m_stats.entryCount = m_entries.size();
+}
+
+void AssetCache::clear() {
+    m_entries.clear();
+    m_index.clear();
+    m_fileKeys.clear();
+    m_stats.residentBytes = 0;
+    m_stats.entryCount = 0;
+}
+
+std::string AssetCache::makeContentKey(const char* kind, const void* data, size_t size) {
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(hashContent(data, size)));
+    // The size makes a hash collision need two files of equal length
+    return std::string(kind) + ":" + hash + ":" + std::to_string(size);
+}
+
+std::string AssetCache::makeFileKey(const char* kind, const std::string& path) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    auto modified = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return std::string();
+    }
+    auto size = std::filesystem::file_size(path, error);
+    if (error) {
+        return std::string();
+    }
+    return std::string(kind) + ":" + absolute.lexically_normal().string() + ":" +
+           std::to_string(modified.time_since_epoch().count()) + ":" + std::to_string(size);
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,117 @@
+#include "AssetManifest.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+
+namespace RenderEngine {
+
+namespace {
+
+constexpr const char* kVersionLine = "# RenderEngine asset manifest 1";
+
+} // namespace
+
+bool AssetManifest::load(const std::string& path, std::string& error) {
+    m_entries.clear();
+
+    std::ifstream file(path);
+    if (!file) {
+        error = "Cannot open " + path;
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != kVersionLine) {
+        error = path + " is not an asset manifest of this version";
+        return false;
+    }
+
+    int lineNumber = 1;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty()) continue;
+
+        std::vector<std::string> fields;
+        std::istringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 5) {
+            error = path + ":" + std::to_string(lineNumber) + ": expected 5 tab-separated fields";
+            m_entries.clear();
+            return false;
+        }
+
+        AssetManifestEntry entry;
+        entry.name = fields[0];
+        entry.path = fields[1];
+        entry.sourceHash = std::strtoull(fields[2].c_str(), nullptr, 16);
+        entry.bytes = std::strtoull(fields[3].c_str(), nullptr, 10);
+        entry.source = fields[4];
+        m_entries.push_back(entry);
+    }
+    return true;
+}
+
+bool AssetManifest::save(const std::string& path, std::string& error) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        error = "Cannot open " + path + " for writing";
+        return false;
+    }
+
+    file << kVersionLine << '\n';
+    for (const auto& entry : m_entries) {
+        char hash[17];
+        std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(entry.sourceHash));
+        file << entry.name << '\t' << entry.path << '\t' << hash << '\t' << entry.bytes << '\t' << entry.source
+             << '\n';
+    }
+
+    if (!file) {
+        error = "Failed writing " + path;
+        return false;
+    }
+    return true;
+}
+
+const AssetManifestEntry* AssetManifest::find(const std::string& name) const {
+    for (const auto& entry : m_entries) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void AssetManifest::set(const AssetManifestEntry& entry) {
+    for (auto& existing : m_entries) {
+        if (existing.name == entry.name) {
+            existing = entry;
+            return;
+        }
+    }
+    m_entries.push_back(entry);
+}
+
+bool AssetManifest::remove(const std::string& name) {
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->name == name) {
+            m_entries.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string AssetManifest::resolve(const std::string& manifestPath, const AssetManifestEntry& entry) {
+    size_t separator = manifestPath.find_last_of("/\\");
+    if (separator == std::string::npos) {
+        return entry.path;
+    }
+    return manifestPath.substr(0, separator + 1) + entry.path;
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,294 @@
+#include "AsyncLoader.h"
+#include "AssetCache.h"
+#include "AssetManifest.h"
+#include "MappedFile.h"
+#include "Mesh.h"
+#include "Model.h"
+#include "Shader.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace RenderEngine {
+
+namespace {
+
+bool readText(const std::string& path, std::string& text, std::string& error) {
+    MappedFile file;
+    if (!file.open(path) || file.size() == 0) {
+        error = path + ": cannot read";
+        return false;
+    }
+    text.assign(file.data(), file.size());
+    return true;
+}
+
+} // namespace
+
+AsyncLoader::AsyncLoader(unsigned int workerCount)
+    : m_parserThreads(0)
+    , m_stopping(false) {
+    workerCount = std::max(workerCount, 1u);
+    // Parallel files already keep the cores busy
+    m_parserThreads = workerCount > 1 ? 1 : 0;
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&AsyncLoader::workerLoop, this);
+    }
+}
+
+AsyncLoader::~AsyncLoader() {
+    stop();
+}
+
+void AsyncLoader::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_requestAvailable.notify_all();
+    m_stagingSpace.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+
+    // Workers hand in what they were staging before exiting, so every
+    // unresolved request is in one of the queues
+    for (const auto& request : m_requests) {
+        resolveFailed(request);
+    }
+    m_requests.clear();
+    for (const auto& asset : m_staged) {
+        resolveFailed(asset->request);
+    }
+    m_staged.clear();
+    if (m_uploading) {
+        resolveFailed(m_uploading->request);
+        m_uploading.reset();
+    }
+}
+
+size_t AsyncLoader::getStagedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_staged.size();
+}
+
+LoadHandle<Model> AsyncLoader::loadOBJ(const std::string& path, VertexPacking packing) {
+    return requestModel(path, ModelFileType::OBJ, packing);
+}
+
+LoadHandle<Model> AsyncLoader::loadGLB(const std::string& path) {
+    return requestModel(path, ModelFileType::GLB, VertexPacking::Float);
+}
+
+LoadHandle<Model> AsyncLoader::loadCooked(const std::string& path) {
+    return requestModel(path, ModelFileType::Cooked, VertexPacking::Float);
+}
+
+LoadHandle<Shader> AsyncLoader::loadShader(const std::string& vertexPath, const std::string& fragmentPath) {
+    LoadHandle<Shader> handle;
+    handle.m_slot = std::make_shared<LoadHandle<Shader>::Slot>();
+
+    Request request;
+    request.path = vertexPath;
+    request.fragmentPath = fragmentPath;
+    request.shader = handle.m_slot;
+    enqueue(std::move(request));
+    return handle;
+}
+
+std::vector<LoadHandle<Model>> AsyncLoader::preload(const std::string& manifestPath) {
+    std::vector<LoadHandle<Model>> handles;
+    AssetManifest manifest;
+    std::string error;
+    if (!manifest.load(manifestPath, error)) {
+        std::cerr << error << std::endl;
+        return handles;
+    }
+
+    for (const auto& entry : manifest.getEntries()) {
+        handles.push_back(loadCooked(AssetManifest::resolve(manifestPath, entry)));
+    }
+    return handles;
+}
+
+LoadHandle<Model> AsyncLoader::requestModel(const std::string& path, ModelFileType type, VertexPacking packing) {
+    LoadHandle<Model> handle;
+    handle.m_slot = std::make_shared<LoadHandle<Model>::Slot>();
+
+    // An unchanged file that is already cached is neither read nor staged
+    AssetCache* cache = AssetCache::current();
+    std::shared_ptr<Model> cached = cache ? cache->findFile(StagedModel::makeFileKey(path, type, packing)) : nullptr;
+    if (cached) {
+        handle.m_slot->asset = cached;
+        handle.m_slot->state = LoadState::Ready;
+        m_stats.completed++;
+        return handle;
+    }
+
+    Request request;
+    request.type = type;
+    request.packing = packing;
+    request.path = path;
+    request.model = handle.m_slot;
+    enqueue(std::move(request));
+    return handle;
+}
+
+void AsyncLoader::enqueue(Request request) {
+    m_stats.pending++;
+    // Only the GL thread sets m_stopping, so no lock is needed to read it
+    if (m_stopping) {
+        resolveFailed(request);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.push_back(std::move(request));
+    }
+    m_requestAvailable.notify_one();
+}
+
+void AsyncLoader::workerLoop() {
+    for (;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_requestAvailable.wait(lock, [this]() { return m_stopping || !m_requests.empty(); });
+            if (m_stopping) return;
+            request = std::move(m_requests.front());
+            m_requests.pop_front();
+        }
+
+        std::unique_ptr<StagedAsset> asset = stage(std::move(request));
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stagingSpace.wait(lock, [this]() { return m_stopping || m_staged.size() < kMaxStagedAssets; });
+        m_staged.push_back(std::move(asset));
+        if (m_stopping) return;
+    }
+}
+
+std::unique_ptr<AsyncLoader::StagedAsset> AsyncLoader::stage(Request request) const {
+    auto asset = std::make_unique<StagedAsset>();
+    asset->request = std::move(request);
+    const Request& staged = asset->request;
+
+    if (staged.shader) {
+        std::string& error = asset->error;
+        if (readText(staged.path, asset->vertexSource, error)) {
+            readText(staged.fragmentPath, asset->fragmentSource, error);
+        }
+    } else if (!asset->model.open(staged.path, staged.type, staged.packing)) {
+        asset->error = staged.path + ": cannot open";
+    } else if (!asset->model.stage(asset->error, m_parserThreads)) {
+        asset->error = staged.path + ": " + asset->error;
+    } else {
+        // Hash here so the GL thread only compares keys
+        asset->model.getContentKey();
+    }
+    return asset;
+}
+
+void AsyncLoader::update(double budgetMilliseconds) {
+    PROFILE_SCOPE("AsyncLoader::update");
+
+    auto start = std::chrono::steady_clock::now();
+    m_stats.uploadedMeshes = 0;
+    m_stats.uploadedBytes = 0;
+
+    while (m_stats.pending > 0) {
+        if (!m_uploading) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_staged.empty()) break;
+                m_uploading = std::move(m_staged.front());
+                m_staged.pop_front();
+            }
+            m_stagingSpace.notify_one();
+        }
+
+        if (uploadStep(*m_uploading)) {
+            m_uploading.reset();
+        }
+
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= budgetMilliseconds) break;
+    }
+
+    m_stats.uploadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool AsyncLoader::uploadStep(StagedAsset& asset) {
+    const Request& request = asset.request;
+    if (!asset.error.empty()) {
+        std::cerr << "Failed to load " << asset.error << std::endl;
+        resolveFailed(request);
+        return true;
+    }
+
+    if (request.shader) {
+        auto shader = std::make_shared<Shader>();
+        if (!shader->loadFromSource(asset.vertexSource, asset.fragmentSource)) {
+            resolveFailed(request);
+            return true;
+        }
+        request.shader->asset = shader;
+        request.shader->state = LoadState::Ready;
+        m_stats.pending--;
+        m_stats.completed++;
+        return true;
+    }
+
+    AssetCache* cache = AssetCache::current();
+    StagedModel& staged = asset.model;
+    if (!asset.result) {
+        for (const auto& warning : staged.getWarnings()) {
+            std::cerr << staged.getPath() << ": skipped " << warning << std::endl;
+        }
+        // The same content may have been loaded since this was requested
+        std::shared_ptr<Model> cached = cache ? cache->find(staged.getContentKey()) : nullptr;
+        if (cached) {
+            cache->addFileKey(staged.getFileKey(), staged.getContentKey());
+            request.model->asset = cached;
+            request.model->state = LoadState::Ready;
+            m_stats.pending--;
+            m_stats.completed++;
+            return true;
+        }
+        asset.result = std::make_shared<Model>();
+        asset.result->setLodThresholds(staged.getLodThresholds());
+    } else {
+        const StagedMesh& mesh = staged.getMeshes()[asset.nextMesh++];
+        asset.result->addMesh(std::make_shared<Mesh>(mesh), mesh.lod);
+        m_stats.uploadedMeshes++;
+        m_stats.uploadedBytes += mesh.getGeometryBytes();
+    }
+
+    if (asset.nextMesh < staged.getMeshes().size()) {
+        return false;
+    }
+
+    if (cache) {
+        cache->insert(staged.getContentKey(), asset.result);
+        cache->addFileKey(staged.getFileKey(), staged.getContentKey());
+    }
+    request.model->asset = asset.result;
+    request.model->state = LoadState::Ready;
+    m_stats.pending--;
+    m_stats.completed++;
+    return true;
+}
+
+void AsyncLoader::resolveFailed(const Request& request) {
+    if (request.model) {
+        request.model->state = LoadState::Failed;
+    } else {
+        request.shader->state = LoadState::Failed;
+    }
+    m_stats.pending--;
+    m_stats.failed++;
+}
+
+} // namespace RenderEngine
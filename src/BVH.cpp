@@ -0,0 +1,448 @@
+#include "BVH.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <limits>
+
+namespace RenderEngine {
+
+namespace {
+
+constexpr int kBinCount = 16;
+
+struct Bounds {
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    void grow(const glm::vec3& lo, const glm::vec3& hi) {
+        min = glm::min(min, lo);
+        max = glm::max(max, hi);
+    }
+
+    float halfArea() const {
+        glm::vec3 e = max - min;
+        return (e.x < 0.0f) ? 0.0f : e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+};
+
+} // namespace
+
+BVH::BVH()
+    : m_count(0)
+    , m_buildRequested(false)
+    , m_workerStopping(false)
+    , m_workerDone(false)
+    , m_rebuilding(false) {
+}
+
+BVH::~BVH() {
+    if (m_worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_workerMutex);
+            m_workerStopping = true;
+        }
+        m_workerWake.notify_one();
+        m_worker.join();
+    }
+}
+
+void BVH::insert(Id id, const glm::vec3& center, float radius) {
+    if (id >= m_entries.size()) {
+        m_entries.resize(id + 1, Entry{glm::vec3(0.0f), 0.0f, false, false});
+    }
+
+    Entry& entry = m_entries[id];
+    if (entry.active) {
+        update(id, center, radius);
+        return;
+    }
+
+    // A reused id may still be referenced by a leaf whose bounds do not
+    // cover the new position; queries ignore that stale reference and find
+    // the object through the pending list instead
+    entry.center = center;
+    entry.radius = radius;
+    entry.active = true;
+    entry.inTree = false;
+    m_pending.push_back(id);
+    m_count++;
+}
+
+void BVH::remove(Id id) {
+    if (!contains(id)) return;
+
+    Entry& entry = m_entries[id];
+    entry.active = false;
+    m_count--;
+
+    if (!entry.inTree) {
+        auto it = std::find(m_pending.begin(), m_pending.end(), id);
+        if (it != m_pending.end()) {
+            *it = m_pending.back();
+            m_pending.pop_back();
+        }
+    }
+}
+
+void BVH::update(Id id, const glm::vec3& center, float radius) {
+    if (!contains(id)) return;
+
+    m_entries[id].center = center;
+    m_entries[id].radius = radius;
+}
+
+void BVH::clear() {
+    cancelRebuild();
+    m_entries.clear();
+    m_nodes.clear();
+    m_order.clear();
+    m_pending.clear();
+    m_count = 0;
+}
+
+void BVH::reserve(size_t capacity) {
+    m_entries.reserve(capacity);
+    m_pending.reserve(capacity);
+    m_workerPrimitives.reserve(capacity);
+    // A binary tree over n leaves has fewer than 2n nodes
+    m_nodes.reserve(2 * capacity);
+    m_workerNodes.reserve(2 * capacity);
+    m_order.reserve(capacity);
+    m_workerOrder.reserve(capacity);
+    startWorker();
+}
+
+bool BVH::contains(Id id) const {
+    return id < m_entries.size() && m_entries[id].active;
+}
+
+void BVH::refit() {
+    PROFILE_SCOPE("BVH::refit");
+
+    // Children are always stored after their parent, so a reverse sweep
+    // sees both children before the node itself
+    for (size_t n = m_nodes.size(); n-- > 0;) {
+        Node& node = m_nodes[n];
+        Bounds bounds;
+        if (node.isLeaf()) {
+            for (std::uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                const Entry& entry = m_entries[m_order[i]];
+                if (entry.active) {
+                    glm::vec3 r(entry.radius);
+                    bounds.grow(entry.center - r, entry.center + r);
+                }
+            }
+        } else {
+            const Node& left = m_nodes[node.leftOrFirst];
+            const Node& right = m_nodes[node.leftOrFirst + 1];
+            bounds.grow(left.min, left.max);
+            bounds.grow(right.min, right.max);
+        }
+        node.min = bounds.min;
+        node.max = bounds.max;
+    }
+}
+
+void BVH::rebuild() {
+    PROFILE_SCOPE("BVH::rebuild");
+
+    // The worker is idle now, so its buffers are free to build in
+    cancelRebuild();
+    snapshot(m_workerPrimitives);
+    build(m_workerPrimitives, m_workerNodes, m_workerOrder);
+    install(m_workerNodes, m_workerOrder);
+}
+
+void BVH::requestRebuild() {
+    if (m_rebuilding) return;
+
+    startWorker();
+    snapshot(m_workerPrimitives);
+    m_workerDone.store(false, std::memory_order_relaxed);
+    m_rebuilding = true;
+    {
+        std::lock_guard<std::mutex> lock(m_workerMutex);
+        m_buildRequested = true;
+    }
+    m_workerWake.notify_one();
+}
+
+bool BVH::pollRebuild() {
+    if (!m_rebuilding || !m_workerDone.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    // The old tree's buffers become the worker's for the next build
+    install(m_workerNodes, m_workerOrder);
+    m_rebuilding = false;
+    return true;
+}
+
+bool BVH::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                  Id& hitId, float& hitDistance) const {
+    float nearest = maxDistance;
+    bool hit = false;
+
+    auto testEntry = [&](Id id) {
+        const Entry& entry = m_entries[id];
+        glm::vec3 oc = origin - entry.center;
+        float b = glm::dot(oc, direction);
+        float c = glm::dot(oc, oc) - entry.radius * entry.radius;
+        float discriminant = b * b - c;
+        if (discriminant < 0.0f) return;
+
+        float root = std::sqrt(discriminant);
+        float t = -b - root;
+        if (t < 0.0f) t = -b + root;   // Origin inside the sphere
+        if (t >= 0.0f && t < nearest) {
+            nearest = t;
+            hitId = id;
+            hit = true;
+        }
+    };
+
+    if (!m_nodes.empty()) {
+        glm::vec3 invDir(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+        // Slab test returning the entry distance, or infinity on a miss
+        auto entryDistance = [&](const Node& node) {
+            glm::vec3 t0 = (node.min - origin) * invDir;
+            glm::vec3 t1 = (node.max - origin) * invDir;
+            glm::vec3 tMin = glm::min(t0, t1);
+            glm::vec3 tMax = glm::max(t0, t1);
+            float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+            float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, nearest));
+            return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+        };
+
+        std::uint32_t stack[kMaxDepth + 2];
+        std::uint32_t top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = m_nodes[stack[--top]];
+            if (entryDistance(node) > nearest) continue;
+
+            if (node.isLeaf()) {
+                for (std::uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                    const Entry& entry = m_entries[m_order[i]];
+                    if (entry.active && entry.inTree) {
+                        testEntry(m_order[i]);
+                    }
+                }
+                continue;
+            }
+
+            // Visit the nearer child first so the farther one is often culled
+            std::uint32_t first = node.leftOrFirst;
+            std::uint32_t second = node.leftOrFirst + 1;
+            float firstDistance = entryDistance(m_nodes[first]);
+            float secondDistance = entryDistance(m_nodes[second]);
+            if (firstDistance > secondDistance) {
+                std::swap(first, second);
+                std::swap(firstDistance, secondDistance);
+            }
+            if (secondDistance <= nearest) stack[top++] = second;
+            if (firstDistance <= nearest) stack[top++] = first;
+        }
+    }
+
+    for (Id id : m_pending) {
+        testEntry(id);
+    }
+
+    if (hit) {
+        hitDistance = nearest;
+    }
+    return hit;
+}
+
+void BVH::build(std::vector<BuildPrimitive>& primitives, std::vector<Node>& nodes,
+                std::vector<Id>& order) {
+    nodes.clear();
+    order.clear();
+    if (primitives.empty()) return;
+
+    auto primitiveBounds = [&](std::uint32_t first, std::uint32_t count) {
+        Bounds bounds;
+        for (std::uint32_t i = first; i < first + count; ++i) {
+            glm::vec3 r(primitives[i].radius);
+            bounds.grow(primitives[i].center - r, primitives[i].center + r);
+        }
+        return bounds;
+    };
+
+    auto makeNode = [&](std::uint32_t first, std::uint32_t count) {
+        Bounds bounds = primitiveBounds(first, count);
+        nodes.push_back({bounds.min, first, bounds.max, count});
+        return static_cast<std::uint32_t>(nodes.size() - 1);
+    };
+
+    nodes.reserve(2 * primitives.size());
+    makeNode(0, static_cast<std::uint32_t>(primitives.size()));
+
+    // Depth first, so the stack never holds more than one sibling per level
+    struct Task { std::uint32_t node; std::uint32_t depth; };
+    Task tasks[kMaxDepth + 2];
+    std::uint32_t top = 0;
+    tasks[top++] = {0, 0};
+
+    while (top > 0) {
+        Task task = tasks[--top];
+
+        std::uint32_t first = nodes[task.node].leftOrFirst;
+        std::uint32_t count = nodes[task.node].count;
+        if (count <= 2 || task.depth >= kMaxDepth) continue;
+
+        // Bin primitive centroids along each axis and pick the split
+        // plane with the lowest surface area cost
+        Bounds centroids;
+        for (std::uint32_t i = first; i < first + count; ++i) {
+            centroids.grow(primitives[i].center, primitives[i].center);
+        }
+
+        int bestAxis = -1;
+        int bestSplit = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; ++axis) {
+            float lo = centroids.min[axis];
+            float extent = centroids.max[axis] - lo;
+            if (extent <= 0.0f) continue;
+
+            Bounds bins[kBinCount];
+            std::uint32_t binCounts[kBinCount] = {};
+            float scale = kBinCount / extent;
+            for (std::uint32_t i = first; i < first + count; ++i) {
+                int bin = std::min(kBinCount - 1, static_cast<int>((primitives[i].center[axis] - lo) * scale));
+                glm::vec3 r(primitives[i].radius);
+                bins[bin].grow(primitives[i].center - r, primitives[i].center + r);
+                binCounts[bin]++;
+            }
+
+            // Sweep from the right to get the cost of every split at once
+            float rightArea[kBinCount];
+            std::uint32_t rightCount[kBinCount];
+            Bounds right;
+            std::uint32_t rightSum = 0;
+            for (int b = kBinCount - 1; b > 0; --b) {
+                right.grow(bins[b].min, bins[b].max);
+                rightSum += binCounts[b];
+                rightArea[b] = right.halfArea();
+                rightCount[b] = rightSum;
+            }
+
+            Bounds left;
+            std::uint32_t leftSum = 0;
+            for (int b = 0; b < kBinCount - 1; ++b) {
+                left.grow(bins[b].min, bins[b].max);
+                leftSum += binCounts[b];
+                if (leftSum == 0 || rightCount[b + 1] == 0) continue;
+                float cost = left.halfArea() * leftSum + rightArea[b + 1] * rightCount[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b + 1;
+                }
+            }
+        }
+
+        // No usable split (coincident centroids), or splitting costs more
+        // than intersecting every primitive of a small leaf
+        float parentArea = Bounds{nodes[task.node].min, nodes[task.node].max}.halfArea();
+        float leafCost = parentArea * count;
+        if (bestAxis < 0 || (count <= kMaxLeafSize && bestCost >= leafCost)) continue;
+
+        float lo = centroids.min[bestAxis];
+        float scale = kBinCount / (centroids.max[bestAxis] - lo);
+        auto middle = std::partition(primitives.begin() + first, primitives.begin() + first + count,
+            [&](const BuildPrimitive& primitive) {
+                int bin = std::min(kBinCount - 1, static_cast<int>((primitive.center[bestAxis] - lo) * scale));
+                return bin < bestSplit;
+            });
+        std::uint32_t leftCount = static_cast<std::uint32_t>(middle - (primitives.begin() + first));
+        if (leftCount == 0 || leftCount == count) continue;
+
+        std::uint32_t leftNode = makeNode(first, leftCount);
+        makeNode(first + leftCount, count - leftCount);
+        nodes[task.node].leftOrFirst = leftNode;
+        nodes[task.node].count = 0;
+
+        tasks[top++] = {leftNode, task.depth + 1};
+        tasks[top++] = {leftNode + 1, task.depth + 1};
+    }
+
+    order.reserve(primitives.size());
+    for (const BuildPrimitive& primitive : primitives) {
+        order.push_back(primitive.id);
+    }
+}
+
+void BVH::snapshot(std::vector<BuildPrimitive>& primitives) const {
+    primitives.clear();
+    primitives.reserve(m_count);
+    for (size_t id = 0; id < m_entries.size(); ++id) {
+        const Entry& entry = m_entries[id];
+        if (entry.active) {
+            primitives.push_back({entry.center, entry.radius, static_cast<Id>(id)});
+        }
+    }
+}
+
+void BVH::install(std::vector<Node>& nodes, std::vector<Id>& order) {
+    m_nodes.swap(nodes);
+    m_order.swap(order);
+
+    // Objects inserted or removed while a background build ran are
+    // reconciled here: anything active but not in the new tree is pending
+    for (Entry& entry : m_entries) {
+        entry.inTree = false;
+    }
+    for (Id id : m_order) {
+        m_entries[id].inTree = true;
+    }
+    m_pending.clear();
+    for (size_t id = 0; id < m_entries.size(); ++id) {
+        if (m_entries[id].active && !m_entries[id].inTree) {
+            m_pending.push_back(static_cast<Id>(id));
+        }
+    }
+
+    // Positions may have changed since the snapshot was taken
+    refit();
+}
+
+void BVH::startWorker() {
+    if (!m_worker.joinable()) {
+        m_worker = std::thread(&BVH::workerLoop, this);
+    }
+}
+
+void BVH::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_workerMutex);
+    for (;;) {
+        m_workerWake.wait(lock, [this]() { return m_workerStopping || m_buildRequested; });
+        if (m_workerStopping) return;
+        m_buildRequested = false;
+
+        lock.unlock();
+        build(m_workerPrimitives, m_workerNodes, m_workerOrder);
+        lock.lock();
+
+        m_workerDone.store(true, std::memory_order_release);
+        m_workerFinished.notify_all();
+    }
+}
+
+void BVH::cancelRebuild() {
+    if (!m_rebuilding) return;
+
+    std::unique_lock<std::mutex> lock(m_workerMutex);
+    m_workerFinished.wait(lock, [this]() { return m_workerDone.load(std::memory_order_acquire); });
+    m_rebuilding = false;
+}
+
+bool BVH::overlapsSphere(const Node& node, const glm::vec3& center, float radius) {
+    glm::vec3 closest = glm::clamp(center, node.min, node.max);
+    glm::vec3 d = center - closest;
+    return glm::dot(d, d) <= radius * radius;
+}
+
+} // namespace RenderEngine
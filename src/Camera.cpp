@@ -18,7 +18,11 @@ Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch)
 }
 
 glm::mat4 Camera::getViewMatrix() const {
-    return glm::lookAt(m_position, m_position + m_front, m_up);
+    return getViewMatrix(m_position);
+}
+
+glm::mat4 Camera::getViewMatrix(const glm::vec3& eyePosition) const {
+    return glm::lookAt(eyePosition, eyePosition + m_front, m_up);
 }
 
 glm::mat4 Camera::getProjectionMatrix(float aspectRatio) const {
@@ -0,0 +1,143 @@
+#include "CollectibleStore.h"
+#include "GameObject.h"
+
+namespace RenderEngine {
+
+namespace {
+
+constexpr std::uint32_t kFreeSlot = 0xFFFFFFFFu;
+
+} // namespace
+
+CollectibleStore::CollectibleStore(size_t capacity)
+    : m_capacity(0)
+    , m_rotationSpeed(GameObject::kDefaultRotationSpeed)
+    , m_bobSpeed(GameObject::kDefaultBobSpeed)
+    , m_modelRadius(0.5f) {
+    reset(capacity);
+}
+
+void CollectibleStore::reset(size_t capacity) {
+    m_capacity = capacity;
+
+    m_positions.clear();
+    m_scales.clear();
+    m_rotations.clear();
+    m_bobOffsets.clear();
+    m_boundingRadii.clear();
+    m_collected.clear();
+    m_lodLevels.clear();
+    m_indexToSlot.clear();
+
+    m_positions.reserve(capacity);
+    m_scales.reserve(capacity);
+    m_rotations.reserve(capacity);
+    m_bobOffsets.reserve(capacity);
+    m_boundingRadii.reserve(capacity);
+    m_collected.reserve(capacity);
+    m_lodLevels.reserve(capacity);
+    m_indexToSlot.reserve(capacity);
+
+    m_slotToIndex.assign(capacity, kFreeSlot);
+    m_generations.assign(capacity, 0);
+
+    // Hand out low slots first
+    m_freeSlots.clear();
+    m_freeSlots.reserve(capacity);
+    for (size_t slot = capacity; slot > 0; --slot) {
+        m_freeSlots.push_back(static_cast<std::uint32_t>(slot - 1));
+    }
+}
+
+CollectibleStore::Handle CollectibleStore::add(const glm::vec3& position, const glm::vec3& scale,
+                                               float rotation, float bobOffset) {
+    if (m_freeSlots.empty()) {
+        return kInvalidHandle;
+    }
+
+    std::uint32_t slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+
+    m_slotToIndex[slot] = static_cast<std::uint32_t>(m_positions.size());
+    m_indexToSlot.push_back(slot);
+    m_positions.push_back(position);
+    m_scales.push_back(scale);
+    m_rotations.push_back(rotation);
+    m_bobOffsets.push_back(bobOffset);
+    m_boundingRadii.push_back(GameObject::computeBoundingRadius(scale, m_modelRadius));
+    m_collected.push_back(0);
+    m_lodLevels.push_back(0);
+
+    return Handle{ slot, m_generations[slot] };
+}
+
+bool CollectibleStore::remove(Handle handle) {
+    if (!isValid(handle)) {
+        return false;
+    }
+
+    size_t index = m_slotToIndex[handle.slot];
+    size_t last = m_positions.size() - 1;
+    if (index != last) {
+        // Swap-and-pop: move the last element into the hole
+        m_positions[index] = m_positions[last];
+        m_scales[index] = m_scales[last];
+        m_rotations[index] = m_rotations[last];
+        m_bobOffsets[index] = m_bobOffsets[last];
+        m_boundingRadii[index] = m_boundingRadii[last];
+        m_collected[index] = m_collected[last];
+        m_lodLevels[index] = m_lodLevels[last];
+        m_indexToSlot[index] = m_indexToSlot[last];
+        m_slotToIndex[m_indexToSlot[index]] = static_cast<std::uint32_t>(index);
+    }
+
+    m_positions.pop_back();
+    m_scales.pop_back();
+    m_rotations.pop_back();
+    m_bobOffsets.pop_back();
+    m_boundingRadii.pop_back();
+    m_collected.pop_back();
+    m_lodLevels.pop_back();
+    m_indexToSlot.pop_back();
+
+    // Bumping the generation invalidates every outstanding handle to the slot
+    m_slotToIndex[handle.slot] = kFreeSlot;
+    ++m_generations[handle.slot];
+    m_freeSlots.push_back(handle.slot);
+    return true;
+}
+
+bool CollectibleStore::isValid(Handle handle) const {
+    return handle.slot < m_capacity
+        && m_generations[handle.slot] == handle.generation
+        && m_slotToIndex[handle.slot] != kFreeSlot;
+}
+
+CollectibleStore::Handle CollectibleStore::getHandle(std::uint32_t slot) const {
+    if (slot >= m_capacity || m_slotToIndex[slot] == kFreeSlot) {
+        return kInvalidHandle;
+    }
+    return Handle{ slot, m_generations[slot] };
+}
+
+size_t CollectibleStore::getIndex(Handle handle) const {
+    return isValid(handle) ? m_slotToIndex[handle.slot] : kInvalidIndex;
+}
+
+void CollectibleStore::setModelRadius(float modelRadius) {
+    m_modelRadius = modelRadius;
+    for (size_t i = 0; i < m_positions.size(); ++i) {
+        m_boundingRadii[i] = GameObject::computeBoundingRadius(m_scales[i], m_modelRadius);
+    }
+}
+
+void CollectibleStore::update(float deltaTime) {
+    const size_t count = m_positions.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (m_collected[i]) continue;
+        GameObject::advanceAnimation(m_rotations[i], m_bobOffsets[i],
+                                     m_rotationSpeed, m_bobSpeed, deltaTime);
+    }
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,317 @@
+#include "CookedMesh.h"
+#include "MeshOptimizer.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace RenderEngine {
+
+namespace {
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+size_t indexSize(std::uint32_t indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? 2 : indexType == GL_UNSIGNED_INT ? 4 : 0;
+}
+
+bool fitsIn(std::uint64_t offset, std::uint64_t size, size_t limit) {
+    return offset <= limit && size <= limit - offset;
+}
+
+size_t componentSize(std::uint32_t type) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return 2;
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+// The attributes must read only inside the vertex blob, as the arena lays
+// it out, and only from per-vertex shader inputs
+bool isValidFormat(const CookedMeshEntry& mesh) {
+    if (mesh.planar > 1 || mesh.attributeCount == 0) {
+        return false;
+    }
+
+    std::uint32_t usedLocations = 0;
+    size_t planarStride = 0;
+    for (std::uint32_t i = 0; i < mesh.attributeCount; ++i) {
+        const CookedAttribute& attribute = mesh.attributes[i];
+        size_t size = componentSize(attribute.type) * attribute.components;
+        if (attribute.location >= kVertexInputLocations || (usedLocations & (1u << attribute.location)) != 0 ||
+            attribute.components < 1 || attribute.components > 4 || size == 0 || attribute.normalized > 1) {
+            return false;
+        }
+        usedLocations |= 1u << attribute.location;
+
+        if (mesh.planar) {
+            if (attribute.offset != 0) return false;
+            planarStride += size;
+        } else if (attribute.offset > mesh.stride || size > mesh.stride - attribute.offset) {
+            return false;
+        }
+    }
+    return !mesh.planar || planarStride == mesh.stride;
+}
+
+template <typename Index>
+bool indicesInRange(const char* data, std::uint64_t indexCount, std::uint64_t vertexCount) {
+    const auto* indices = reinterpret_cast<const Index*>(data);
+    for (std::uint64_t i = 0; i < indexCount; ++i) {
+        if (indices[i] >= vertexCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+CookedGeometry CookedMeshFile::cook(std::vector<Vertex> vertices, std::vector<unsigned int> indices,
+                                    VertexPacking packing, bool optimize) {
+    if (optimize) {
+        MeshOptimizer::optimize(vertices, indices);
+    }
+
+    CookedGeometry geometry;
+    geometry.packing = packing;
+    geometry.format = RenderEngine::getVertexFormat(packing);
+    geometry.vertexCount = vertices.size();
+    geometry.indexCount = indices.size();
+    geometry.positionTransform = packVertices(vertices, packing, geometry.vertices);
+
+    if (!vertices.empty()) {
+        geometry.boundsMin = geometry.boundsMax = vertices[0].position;
+        for (const Vertex& vertex : vertices) {
+            geometry.boundsMin = glm::min(geometry.boundsMin, vertex.position);
+            geometry.boundsMax = glm::max(geometry.boundsMax, vertex.position);
+        }
+    }
+
+    if (MeshOptimizer::fitsShortIndices(vertices.size())) {
+        geometry.indexType = GL_UNSIGNED_SHORT;
+        geometry.indices.resize(indices.size() * sizeof(std::uint16_t));
+        auto* out = reinterpret_cast<std::uint16_t*>(geometry.indices.data());
+        for (unsigned int index : indices) {
+            *out++ = static_cast<std::uint16_t>(index);
+        }
+    } else {
+        geometry.indexType = GL_UNSIGNED_INT;
+        geometry.indices.resize(indices.size() * sizeof(unsigned int));
+        std::memcpy(geometry.indices.data(), indices.data(), geometry.indices.size());
+    }
+    return geometry;
+}
+
+bool CookedMeshFile::write(const std::string& path, const std::vector<std::vector<CookedGeometry>>& lods,
+                           const std::vector<float>& lodThresholds, std::string& error) {
+    CookedMeshHeader header = {};
+    std::memcpy(header.magic, kCookedMeshMagic, sizeof(header.magic));
+    header.version = kCookedMeshVersion;
+    header.lodCount = static_cast<std::uint32_t>(lods.size());
+
+    std::vector<CookedLodEntry> lodTable;
+    std::vector<CookedMeshEntry> meshTable;
+    std::vector<const CookedGeometry*> blobs;
+    for (size_t lod = 0; lod < lods.size(); ++lod) {
+        CookedLodEntry entry = {};
+        entry.firstMesh = static_cast<std::uint32_t>(meshTable.size());
+        entry.meshCount = static_cast<std::uint32_t>(lods[lod].size());
+        entry.screenRadius = lod < lodThresholds.size() ? lodThresholds[lod] : 0.0f;
+        lodTable.push_back(entry);
+
+        for (const CookedGeometry& geometry : lods[lod]) {
+            if (geometry.format.attributes.size() > kCookedMaxAttributes || indexSize(geometry.indexType) == 0) {
+                error = "Unsupported vertex format or index type";
+                return false;
+            }
+
+            CookedMeshEntry mesh = {};
+            mesh.packing = static_cast<std::uint32_t>(geometry.packing);
+            mesh.stride = static_cast<std::uint32_t>(geometry.format.stride);
+            mesh.planar = geometry.format.planar ? 1 : 0;
+            mesh.attributeCount = static_cast<std::uint32_t>(geometry.format.attributes.size());
+            for (size_t i = 0; i < geometry.format.attributes.size(); ++i) {
+                const VertexAttribute& attribute = geometry.format.attributes[i];
+                mesh.attributes[i] = {attribute.location, static_cast<std::uint32_t>(attribute.components),
+                                      attribute.type, attribute.normalized ? 1u : 0u,
+                                      static_cast<std::uint32_t>(attribute.offset)};
+            }
+            mesh.indexType = geometry.indexType;
+            mesh.vertexCount = geometry.vertexCount;
+            mesh.indexCount = geometry.indexCount;
+            std::memcpy(mesh.positionTransform, glm::value_ptr(geometry.positionTransform),
+                        sizeof(mesh.positionTransform));
+            for (int axis = 0; axis < 3; ++axis) {
+                mesh.boundsMin[axis] = geometry.boundsMin[axis];
+                mesh.boundsMax[axis] = geometry.boundsMax[axis];
+            }
+            meshTable.push_back(mesh);
+            blobs.push_back(&geometry);
+        }
+    }
+    header.meshCount = static_cast<std::uint32_t>(meshTable.size());
+
+    // The model bounds enclose every mesh of the most detailed level
+    size_t baseMeshCount = lodTable.empty() ? 0 : lodTable[0].meshCount;
+    for (size_t i = 0; i < baseMeshCount; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            header.boundsMin[axis] = i == 0 ? meshTable[i].boundsMin[axis]
+                                            : std::min(header.boundsMin[axis], meshTable[i].boundsMin[axis]);
+            header.boundsMax[axis] = i == 0 ? meshTable[i].boundsMax[axis]
+                                            : std::max(header.boundsMax[axis], meshTable[i].boundsMax[axis]);
+        }
+    }
+
+    size_t offset = sizeof(CookedMeshHeader);
+    header.lodTableOffset = offset;
+    offset += lodTable.size() * sizeof(CookedLodEntry);
+    header.meshTableOffset = offset;
+    offset += meshTable.size() * sizeof(CookedMeshEntry);
+    for (size_t i = 0; i < meshTable.size(); ++i) {
+        offset = alignUp(offset, kCookedBlobAlignment);
+        meshTable[i].vertexOffset = offset;
+        offset += blobs[i]->vertices.size();
+        offset = alignUp(offset, kCookedBlobAlignment);
+        meshTable[i].indexOffset = offset;
+        offset += blobs[i]->indices.size();
+    }
+    header.fileSize = offset;
+
+    // Written beside the target and renamed over it, so an interrupted
+    // write never leaves a truncated file under the real name and readers
+    // that mapped the old file keep seeing it whole
+    const std::string temporaryPath = path + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        error = "Cannot open " + temporaryPath + " for writing";
+        return false;
+    }
+
+    static const char padding[kCookedBlobAlignment] = {};
+    auto writeBlob = [&file](const void* data, size_t size) {
+        size_t position = static_cast<size_t>(file.tellp());
+        file.write(padding, static_cast<std::streamsize>(alignUp(position, kCookedBlobAlignment) - position));
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(lodTable.data()),
+               static_cast<std::streamsize>(lodTable.size() * sizeof(CookedLodEntry)));
+    file.write(reinterpret_cast<const char*>(meshTable.data()),
+               static_cast<std::streamsize>(meshTable.size() * sizeof(CookedMeshEntry)));
+    for (const CookedGeometry* geometry : blobs) {
+        writeBlob(geometry->vertices.data(), geometry->vertices.size());
+        writeBlob(geometry->indices.data(), geometry->indices.size());
+    }
+
+    file.close();
+    std::error_code errorCode;
+    if (!file) {
+        error = "Failed writing " + temporaryPath;
+        std::filesystem::remove(temporaryPath, errorCode);
+        return false;
+    }
+    std::filesystem::rename(temporaryPath, path, errorCode);
+    if (errorCode) {
+        error = "Cannot replace " + path + ": " + errorCode.message();
+        std::filesystem::remove(temporaryPath, errorCode);
+        return false;
+    }
+    return true;
+}
+
+bool CookedMeshFile::open(const char* data, size_t size, CookedMeshView& view, std::string& error) {
+    view = CookedMeshView();
+    if (size < sizeof(CookedMeshHeader) || std::memcmp(data, kCookedMeshMagic, sizeof(kCookedMeshMagic)) != 0) {
+        error = "Not a cooked mesh file";
+        return false;
+    }
+
+    // Mapped files start page aligned, so the tables are naturally aligned
+    const auto* header = reinterpret_cast<const CookedMeshHeader*>(data);
+    if (header->version != kCookedMeshVersion) {
+        error = "Cooked mesh version " + std::to_string(header->version) + " does not match " +
+                std::to_string(kCookedMeshVersion) + "; cook the asset again";
+        return false;
+    }
+    if (header->fileSize != size) {
+        error = "File is truncated";
+        return false;
+    }
+    if (header->lodCount == 0 ||
+        !fitsIn(header->lodTableOffset, std::uint64_t(header->lodCount) * sizeof(CookedLodEntry), size) ||
+        !fitsIn(header->meshTableOffset, std::uint64_t(header->meshCount) * sizeof(CookedMeshEntry), size) ||
+        header->lodTableOffset % alignof(CookedLodEntry) != 0 ||
+        header->meshTableOffset % alignof(CookedMeshEntry) != 0) {
+        error = "Corrupt table offsets";
+        return false;
+    }
+
+    const auto* lods = reinterpret_cast<const CookedLodEntry*>(data + header->lodTableOffset);
+    const auto* meshes = reinterpret_cast<const CookedMeshEntry*>(data + header->meshTableOffset);
+    for (std::uint32_t i = 0; i < header->lodCount; ++i) {
+        if (lods[i].firstMesh > header->meshCount || lods[i].meshCount > header->meshCount - lods[i].firstMesh) {
+            error = "Corrupt LOD table";
+            return false;
+        }
+    }
+    for (std::uint32_t i = 0; i < header->meshCount; ++i) {
+        const CookedMeshEntry& mesh = meshes[i];
+        if (mesh.attributeCount > kCookedMaxAttributes || mesh.stride == 0 ||
+            mesh.packing > static_cast<std::uint32_t>(VertexPacking::Quantized) || indexSize(mesh.indexType) == 0 ||
+            mesh.vertexCount > size / mesh.stride || mesh.indexCount > size ||
+            !fitsIn(mesh.vertexOffset, mesh.vertexCount * mesh.stride, size) ||
+            !fitsIn(mesh.indexOffset, mesh.indexCount * indexSize(mesh.indexType), size) ||
+            mesh.indexOffset % indexSize(mesh.indexType) != 0) {
+            error = "Corrupt mesh entry " + std::to_string(i);
+            return false;
+        }
+        if (!isValidFormat(mesh)) {
+            error = "Corrupt vertex format in mesh entry " + std::to_string(i);
+            return false;
+        }
+        const char* indices = data + mesh.indexOffset;
+        bool inRange = mesh.indexType == GL_UNSIGNED_SHORT
+                           ? indicesInRange<std::uint16_t>(indices, mesh.indexCount, mesh.vertexCount)
+                           : indicesInRange<std::uint32_t>(indices, mesh.indexCount, mesh.vertexCount);
+        if (!inRange) {
+            error = "Index out of range in mesh entry " + std::to_string(i);
+            return false;
+        }
+    }
+
+    view.data = data;
+    view.header = header;
+    view.lods = lods;
+    view.meshes = meshes;
+    return true;
+}
+
+VertexFormat CookedMeshFile::getVertexFormat(const CookedMeshEntry& entry) {
+    VertexFormat format;
+    format.stride = entry.stride;
+    format.planar = entry.planar != 0;
+    for (std::uint32_t i = 0; i < entry.attributeCount; ++i) {
+        const CookedAttribute& attribute = entry.attributes[i];
+        format.attributes.push_back({attribute.location, static_cast<int>(attribute.components), attribute.type,
+                                     attribute.normalized != 0, attribute.offset});
+    }
+    return format;
+}
+
+} // namespace RenderEngine
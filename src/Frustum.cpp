@@ -0,0 +1,148 @@
+#include "Frustum.h"
+#include <cmath>
+
+#if defined(__AVX2__)
+    #define RENDERENGINE_FRUSTUM_AVX2
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define RENDERENGINE_FRUSTUM_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace RenderEngine {
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "Sphere centers must be tightly packed");
+
+Frustum::Frustum() {
+    for (auto& plane : m_planes) {
+        plane = glm::vec4(0.0f);
+    }
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+    update(viewProjection);
+}
+
+void Frustum::update(const glm::mat4& viewProjection) {
+    // glm is column-major: row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    const glm::mat4& m = viewProjection;
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    m_planes[0] = row3 + row0;  // left
+    m_planes[1] = row3 - row0;  // right
+    m_planes[2] = row3 + row1;  // bottom
+    m_planes[3] = row3 - row1;  // top
+    m_planes[4] = row3 + row2;  // near
+    m_planes[5] = row3 - row2;  // far
+
+    for (auto& plane : m_planes) {
+        float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        if (length > 0.0f) {
+            plane = plane * (1.0f / length);
+        }
+    }
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const {
+    for (const auto& plane : m_planes) {
+        if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t Frustum::cullSpheres(const glm::vec3* centers, const float* radii, size_t count,
+                            float margin, uint32_t* visible) const {
+    size_t visibleCount = 0;
+    size_t i = 0;
+
+#if defined(RENDERENGINE_FRUSTUM_AVX2)
+    const float* base = &centers[0].x;
+    const __m256i offsets = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    const __m256 marginVec = _mm256_set1_ps(margin);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    for (; i + 8 <= count; i += 8) {
+        const float* group = base + 3 * i;
+        __m256 x = _mm256_i32gather_ps(group + 0, offsets, 4);
+        __m256 y = _mm256_i32gather_ps(group + 1, offsets, 4);
+        __m256 z = _mm256_i32gather_ps(group + 2, offsets, 4);
+        __m256 negRadius = _mm256_xor_ps(_mm256_add_ps(_mm256_loadu_ps(radii + i), marginVec), signMask);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const auto& plane : m_planes) {
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.x)),
+                              _mm256_mul_ps(y, _mm256_set1_ps(plane.y))),
+                _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(plane.z)),
+                              _mm256_set1_ps(plane.w)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+
+        int mask = _mm256_movemask_ps(inside);
+        for (uint32_t lane = 0; lane < 8; ++lane) {
+            if (mask & (1 << lane)) {
+                visible[visibleCount++] = static_cast<uint32_t>(i) + lane;
+            }
+        }
+    }
+#elif defined(RENDERENGINE_FRUSTUM_SSE2)
+    const __m128 marginVec = _mm_set1_ps(margin);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    for (; i + 4 <= count; i += 4) {
+        const glm::vec3* group = centers + i;
+        __m128 x = _mm_setr_ps(group[0].x, group[1].x, group[2].x, group[3].x);
+        __m128 y = _mm_setr_ps(group[0].y, group[1].y, group[2].y, group[3].y);
+        __m128 z = _mm_setr_ps(group[0].z, group[1].z, group[2].z, group[3].z);
+        __m128 negRadius = _mm_xor_ps(_mm_add_ps(_mm_loadu_ps(radii + i), marginVec), signMask);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const auto& plane : m_planes) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)),
+                           _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+                _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)),
+                           _mm_set1_ps(plane.w)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            if (mask & (1 << lane)) {
+                visible[visibleCount++] = static_cast<uint32_t>(i) + lane;
+            }
+        }
+    }
+#endif
+
+    visibleCount += cullScalar(centers, radii, i, count, margin, visible + visibleCount);
+    return visibleCount;
+}
+
+size_t Frustum::cullScalar(const glm::vec3* centers, const float* radii, size_t begin, size_t end,
+                           float margin, uint32_t* visible) const {
+    size_t visibleCount = 0;
+    for (size_t i = begin; i < end; ++i) {
+        if (intersectsSphere(centers[i], radii[i] + margin)) {
+            visible[visibleCount++] = static_cast<uint32_t>(i);
+        }
+    }
+    return visibleCount;
+}
+
+const char* Frustum::getSimdPath() {
+#if defined(RENDERENGINE_FRUSTUM_AVX2)
+    return "AVX2";
+#elif defined(RENDERENGINE_FRUSTUM_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace RenderEngine
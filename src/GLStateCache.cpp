@@ -0,0 +1,129 @@
+#include "GLStateCache.h"
+
+namespace RenderEngine {
+
+namespace {
+
+GLStateCache* s_current = nullptr;
+
+GLStateCache& fallbackCache() {
+    static GLStateCache cache;
+    return cache;
+}
+
+} // namespace
+
+GLStateCache::GLStateCache() {
+    invalidate();
+}
+
+GLStateCache::~GLStateCache() {
+    if (s_current == this) {
+        s_current = nullptr;
+    }
+}
+
+GLStateCache& GLStateCache::current() {
+    return s_current ? *s_current : fallbackCache();
+}
+
+void GLStateCache::makeCurrent() {
+    // Whatever the previous cache did is invisible to this one
+    invalidate();
+    s_current = this;
+}
+
+void GLStateCache::useProgram(unsigned int program) {
+    if (elide(m_program == program)) return;
+    glUseProgram(program);
+    m_program = program;
+}
+
+void GLStateCache::bindVertexArray(unsigned int vao) {
+    if (elide(m_vertexArray == vao)) return;
+    glBindVertexArray(vao);
+    m_vertexArray = vao;
+    m_elementBuffer = kUnknown;
+}
+
+void GLStateCache::bindBuffer(GLenum target, unsigned int buffer) {
+    unsigned int* binding = nullptr;
+    if (target == GL_ARRAY_BUFFER) {
+        binding = &m_arrayBuffer;
+    } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        binding = &m_elementBuffer;
+    }
+
+    if (binding && elide(*binding == buffer)) return;
+    glBindBuffer(target, buffer);
+    if (binding) {
+        *binding = buffer;
+    }
+}
+
+void GLStateCache::setDepthTest(bool enable) {
+    setCapability(GL_DEPTH_TEST, m_depthTest, enable);
+}
+
+void GLStateCache::setBlending(bool enable) {
+    setCapability(GL_BLEND, m_blending, enable);
+}
+
+void GLStateCache::setClearColor(const glm::vec4& color) {
+    if (elide(m_clearColorKnown && m_clearColor == color)) return;
+    glClearColor(color.x, color.y, color.z, color.w);
+    m_clearColor = color;
+    m_clearColorKnown = true;
+}
+
+void GLStateCache::forgetProgram(unsigned int program) {
+    // Deleting the bound program only flags it; a new program with the
+    // same name must still be bound explicitly
+    if (m_program == program) m_program = kUnknown;
+}
+
+void GLStateCache::forgetVertexArray(unsigned int vao) {
+    // Deleting the bound vertex array reverts the binding to zero
+    if (m_vertexArray == vao) {
+        m_vertexArray = 0;
+        m_elementBuffer = kUnknown;
+    }
+}
+
+void GLStateCache::forgetBuffer(unsigned int buffer) {
+    if (m_arrayBuffer == buffer) m_arrayBuffer = 0;
+    if (m_elementBuffer == buffer) m_elementBuffer = 0;
+}
+
+void GLStateCache::invalidate() {
+    m_program = kUnknown;
+    m_vertexArray = kUnknown;
+    m_arrayBuffer = kUnknown;
+    m_elementBuffer = kUnknown;
+    m_depthTest = Toggle::Unknown;
+    m_blending = Toggle::Unknown;
+    m_clearColor = glm::vec4(0.0f);
+    m_clearColorKnown = false;
+}
+
+void GLStateCache::setCapability(GLenum capability, Toggle& state, bool enable) {
+    Toggle wanted = enable ? Toggle::On : Toggle::Off;
+    if (elide(state == wanted)) return;
+    if (enable) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+    state = wanted;
+}
+
+bool GLStateCache::elide(bool redundant) {
+    if (redundant) {
+        m_stats.elided++;
+    } else {
+        m_stats.issued++;
+    }
+    return redundant;
+}
+
+} // namespace RenderEngine
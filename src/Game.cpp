@@ -1,88 +1,93 @@
 #include "Game.h"
 #include "Model.h"
+#include "Mesh.h"
 #include "Renderer.h"
+#include "FrameUniforms.h"
+#include "AllocationCounter.h"
+#include "Profiler.h"
+#include "Tracer.h"
 #include <iostream>
+#include <string>
 #include <algorithm>
+#include <cstddef>
+#include <cmath>
+#include <chrono>
+#include <cctype>
+#include <filesystem>
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace RenderEngine {
 
-Game::Game()
-    : m_score(0)
-    , m_collectiblesCollected(0)
-    , m_gameTime(0.0f)
-    , m_running(false)
-    , m_worldSize(20.0f)
-    , m_maxCollectibles(15)
-    , m_firstMouse(true)
-    , m_lastMouseX(0.0)
-    , m_lastMouseY(0.0)
-    , m_rng(std::random_device{}())
-    , m_posDistribution(-m_worldSize * 0.4f, m_worldSize * 0.4f)
-    , m_rotationDistribution(0.0f, 360.0f) {
-}
+namespace {
 
-Game::~Game() {
-    shutdown();
-}
+// Collectible scales are drawn from [kMinCollectibleScale, kMinCollectibleScale + 0.1)
+constexpr float kMinCollectibleScale = 0.3f;
+// Largest radius of the built-in sphere; the grid is sized for it, and
+// stays exact for larger loaded models since its queries grow by the
+// largest radius inserted
+constexpr float kMaxCollectibleRadius = 0.5f * (kMinCollectibleScale + 0.1f);
 
-bool Game::initialize() {
-    // Create window
-    m_window = std::make_unique<Window>(1280, 720, "Render Engine - 3D Game");
-    if (!m_window->getHandle()) {
-        std::cerr << "Failed to create window" << std::endl;
-        return false;
-    }
-
-    // Create camera
-    m_camera = std::make_unique<Camera>(glm::vec3(0.0f, 2.0f, 5.0f));
-    m_camera->setSpeed(8.0f);
-    m_camera->setSensitivity(0.15f);
+// Collectible sphere LODs use 32, 16, 8 and 4 segments
+constexpr int kCollectibleLodLevels = 4;
+const char* const kLodCounterNames[kCollectibleLodLevels] = { "lod0", "lod1", "lod2", "lod3" };
 
-    // Create renderer
-    m_renderer = std::make_unique<Renderer>();
+// BVH pending objects tolerated before a background rebuild is requested
+constexpr size_t kBvhMinPending = 16;
 
-    // Create models
-    m_groundModel = Model::createPlane(m_worldSize);
-    m_collectibleModel = Model::createSphere(16);
+constexpr uint32_t kShininessUniform = hashUniformName("shininess");
 
-    // Create shaders
-    const std::string vertexSource = R"(
-#version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
+// Shader bodies; buildShader() prepends the version, the frame uniforms
+// and the vertex inputs of the packing the drawn model was stored with
+const char* const kGroundVertexGLSL = R"(
+layout (location = 5) in mat4 aModel;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+void main() {
+    FragPos = vec3(aModel * vec4(vertexPosition(), 1.0));
+    Normal = mat3(transpose(inverse(aModel))) * vertexNormal();
+    TexCoord = vertexTexCoords();
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+// Collectibles are drawn instanced: the model matrix is rebuilt from
+// per-instance attributes instead of a per-object uniform
+const char* const kCollectibleVertexGLSL = R"(
+layout (location = 3) in vec4 aPositionRotation;
+layout (location = 4) in vec4 aScaleBobPhase;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
 
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    TexCoord = aTexCoord;
+    float angle = radians(aPositionRotation.w);
+    float c = cos(angle);
+    float s = sin(angle);
+    mat3 rotation = mat3(c, 0.0, -s,
+                         0.0, 1.0, 0.0,
+                         s, 0.0, c);
+
+    vec3 translation = aPositionRotation.xyz + vec3(0.0, sin(aScaleBobPhase.w) * BOB_AMPLITUDE, 0.0);
+    FragPos = rotation * (vertexPosition() * aScaleBobPhase.xyz) + translation;
+    Normal = rotation * (vertexNormal() / aScaleBobPhase.xyz);
+    TexCoord = vertexTexCoords();
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
 )";
 
-    const std::string groundFragmentSource = R"(
-#version 330 core
+const char* const kGroundFragmentGLSL = R"(
 out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
 
-uniform vec3 viewPos;
 uniform vec3 objectColor;
-uniform vec3 lightPos;
-uniform vec3 lightColor;
 uniform float shininess;
-uniform float time;
 
 void main() {
     float ambientStrength = 0.4;
@@ -109,20 +114,15 @@ void main() {
 }
 )";
 
-    const std::string collectibleFragmentSource = R"(
-#version 330 core
+const char* const kCollectibleFragmentGLSL = R"(
 out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
 
-uniform vec3 viewPos;
 uniform vec3 objectColor;
-uniform vec3 lightPos;
-uniform vec3 lightColor;
 uniform float shininess;
-uniform float time;
 
 void main() {
     float ambientStrength = 0.5;
@@ -143,28 +143,172 @@ void main() {
     vec3 glowColor = vec3(0.8 + sin(time * 3.0 + FragPos.x * 10.0) * 0.2,
                           0.9 + cos(time * 2.5 + FragPos.z * 10.0) * 0.1,
                           1.0);
-    
+
     vec3 result = (ambient + diffuse * 1.5 + specular * 2.0) * glowColor;
     FragColor = vec4(result, 1.0);
 }
 )";
 
-    m_groundShader = std::make_shared<Shader>();
-    if (!m_groundShader->loadFromSource(vertexSource, groundFragmentSource)) {
-        std::cerr << "Failed to create ground shader" << std::endl;
+// Vertex shaders read their inputs through getVertexInputGLSL(), so each
+// packing needs its own variant; returns nullptr if compiling fails
+std::shared_ptr<Shader> buildShader(VertexPacking packing, const std::string& vertexDefines,
+                                    const char* vertexBody, const char* fragmentBody) {
+    const std::string version = "#version 330 core\n";
+    auto shader = std::make_shared<Shader>();
+    if (!shader->loadFromSource(version + vertexDefines + kFrameUniformsGLSL + getVertexInputGLSL(packing) + vertexBody,
+                                version + kFrameUniformsGLSL + fragmentBody)) {
+        return nullptr;
+    }
+    return shader;
+}
+
+// Packing whose shader inputs every mesh of the model can be drawn with;
+// fails if the meshes need different inputs
+bool getShaderPacking(const Model& model, VertexPacking& packing) {
+    bool found = false;
+    for (size_t lod = 0; lod < model.getLodCount(); ++lod) {
+        for (const auto& mesh : model.getMeshes(lod)) {
+            if (!found) {
+                packing = mesh->getPacking();
+                found = true;
+            } else if (getVertexInputGLSL(mesh->getPacking()) != getVertexInputGLSL(packing)) {
+                return false;
+            }
+        }
+    }
+    return found;
+}
+
+// Picks the AsyncLoader request by file extension; OBJ files are packed
+// like the built-in shapes
+LoadHandle<Model> requestModel(AsyncLoader& loader, const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".glb") {
+        return loader.loadGLB(path);
+    }
+    if (extension == ".rmesh") {
+        return loader.loadCooked(path);
+    }
+    return loader.loadOBJ(path, Mesh::kDefaultPacking);
+}
+
+} // namespace
+
+void packCollectibleInstances(CollectibleStore& store, const std::uint32_t* visible, size_t visibleCount,
+                              const Model& model, const glm::vec3& eyePosition, float pixelScale,
+                              float renderLag, std::vector<std::vector<CollectibleInstance>>& instances) {
+    for (auto& level : instances) {
+        level.clear();
+    }
+
+    const auto& positions = store.getPositions();
+    const auto& scales = store.getScales();
+    const auto& rotations = store.getRotations();
+    const auto& bobOffsets = store.getBobOffsets();
+    const auto& radii = store.getBoundingRadii();
+    for (size_t v = 0; v < visibleCount; ++v) {
+        std::uint32_t i = visible[v];
+        if (store.isCollected(i)) continue;
+
+        float distance = std::max(glm::length(positions[i] - eyePosition), 0.001f);
+        size_t lod = model.selectLod(radii[i] * pixelScale / distance, store.getLodLevel(i));
+        store.setLodLevel(i, static_cast<std::uint8_t>(lod));
+
+        instances[lod].push_back({
+            glm::vec4(positions[i], rotations[i] - GameObject::kDefaultRotationSpeed * renderLag),
+            glm::vec4(scales[i], bobOffsets[i] - GameObject::kDefaultBobSpeed * renderLag)
+        });
+    }
+}
+
+Game::Game(const GameSettings& settings)
+    : m_settings(settings)
+    , m_score(0)
+    , m_collectiblesCollected(0)
+    , m_gameTime(0.0f)
+    , m_running(false)
+    , m_initialized(false)
+    , m_updateAllocations(0)
+    , m_worldSize(settings.worldSize)
+    , m_maxCollectibles(settings.maxCollectibles)
+    , m_collisionRadius(0.8f)
+    // Cells span the largest collectible plus the camera's collision sphere,
+    // so a camera query only touches the neighbouring cells
+    , m_collectibleGrid(2.0f * (kMaxCollectibleRadius + m_collisionRadius),
+                        std::max<size_t>(4096, static_cast<size_t>(settings.maxCollectibles)))
+    , m_tickAccumulator(0.0f)
+    , m_interpolationAlpha(1.0f)
+    , m_previousCameraPosition(0.0f)
+    , m_statsFrames(0)
+    , m_statsTicks(0)
+    , m_statsMaxTicks(0)
+    , m_frameNumber(0)
+    , m_statsVisible(0)
+    , m_statsCulled(0)
+    , m_firstMouse(true)
+    , m_lastMouseX(0.0)
+    , m_lastMouseY(0.0)
+    , m_rng(settings.seed != 0 ? settings.seed : std::random_device{}())
+    , m_posDistribution(-m_worldSize * 0.4f, m_worldSize * 0.4f)
+    , m_rotationDistribution(0.0f, 360.0f) {
+}
+
+Game::~Game() {
+    shutdown();
+}
+
+bool Game::initialize() {
+    if (!m_settings.tracePath.empty() && !Tracer::start(m_settings.tracePath)) {
         return false;
     }
 
-    m_collectibleShader = std::make_shared<Shader>();
-    if (!m_collectibleShader->loadFromSource(vertexSource, collectibleFragmentSource)) {
-        std::cerr << "Failed to create collectible shader" << std::endl;
+    if (!m_settings.headless) {
+        // Create window
+        m_window = std::make_unique<Window>(1280, 720, "Render Engine - 3D Game");
+        if (!m_window->getHandle()) {
+            std::cerr << "Failed to create window" << std::endl;
+            return false;
+        }
+    }
+
+    // Create camera
+    const float mouseSensitivity = 0.15f;
+    m_camera = std::make_unique<Camera>(glm::vec3(0.0f, 2.0f, 5.0f));
+    m_camera->setSpeed(8.0f);
+    m_camera->setSensitivity(mouseSensitivity);
+    m_previousCameraPosition = m_camera->getPosition();
+
+    if (m_settings.headless) {
+        std::uint32_t inputSeed = m_settings.seed != 0 ? m_settings.seed : std::random_device{}();
+        m_syntheticInput = std::make_unique<SyntheticInput>(inputSeed, m_worldSize * 0.4f, mouseSensitivity);
+    } else if (!initializeGraphics()) {
         return false;
     }
 
+    // Size the pool and the collision scratch list up front so the game
+    // loop never allocates
+    m_collectibles.reset(m_maxCollectibles);
+    m_collectedHandles.reserve(m_maxCollectibles);
+    m_visibleCollectibles.resize(m_maxCollectibles);
+    if (m_settings.useBvh) {
+        m_collectibleBvh.reserve(m_maxCollectibles);
+    }
+
     // Spawn initial collectibles
     for (int i = 0; i < m_maxCollectibles; ++i) {
         spawnCollectible();
     }
+    if (m_settings.useBvh) {
+        m_collectibleBvh.rebuild();
+    }
+
+    if (m_settings.headless) {
+        m_running = true;
+        m_initialized = true;
+        return true;
+    }
 
     // Lock cursor
     m_window->setCursorMode(GLFW_CURSOR_DISABLED);
@@ -178,12 +322,145 @@ void main() {
     std::cout << "==============================\n" << std::endl;
 
     m_running = true;
+    m_initialized = true;
+    return true;
+}
+
+bool Game::initializeGraphics() {
+    // Create renderer and the loader streaming models in over later frames
+    m_renderer = std::make_unique<Renderer>();
+    m_assetLoader = std::make_unique<AsyncLoader>();
+
+    // The built-in shapes are drawn until requested model files have
+    // loaded, and stay if they cannot be loaded or used
+    if (!useGroundModel(Model::createPlane(m_worldSize)) ||
+        !useCollectibleModel(Model::createSphere(32, kCollectibleLodLevels))) {
+        return false;
+    }
+
+    std::cout << "Collectible vertex cache ACMR/ATVR:";
+    for (size_t lod = 0; lod < m_collectibleModel->getLodCount(); ++lod) {
+        for (const auto& mesh : m_collectibleModel->getMeshes(lod)) {
+            const MeshOptimizationReport& report = mesh->getOptimizationReport();
+            std::cout << " lod" << lod << " " << report.before.acmr << "/" << report.before.atvr
+                      << " -> " << report.after.acmr << "/" << report.after.atvr;
+        }
+    }
+    std::cout << std::endl;
+
+    if (!m_settings.groundModelPath.empty()) {
+        m_groundModelLoad = requestModel(*m_assetLoader, m_settings.groundModelPath);
+    }
+    if (!m_settings.collectibleModelPath.empty()) {
+        m_collectibleModelLoad = requestModel(*m_assetLoader, m_settings.collectibleModelPath);
+    }
+
     return true;
 }
 
+bool Game::useGroundModel(std::shared_ptr<Model> model) {
+    VertexPacking packing = Mesh::kDefaultPacking;
+    if (!model || !getShaderPacking(*model, packing)) {
+        std::cerr << "Ground model is empty or mixes vertex layouts" << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<Shader> shader = buildShader(packing, std::string(), kGroundVertexGLSL, kGroundFragmentGLSL);
+    if (!shader) {
+        std::cerr << "Failed to create ground shader" << std::endl;
+        return false;
+    }
+
+    m_groundModel = std::move(model);
+    m_groundShader = std::move(shader);
+    return true;
+}
+
+bool Game::useCollectibleModel(std::shared_ptr<Model> model) {
+    VertexPacking packing = Mesh::kDefaultPacking;
+    if (!model || !getShaderPacking(*model, packing)) {
+        std::cerr << "Collectible model is empty or mixes vertex layouts" << std::endl;
+        return false;
+    }
+    // The instanced shader builds the model matrix itself and has no room
+    // for a per-mesh dequantizing transform
+    if (packing == VertexPacking::Quantized) {
+        std::cerr << "Collectible models cannot use quantized positions" << std::endl;
+        return false;
+    }
+
+    // The bob amplitude is injected so culling and the shader cannot disagree
+    std::string defines = "#define BOB_AMPLITUDE " + std::to_string(GameObject::kBobAmplitude) + "\n";
+    std::shared_ptr<Shader> shader = buildShader(packing, defines, kCollectibleVertexGLSL, kCollectibleFragmentGLSL);
+    if (!shader) {
+        std::cerr << "Failed to create collectible shader" << std::endl;
+        return false;
+    }
+
+    m_collectibleModel = std::move(model);
+    m_collectibleShader = std::move(shader);
+    m_collectibleShininessUniform = m_collectibleShader->getUniform<float>(kShininessUniform);
+
+    // Culling, collision and level selection scale the model's own bounds,
+    // so the radius of every live collectible and its index entry change
+    m_collectibles.setModelRadius(m_collectibleModel->getBoundingRadius());
+    for (std::uint32_t slot = 0; slot < m_collectibles.capacity(); ++slot) {
+        size_t index = m_collectibles.getIndex(m_collectibles.getHandle(slot));
+        if (index == CollectibleStore::kInvalidIndex) continue;
+
+        const glm::vec3& position = m_collectibles.getPositions()[index];
+        float radius = m_collectibles.getBoundingRadii()[index];
+        if (m_settings.useBvh) {
+            m_collectibleBvh.update(slot, position, radius);
+        } else {
+            m_collectibleGrid.update(slot, position, radius);
+        }
+    }
+    if (m_settings.useBvh && !m_collectibles.empty()) {
+        m_collectibleBvh.rebuild();
+    }
+
+    // One instance stream per level of detail, each drawn with one call
+    size_t lodCount = m_collectibleModel->getLodCount();
+    m_collectibleInstanceBuffers.clear();
+    m_collectibleInstances.assign(lodCount, std::vector<CollectibleInstance>());
+    m_statsLodCounts.assign(lodCount, 0);
+    for (size_t lod = 0; lod < lodCount; ++lod) {
+        m_collectibleInstanceBuffers.push_back(std::make_unique<InstanceBuffer>(
+            sizeof(CollectibleInstance),
+            std::vector<InstanceAttribute>{
+                {3, 4, offsetof(CollectibleInstance, positionRotation)},
+                {4, 4, offsetof(CollectibleInstance, scaleBobPhase)}
+            }));
+        m_collectibleInstances[lod].reserve(m_maxCollectibles);
+    }
+    return true;
+}
+
+void Game::adoptLoadedModels() {
+    if (m_groundModelLoad.isValid() && m_groundModelLoad.getState() != LoadState::Pending) {
+        if (!m_groundModelLoad.isReady() || !useGroundModel(m_groundModelLoad.get())) {
+            std::cerr << "Keeping the built-in ground instead of " << m_settings.groundModelPath << std::endl;
+        }
+        m_groundModelLoad = LoadHandle<Model>();
+    }
+    if (m_collectibleModelLoad.isValid() && m_collectibleModelLoad.getState() != LoadState::Pending) {
+        if (!m_collectibleModelLoad.isReady() || !useCollectibleModel(m_collectibleModelLoad.get())) {
+            std::cerr << "Keeping the built-in collectible instead of " << m_settings.collectibleModelPath
+                      << std::endl;
+        }
+        m_collectibleModelLoad = LoadHandle<Model>();
+    }
+}
+
 void Game::run() {
     if (!m_running) return;
 
+    if (m_settings.headless) {
+        runHeadless();
+        return;
+    }
+
     double lastTime = glfwGetTime();
     double lastFrameTime = lastTime;
 
@@ -192,98 +469,277 @@ void Game::run() {
         float deltaTime = static_cast<float>(currentTime - lastFrameTime);
         lastFrameTime = currentTime;
 
-        // Cap delta time to prevent large jumps
-        deltaTime = std::min(deltaTime, 0.1f);
+        if (m_settings.fixedTimestep) {
+            stepFixed(deltaTime);
+        } else {
+            // Cap delta time to prevent large jumps
+            deltaTime = std::min(deltaTime, 0.1f);
+
+            processMouseInput();
+            processInput(deltaTime);
+            update(deltaTime);
+
+            m_statsTicks++;
+            m_statsMaxTicks = std::max(m_statsMaxTicks, 1);
+        }
+        m_statsFrames++;
+
+        // Uploads finished loads within the per-frame budget and swaps in
+        // the models that completed
+        m_assetLoader->update();
+        adoptLoadedModels();
 
-        processInput(deltaTime);
-        update(deltaTime);
         render();
 
         m_window->swapBuffers();
         m_window->pollEvents();
+
+        PROFILE_FRAME();
+        Tracer::counter("collectiblesAlive", static_cast<double>(m_collectibles.size()));
+        Tracer::frame(m_frameNumber++);
+    }
+}
+
+void Game::stepFixed(float frameTime) {
+    const float tickDelta = 1.0f / m_settings.tickRate;
+
+    // Look direction follows the mouse every frame; only movement is ticked
+    processMouseInput();
+
+    m_tickAccumulator += frameTime;
+
+    // Spiral-of-death guard: if the simulation falls too far behind, drop
+    // the backlog instead of running ever more ticks per frame
+    float maxBacklog = tickDelta * static_cast<float>(m_settings.maxTicksPerFrame);
+    if (m_tickAccumulator > maxBacklog) {
+        m_tickAccumulator = maxBacklog;
+    }
+
+    int ticks = 0;
+    while (m_tickAccumulator >= tickDelta) {
+        m_previousCameraPosition = m_camera->getPosition();
+        processInput(tickDelta);
+        update(tickDelta);
+        m_tickAccumulator -= tickDelta;
+        ticks++;
+    }
+
+    m_interpolationAlpha = m_tickAccumulator / tickDelta;
+    m_statsTicks += ticks;
+    m_statsMaxTicks = std::max(m_statsMaxTicks, ticks);
+}
+
+void Game::runHeadless() {
+    using Clock = std::chrono::steady_clock;
+
+    const float tickDelta = 1.0f / m_settings.tickRate;
+    long maxFrames = m_settings.headlessFrames;
+    if (maxFrames <= 0 && m_settings.headlessDuration <= 0.0f) {
+        maxFrames = 10000;
+    }
+
+    std::cout << "Headless run: " << m_maxCollectibles << " collectibles, world size "
+              << m_worldSize << ", " << m_settings.tickRate << " Hz ticks" << std::endl;
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(m_settings.headlessDuration));
+    long frames = 0;
+
+    while (m_running) {
+        if (maxFrames > 0 ? frames >= maxFrames : Clock::now() >= deadline) {
+            break;
+        }
+
+        Clock::time_point inputStart = Clock::now();
+        {
+            PROFILE_SCOPE("processInput");
+            InputFrame input = m_syntheticInput->next(tickDelta, m_camera->getPosition(), m_camera->getFront());
+            m_camera->processMouseMovement(input.mouseOffsetX, input.mouseOffsetY);
+            m_camera->processKeyboard(input.direction, tickDelta);
+        }
+        Clock::time_point updateStart = Clock::now();
+        update(tickDelta);
+        Clock::time_point updateEnd = Clock::now();
+
+        m_phaseTimings.input += std::chrono::duration<double>(updateStart - inputStart).count();
+        m_phaseTimings.update += std::chrono::duration<double>(updateEnd - updateStart).count();
+        frames++;
+
+        PROFILE_FRAME();
+        Tracer::counter("collectiblesAlive", static_cast<double>(m_collectibles.size()));
+        Tracer::frame(m_frameNumber++);
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    double ticks = static_cast<double>(std::max(frames, 1L));
+    auto perTick = [ticks](double seconds) { return seconds * 1e6 / ticks; };
+
+    std::cout << "\n=== Headless Results ===" << std::endl;
+    std::cout << "Ticks: " << frames << " in " << elapsed << " s ("
+              << (elapsed > 0.0 ? frames / elapsed : 0.0) << " ticks/s)" << std::endl;
+    std::cout << "Simulated time: " << m_gameTime << " s | Score: " << m_score
+              << " | Collected: " << m_collectiblesCollected << std::endl;
+    std::cout << "Per-tick (us): input " << perTick(m_phaseTimings.input)
+              << " | update " << perTick(m_phaseTimings.update)
+              << " (checkCollisions " << perTick(m_phaseTimings.collisions)
+              << ", respawn " << perTick(m_phaseTimings.respawn) << ")" << std::endl;
+    if (AllocationCounter::isEnabled()) {
+        std::cout << "Update allocations: " << m_updateAllocations << std::endl;
     }
 }
 
 void Game::shutdown() {
+    if (m_initialized) {
+        PROFILE_REPORT(std::cout);
+        m_initialized = false;
+    }
+    // The capture starts before anything that can fail in initialize(), so
+    // it is stopped even if initialization did not finish; stop() does
+    // nothing when no capture is running
+    Tracer::stop();
     m_running = false;
 }
 
 void Game::update(float deltaTime) {
+    PROFILE_SCOPE("update");
+
+    std::uint64_t allocationsBefore = AllocationCounter::getThreadCount();
+
     m_gameTime += deltaTime;
 
     // Update collectibles
-    for (auto& collectible : m_collectibles) {
-        collectible->update(deltaTime);
-    }
+    m_collectibles.update(deltaTime);
 
     // Check collisions
+    auto collisionStart = std::chrono::steady_clock::now();
     checkCollisions();
+    auto respawnStart = std::chrono::steady_clock::now();
 
-    // Respawn collected items
-    auto it = std::remove_if(m_collectibles.begin(), m_collectibles.end(),
-        [this](const std::shared_ptr<GameObject>& obj) {
-            if (obj->isCollected()) {
-                spawnCollectible();
-                return true;
-            }
-            return false;
-        });
-    m_collectibles.erase(it, m_collectibles.end());
+    // Return collected items to the pool; respawning reuses their slots
+    for (CollectibleStore::Handle handle : m_collectedHandles) {
+        m_collectibles.remove(handle);
+        spawnCollectible();
+    }
+    m_collectedHandles.clear();
+
+    if (m_settings.useBvh) {
+        // Respawns wait in the pending list until a background rebuild
+        // folds them into the tree
+        m_collectibleBvh.pollRebuild();
+        if (m_collectibleBvh.getPendingCount() > std::max<size_t>(kBvhMinPending, m_collectibleBvh.size() / 8)) {
+            m_collectibleBvh.requestRebuild();
+        }
+    }
+
+    auto respawnEnd = std::chrono::steady_clock::now();
+    m_phaseTimings.collisions += std::chrono::duration<double>(respawnStart - collisionStart).count();
+    m_phaseTimings.respawn += std::chrono::duration<double>(respawnEnd - respawnStart).count();
+
+    m_updateAllocations += AllocationCounter::getThreadCount() - allocationsBefore;
 }
 
 void Game::render() {
+    PROFILE_SCOPE("render");
+
+    m_renderer->beginFrame();
     m_window->clear(0.1f, 0.1f, 0.15f, 1.0f);
 
+    // In fixed-tick mode the latest state is up to one tick ahead of the
+    // wall clock; render the camera blended between the last two ticks and
+    // rewind the constant-speed collectible animation by the remaining lag
+    glm::vec3 eyePosition = m_camera->getPosition();
+    float renderLag = 0.0f;
+    if (m_settings.fixedTimestep) {
+        eyePosition = glm::mix(m_previousCameraPosition, eyePosition, m_interpolationAlpha);
+        renderLag = (1.0f - m_interpolationAlpha) / m_settings.tickRate;
+    }
+    float renderTime = m_gameTime - renderLag;
+
     float aspectRatio = static_cast<float>(m_window->getWidth()) / static_cast<float>(m_window->getHeight());
-    glm::mat4 view = m_camera->getViewMatrix();
+
+    glm::mat4 view = m_camera->getViewMatrix(eyePosition);
     glm::mat4 projection = m_camera->getProjectionMatrix(aspectRatio);
+    m_frustum.update(projection * view);
 
+    // Camera, light and time reach every shader through one uniform block
     m_renderer->setViewMatrix(view);
     m_renderer->setProjectionMatrix(projection);
-    m_renderer->setViewPosition(m_camera->getPosition());
+    m_renderer->setViewPosition(eyePosition);
+    m_renderer->setTime(renderTime);
+    m_renderer->updateFrameUniforms();
 
     // Render ground
+    m_renderer->beginPass("gpu/ground");
     glm::mat4 groundModel = glm::mat4(1.0f);
     groundModel = glm::translate(groundModel, glm::vec3(0.0f, -0.5f, 0.0f));
     
-    m_groundShader->use();
-    m_groundShader->setMat4("model", groundModel);
-    m_groundShader->setMat4("view", view);
-    m_groundShader->setMat4("projection", projection);
-    m_groundShader->setVec3("viewPos", m_camera->getPosition());
-    m_groundShader->setVec3("lightPos", glm::vec3(5.0f, 10.0f, 5.0f));
-    m_groundShader->setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
-    m_groundShader->setFloat("shininess", 32.0f);
-    m_groundShader->setFloat("time", m_gameTime);
-    m_groundModel->draw();
-
-    // Render collectibles
-    for (const auto& collectible : m_collectibles) {
-        if (collectible->isCollected()) continue;
-
-        glm::mat4 model = glm::mat4(1.0f);
-        glm::vec3 pos = collectible->getPosition();
-        float bob = std::sin(m_gameTime * 2.0f + pos.x * 5.0f + pos.z * 5.0f) * 0.1f;
-        model = glm::translate(model, pos + glm::vec3(0.0f, bob, 0.0f));
-        model = glm::rotate(model, glm::radians(collectible->getRotation()), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::scale(model, collectible->getScale());
-
-        m_collectibleShader->use();
-        m_collectibleShader->setMat4("model", model);
-        m_collectibleShader->setMat4("view", view);
-        m_collectibleShader->setMat4("projection", projection);
-        m_collectibleShader->setVec3("viewPos", m_camera->getPosition());
-        m_collectibleShader->setVec3("lightPos", glm::vec3(5.0f, 10.0f, 5.0f));
-        m_collectibleShader->setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        m_collectibleShader->setFloat("shininess", 64.0f);
-        m_collectibleShader->setFloat("time", m_gameTime);
-        m_collectibleModel->draw();
+    Material groundMaterial;
+    groundMaterial.shininess = 32.0f;
+    m_renderer->drawModel(*m_groundModel, groundModel, *m_groundShader, groundMaterial);
+    m_renderer->flush();
+
+    // Render visible collectibles with one instanced draw per LOD
+    m_renderer->beginPass("gpu/collectibles");
+    size_t visibleCount = 0;
+    {
+        PROFILE_SCOPE("frustumCull");
+        // Bounding spheres are grown by the bob amplitude the shader adds
+        if (m_settings.useBvh) {
+            m_collectibleBvh.forEachInFrustum(m_frustum, GameObject::kBobAmplitude, [&](BVH::Id slot) {
+                m_visibleCollectibles[visibleCount++] =
+                    static_cast<uint32_t>(m_collectibles.getIndex(m_collectibles.getHandle(slot)));
+            });
+        } else {
+            visibleCount = m_frustum.cullSpheres(m_collectibles.getPositions().data(),
+                                                 m_collectibles.getBoundingRadii().data(),
+                                                 m_collectibles.size(), GameObject::kBobAmplitude,
+                                                 m_visibleCollectibles.data());
+        }
+    }
+    m_statsVisible = visibleCount;
+    m_statsCulled = m_collectibles.size() - visibleCount;
+
+    // Projected radius in pixels is radius * pixelScale / distance
+    float pixelScale = projection[1][1] * 0.5f * static_cast<float>(m_window->getHeight());
+    packCollectibleInstances(m_collectibles, m_visibleCollectibles.data(), visibleCount, *m_collectibleModel,
+                             eyePosition, pixelScale, renderLag, m_collectibleInstances);
+    for (size_t lod = 0; lod < m_collectibleInstances.size(); ++lod) {
+        m_statsLodCounts[lod] = m_collectibleInstances[lod].size();
+    }
+
+    m_collectibleShader->use();
+    m_collectibleShader->set(m_collectibleShininessUniform, 64.0f);
+    for (size_t lod = 0; lod < m_collectibleInstances.size(); ++lod) {
+        const auto& instances = m_collectibleInstances[lod];
+        if (instances.empty()) continue;
+
+        // All levels share one arena VAO, so each re-points the instance attributes
+        m_collectibleInstanceBuffers[lod]->upload(instances.data(), instances.size());
+        m_collectibleModel->bindInstanceBuffer(*m_collectibleInstanceBuffers[lod], lod);
+        m_collectibleModel->drawInstanced(instances.size(), lod);
     }
 
+    // The UI only prints to the console, so no GPU pass covers it
+    m_renderer->endPass();
     updateUI();
+
+    m_renderer->endFrame();
+    const RenderStats& stats = m_renderer->getFrameStats();
+    Tracer::counter("drawCalls", stats.drawCalls);
+    Tracer::counter("queueBatches", stats.queueBatches);
+    Tracer::counter("collectiblesVisible", static_cast<double>(m_statsVisible));
+    Tracer::counter("collectiblesCulled", static_cast<double>(m_statsCulled));
+    for (size_t lod = 0; lod < m_statsLodCounts.size() && lod < kCollectibleLodLevels; ++lod) {
+        Tracer::counter(kLodCounterNames[lod], static_cast<double>(m_statsLodCounts[lod]));
+    }
+    Tracer::counter("glStateIssued", stats.stateCalls.issued);
+    Tracer::counter("glStateElided", stats.stateCalls.elided);
 }
 
 void Game::processInput(float deltaTime) {
+    PROFILE_SCOPE("processInput");
+
     // Exit on ESC
     if (m_window->isKeyPressed(GLFW_KEY_ESCAPE)) {
         m_running = false;
@@ -297,8 +753,9 @@ void Game::processInput(float deltaTime) {
     if (m_window->isKeyPressed(GLFW_KEY_D)) direction |= 0x08;
 
     m_camera->processKeyboard(direction, deltaTime);
+}
 
-    // Mouse look
+void Game::processMouseInput() {
     double mouseX, mouseY;
     m_window->getMousePosition(mouseX, mouseY);
 
@@ -318,20 +775,34 @@ void Game::processInput(float deltaTime) {
 }
 
 void Game::checkCollisions() {
-    glm::vec3 cameraPos = m_camera->getPosition();
-    float collisionRadius = 0.8f;
+    PROFILE_SCOPE("checkCollisions");
 
-    for (auto& collectible : m_collectibles) {
-        if (collectible->isCollected()) continue;
+    glm::vec3 cameraPos = m_camera->getPosition();
 
-        glm::vec3 objPos = collectible->getPosition();
-        float distance = glm::length(cameraPos - objPos);
-        float minDistance = collisionRadius + collectible->getBoundingRadius();
+    // Broadphase query returns only collectibles overlapping the camera sphere
+    size_t firstCollected = m_collectedHandles.size();
+    auto collect = [this](std::uint32_t slot) {
+        m_collectedHandles.push_back(m_collectibles.getHandle(slot));
+    };
+    if (m_settings.useBvh) {
+        m_collectibleBvh.forEachInSphere(cameraPos, m_collisionRadius, collect);
+    } else {
+        m_collectibleGrid.forEachInSphere(cameraPos, m_collisionRadius, collect);
+    }
 
-        if (distance < minDistance) {
-            collectible->setCollected(true);
-            m_score += 10;
-            m_collectiblesCollected++;
+    for (size_t i = firstCollected; i < m_collectedHandles.size(); ++i) {
+        CollectibleStore::Handle handle = m_collectedHandles[i];
+        m_collectibles.setCollected(m_collectibles.getIndex(handle), true);
+        if (m_settings.useBvh) {
+            m_collectibleBvh.remove(handle.slot);
+        } else {
+            m_collectibleGrid.remove(handle.slot);
+        }
+        m_score += 10;
+        m_collectiblesCollected++;
+        Tracer::instant("collect");
+        Tracer::counter("score", m_score);
+        if (!m_settings.headless) {
             std::cout << "Collected! Score: " << m_score << " (Total: " << m_collectiblesCollected << ")" << std::endl;
         }
     }
@@ -344,15 +815,29 @@ void Game::spawnCollectible() {
         m_posDistribution(m_rng)
     );
 
-    float scale = 0.3f + (m_rng() % 100) / 1000.0f;
-    auto collectible = std::make_shared<GameObject>(
-        m_collectibleModel,
-        position,
-        glm::vec3(scale)
-    );
+    float scale = kMinCollectibleScale + (m_rng() % 100) / 1000.0f;
+    float rotation = m_rotationDistribution(m_rng);
+
+    // Phase the bob so every collectible follows sin(2t + 5x + 5z), matching
+    // neighbours regardless of when each one was spawned
+    const float twoPi = 2.0f * 3.14159265358979323846f;
+    float bobOffset = std::fmod(m_gameTime * GameObject::kDefaultBobSpeed + position.x * 5.0f + position.z * 5.0f, twoPi);
+    if (bobOffset < 0.0f) {
+        bobOffset += twoPi;
+    }
 
-    collectible->setRotation(m_rotationDistribution(m_rng));
-    m_collectibles.push_back(collectible);
+    CollectibleStore::Handle handle = m_collectibles.add(position, glm::vec3(scale), rotation, bobOffset);
+    if (handle == CollectibleStore::kInvalidHandle) {
+        return;
+    }
+
+    size_t index = m_collectibles.getIndex(handle);
+    float radius = m_collectibles.getBoundingRadii()[index];
+    if (m_settings.useBvh) {
+        m_collectibleBvh.insert(handle.slot, position, radius);
+    } else {
+        m_collectibleGrid.insert(handle.slot, position, radius);
+    }
 }
 
 void Game::updateUI() {
@@ -362,7 +847,33 @@ void Game::updateUI() {
     double currentTime = glfwGetTime();
     if (currentTime - lastPrintTime > 5.0) {
         std::cout << "Score: " << m_score << " | Collected: " << m_collectiblesCollected 
-                  << " | Time: " << static_cast<int>(m_gameTime) << "s" << std::endl;
+                  << " | Time: " << static_cast<int>(m_gameTime) << "s";
+        if (m_statsFrames > 0) {
+            std::cout << " | Ticks/frame: " << static_cast<float>(m_statsTicks) / m_statsFrames
+                      << " (max " << m_statsMaxTicks << ")";
+        }
+        if (AllocationCounter::isEnabled()) {
+            std::cout << " | Update allocations: " << m_updateAllocations;
+        }
+        std::cout << " | Visible: " << m_statsVisible << " (culled " << m_statsCulled << ")";
+        std::cout << " | LODs:";
+        for (size_t lod = 0; lod < m_statsLodCounts.size(); ++lod) {
+            std::cout << (lod == 0 ? " " : "/") << m_statsLodCounts[lod];
+        }
+        const GLStateStats& stateCalls = m_renderer->getFrameStats().stateCalls;
+        std::cout << " | GL state calls: " << stateCalls.issued << " issued, "
+                  << stateCalls.elided << " elided";
+        const AssetCacheStats& cacheStats = m_renderer->getAssetCache().getStats();
+        std::cout << " | Asset cache: " << cacheStats.hits << " hits, " << cacheStats.misses << " misses, "
+                  << cacheStats.residentBytes / 1024 << " KB";
+        const GeometryArena& arena = m_renderer->getGeometryArena();
+        std::cout << " | Geometry arena: " << arena.getUsedBytes() / 1024 << " KB in " << arena.getPageCount()
+                  << " pages";
+        std::cout << std::endl;
+
+        m_statsFrames = 0;
+        m_statsTicks = 0;
+        m_statsMaxTicks = 0;
         lastPrintTime = currentTime;
     }
 }
@@ -10,37 +10,46 @@ GameObject::GameObject(std::shared_ptr<Model> model, const glm::vec3& position,
     , m_position(position)
     , m_scale(scale)
     , m_rotation(0.0f)
-    , m_rotationSpeed(45.0f)
+    , m_rotationSpeed(kDefaultRotationSpeed)
     , m_collected(false)
-    , m_boundingRadius(0.5f * glm::max(glm::max(scale.x, scale.y), scale.z))
+    , m_boundingRadius(computeBoundingRadius(scale))
     , m_bobOffset(0.0f)
-    , m_bobSpeed(2.0f) {
+    , m_bobSpeed(kDefaultBobSpeed) {
 }
 
 void GameObject::update(float deltaTime) {
     if (m_collected) return;
 
+    advanceAnimation(m_rotation, m_bobOffset, m_rotationSpeed, m_bobSpeed, deltaTime);
+}
+
+void GameObject::advanceAnimation(float& rotation, float& bobOffset,
+                                  float rotationSpeed, float bobSpeed, float deltaTime) {
     // Rotate
-    m_rotation += m_rotationSpeed * deltaTime;
-    if (m_rotation >= 360.0f) {
-        m_rotation -= 360.0f;
+    rotation += rotationSpeed * deltaTime;
+    if (rotation >= 360.0f) {
+        rotation -= 360.0f;
     }
 
     // Bob up and down
-    m_bobOffset += m_bobSpeed * deltaTime;
+    bobOffset += bobSpeed * deltaTime;
     const float twoPi = 2.0f * 3.14159265358979323846f;
-    if (m_bobOffset >= twoPi) {
-        m_bobOffset -= twoPi;
+    if (bobOffset >= twoPi) {
+        bobOffset -= twoPi;
     }
 }
 
+float GameObject::computeBoundingRadius(const glm::vec3& scale, float modelRadius) {
+    return modelRadius * glm::max(glm::max(scale.x, scale.y), scale.z);
+}
+
 void GameObject::render(const glm::mat4& view, const glm::mat4& projection) {
     if (m_collected) return;
 
     // Calculate model matrix with bobbing
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, m_position);
-    model = glm::translate(model, glm::vec3(0.0f, std::sin(m_bobOffset) * 0.1f, 0.0f));
+    model = glm::translate(model, glm::vec3(0.0f, std::sin(m_bobOffset) * kBobAmplitude, 0.0f));
     model = glm::rotate(model, glm::radians(m_rotation), glm::vec3(0.0f, 1.0f, 0.0f));
     model = glm::scale(model, m_scale);
 
@@ -0,0 +1,313 @@
+#include "GeometryArena.h"
+#include "InstanceBuffer.h"
+#include "GLStateCache.h"
+#include <algorithm>
+#include <iostream>
+
+namespace RenderEngine {
+
+namespace {
+
+GeometryArena* s_current = nullptr;
+
+// Index ranges start on a 4-byte boundary so 16- and 32-bit indices can share a page
+constexpr size_t kIndexAlignment = 4;
+
+// Instance attribute state that must be re-pointed before the next use
+constexpr unsigned int kStaleBuffer = 0xFFFFFFFFu;
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+GeometryArena::RangeAllocator::RangeAllocator(size_t capacity) {
+    if (capacity > 0) {
+        m_free.push_back({0, capacity});
+    }
+}
+
+bool GeometryArena::RangeAllocator::allocate(size_t size, size_t alignment, size_t& offset) {
+    for (size_t i = 0; i < m_free.size(); ++i) {
+        Range& range = m_free[i];
+        size_t start = alignUp(range.offset, alignment);
+        size_t end = range.offset + range.size;
+        if (start + size > end) continue;
+
+        offset = start;
+        size_t head = start - range.offset;
+        size_t tail = end - (start + size);
+        if (head == 0 && tail == 0) {
+            m_free.erase(m_free.begin() + i);
+        } else if (head == 0) {
+            range.offset = start + size;
+            range.size = tail;
+        } else {
+            range.size = head;
+            if (tail > 0) {
+                m_free.insert(m_free.begin() + i + 1, {start + size, tail});
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+void GeometryArena::RangeAllocator::release(size_t offset, size_t size) {
+    auto next = std::lower_bound(m_free.begin(), m_free.end(), offset,
+                                 [](const Range& range, size_t value) { return range.offset < value; });
+    next = m_free.insert(next, {offset, size});
+
+    // Coalesce with the following and the preceding range
+    if (next + 1 != m_free.end() && next->offset + next->size == (next + 1)->offset) {
+        next->size += (next + 1)->size;
+        m_free.erase(next + 1);
+    }
+    if (next != m_free.begin() && (next - 1)->offset + (next - 1)->size == next->offset) {
+        (next - 1)->size += next->size;
+        m_free.erase(next);
+    }
+}
+
+GeometryArena::GeometryArena()
+    : m_livePageCount(0)
+    , m_usedBytes(0) {
+}
+
+GeometryArena::~GeometryArena() {
+    for (auto& page : m_pages) {
+        destroyPage(page);
+    }
+
+    if (s_current == this) {
+        s_current = nullptr;
+    }
+}
+
+GeometryArena* GeometryArena::current() {
+    return s_current;
+}
+
+void GeometryArena::makeCurrent() {
+    s_current = this;
+}
+
+GeometryAllocation GeometryArena::allocate(const VertexFormat& format, const void* vertices, size_t vertexCount,
+                                           const void* indices, size_t indexBytes) {
+    return allocate(format, &vertices, vertexCount, indices, indexBytes);
+}
+
+GeometryAllocation GeometryArena::allocate(const VertexFormat& format, const void* const* streams, size_t vertexCount,
+                                           const void* indices, size_t indexBytes) {
+    GeometryAllocation allocation;
+    if (vertexCount == 0 || indexBytes == 0 || format.stride == 0) {
+        return allocation;
+    }
+
+    size_t indexSize = alignUp(indexBytes, kIndexAlignment);
+    size_t vertexOffset = 0;
+    size_t indexOffset = 0;
+    std::uint32_t pageIndex = GeometryAllocation::kInvalidPage;
+
+    for (std::uint32_t i = 0; i < m_pages.size(); ++i) {
+        Page& page = m_pages[i];
+        if (page.vao == 0 || page.format != format) continue;
+        if (!page.vertices.allocate(vertexCount, 1, vertexOffset)) continue;
+        if (!page.indices.allocate(indexSize, kIndexAlignment, indexOffset)) {
+            page.vertices.release(vertexOffset, vertexCount);
+            continue;
+        }
+        pageIndex = i;
+        break;
+    }
+
+    if (pageIndex == GeometryAllocation::kInvalidPage) {
+        // Oversized meshes get a page of exactly their size. Planar regions
+        // stay 4-byte aligned when the capacity is a multiple of 4.
+        size_t vertexCapacity = alignUp(std::max(kPageVertexBytes / format.stride, vertexCount), 4);
+        size_t indexCapacity = std::max(kPageIndexBytes, indexSize);
+        pageIndex = createPage(format, vertexCapacity, indexCapacity);
+        m_pages[pageIndex].vertices.allocate(vertexCount, 1, vertexOffset);
+        m_pages[pageIndex].indices.allocate(indexSize, kIndexAlignment, indexOffset);
+    }
+
+    // The element buffer binding is VAO state, so bind the page's VAO first
+    Page& page = m_pages[pageIndex];
+    GLStateCache& state = GLStateCache::current();
+    state.bindVertexArray(page.vao);
+    state.bindBuffer(GL_ARRAY_BUFFER, page.vbo);
+    if (format.planar) {
+        size_t regionOffset = 0;
+        for (size_t i = 0; i < format.attributes.size(); ++i) {
+            size_t size = getAttributeSize(format.attributes[i]);
+            glBufferSubData(GL_ARRAY_BUFFER, regionOffset + vertexOffset * size, vertexCount * size, streams[i]);
+            regionOffset += page.vertexCapacity * size;
+        }
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, vertexOffset * format.stride, vertexCount * format.stride, streams[0]);
+    }
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, page.ebo);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexOffset, indexBytes, indices);
+
+    page.allocationCount++;
+    allocation.page = pageIndex;
+    allocation.baseVertex = static_cast<std::uint32_t>(vertexOffset);
+    allocation.vertexCount = static_cast<std::uint32_t>(vertexCount);
+    allocation.indexOffset = indexOffset;
+    allocation.indexBytes = indexBytes;
+    m_usedBytes += vertexCount * format.stride + indexSize;
+    return allocation;
+}
+
+void GeometryArena::release(const GeometryAllocation& allocation) {
+    if (!allocation.isValid() || allocation.page >= m_pages.size()) return;
+
+    Page& page = m_pages[allocation.page];
+    size_t indexSize = alignUp(allocation.indexBytes, kIndexAlignment);
+    page.vertices.release(allocation.baseVertex, allocation.vertexCount);
+    page.indices.release(allocation.indexOffset, indexSize);
+    m_usedBytes -= allocation.vertexCount * page.format.stride + indexSize;
+
+    // Otherwise a burst of loads would keep its pages for good
+    if (--page.allocationCount == 0) {
+        destroyPage(page);
+    }
+}
+
+unsigned int GeometryArena::getVertexArray(const GeometryAllocation& allocation) const {
+    return allocation.isValid() ? m_pages[allocation.page].vao : 0;
+}
+
+void GeometryArena::bindInstanceBuffer(const GeometryAllocation& allocation, const InstanceBuffer& buffer,
+                                       size_t firstInstance) {
+    if (!allocation.isValid()) return;
+
+    // Every mesh of the page shares these pointers, so they are compared
+    // per location rather than per mesh and only re-pointed on a change
+    Page& page = m_pages[allocation.page];
+    GLStateCache& state = GLStateCache::current();
+    bool bound = false;
+
+    // A location left enabled by another buffer, such as the render queue's
+    // transform columns under the collectibles' attributes, would still
+    // feed this draw
+    std::uint32_t usedLocations = 0;
+    for (const auto& attribute : buffer.getAttributes()) {
+        usedLocations |= attribute.location < kMaxAttributes ? 1u << attribute.location : 0u;
+    }
+    for (unsigned int location = 0; location < kMaxAttributes; ++location) {
+        InstanceAttributeState& current = page.instanceAttributes[location];
+        if (current.buffer == 0 || (usedLocations & (1u << location)) != 0) continue;
+
+        state.bindVertexArray(page.vao);
+        glDisableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 0);
+        current = {0, 0};
+    }
+
+    size_t base = firstInstance * buffer.getStride();
+    for (const auto& attribute : buffer.getAttributes()) {
+        if (attribute.location >= kMaxAttributes) {
+            std::cerr << "Instance attribute location " << attribute.location << " out of range" << std::endl;
+            continue;
+        }
+
+        InstanceAttributeState& current = page.instanceAttributes[attribute.location];
+        size_t offset = base + attribute.offset;
+        if (current.buffer == buffer.getId() && current.offset == offset) continue;
+
+        if (!bound) {
+            state.bindVertexArray(page.vao);
+            state.bindBuffer(GL_ARRAY_BUFFER, buffer.getId());
+            bound = true;
+        }
+        if (current.buffer == 0) {
+            glEnableVertexAttribArray(attribute.location);
+            glVertexAttribDivisor(attribute.location, 1);
+        }
+        glVertexAttribPointer(attribute.location, attribute.components, GL_FLOAT, GL_FALSE,
+                              static_cast<GLsizei>(buffer.getStride()), (void*)offset);
+        current.buffer = buffer.getId();
+        current.offset = offset;
+    }
+}
+
+void GeometryArena::forgetInstanceBuffer(unsigned int buffer) {
+    // A new buffer may reuse the name, but the VAO still references the old one
+    for (auto& page : m_pages) {
+        for (auto& attribute : page.instanceAttributes) {
+            if (attribute.buffer == buffer) {
+                attribute.buffer = kStaleBuffer;
+            }
+        }
+    }
+}
+
+std::uint32_t GeometryArena::createPage(const VertexFormat& format, size_t vertexCapacity, size_t indexCapacity) {
+    Page page;
+    page.format = format;
+    page.vertexCapacity = vertexCapacity;
+    page.allocationCount = 0;
+    page.vertices = RangeAllocator(vertexCapacity);
+    page.indices = RangeAllocator(indexCapacity);
+    for (auto& attribute : page.instanceAttributes) {
+        attribute = {0, 0};
+    }
+
+    glGenVertexArrays(1, &page.vao);
+    glGenBuffers(1, &page.vbo);
+    glGenBuffers(1, &page.ebo);
+
+    GLStateCache& state = GLStateCache::current();
+    state.bindVertexArray(page.vao);
+
+    state.bindBuffer(GL_ARRAY_BUFFER, page.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity * format.stride, nullptr, GL_STATIC_DRAW);
+
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, page.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity, nullptr, GL_STATIC_DRAW);
+
+    size_t regionOffset = 0;
+    for (const auto& attribute : format.attributes) {
+        size_t size = getAttributeSize(attribute);
+        size_t offset = format.planar ? regionOffset : attribute.offset;
+        size_t stride = format.planar ? size : format.stride;
+        regionOffset += vertexCapacity * size;
+
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.type,
+                              attribute.normalized ? GL_TRUE : GL_FALSE,
+                              static_cast<GLsizei>(stride), (void*)offset);
+    }
+
+    m_livePageCount++;
+    for (std::uint32_t i = 0; i < m_pages.size(); ++i) {
+        if (m_pages[i].vao == 0) {
+            m_pages[i] = std::move(page);
+            return i;
+        }
+    }
+    m_pages.push_back(std::move(page));
+    return static_cast<std::uint32_t>(m_pages.size() - 1);
+}
+
+void GeometryArena::destroyPage(Page& page) {
+    if (page.vao == 0) return;
+
+    GLStateCache& state = GLStateCache::current();
+    state.forgetVertexArray(page.vao);
+    state.forgetBuffer(page.vbo);
+    state.forgetBuffer(page.ebo);
+    glDeleteVertexArrays(1, &page.vao);
+    glDeleteBuffers(1, &page.vbo);
+    glDeleteBuffers(1, &page.ebo);
+    page.vao = 0;
+    page.vbo = 0;
+    page.ebo = 0;
+    page.vertices = RangeAllocator();
+    page.indices = RangeAllocator();
+    m_livePageCount--;
+}
+
+} // namespace RenderEngine
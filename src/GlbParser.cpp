@@ -0,0 +1,394 @@
+#include "GlbParser.h"
+#include "Json.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+namespace RenderEngine {
+
+namespace {
+
+constexpr std::uint32_t kGlbMagic = 0x46546C67;      // "glTF"
+constexpr std::uint32_t kJsonChunk = 0x4E4F534A;     // "JSON"
+constexpr std::uint32_t kBinChunk = 0x004E4942;      // "BIN\0"
+constexpr size_t kHeaderBytes = 12;
+constexpr size_t kChunkHeaderBytes = 8;
+
+constexpr int kTriangles = 4;
+
+// glTF component types (equal to the GL enums)
+constexpr unsigned int kByte = 5120;
+constexpr unsigned int kUnsignedByte = 5121;
+constexpr unsigned int kShort = 5122;
+constexpr unsigned int kUnsignedShort = 5123;
+constexpr unsigned int kUnsignedInt = 5125;
+constexpr unsigned int kFloat = 5126;
+
+// Element component of an accessor as float, applying glTF normalization
+float readComponent(const GltfAccessor& accessor, size_t index, int component) {
+    const unsigned char* p = accessor.data + index * accessor.stride;
+    switch (accessor.componentType) {
+    case kFloat: {
+        float value;
+        std::memcpy(&value, p + component * sizeof(float), sizeof(value));
+        return value;
+    }
+    case kUnsignedByte: {
+        float value = p[component];
+        return accessor.normalized ? value / 255.0f : value;
+    }
+    case kUnsignedShort: {
+        std::uint16_t value;
+        std::memcpy(&value, p + component * sizeof(value), sizeof(value));
+        return accessor.normalized ? value / 65535.0f : static_cast<float>(value);
+    }
+    case kByte: {
+        float value = static_cast<signed char>(p[component]);
+        return accessor.normalized ? std::max(value / 127.0f, -1.0f) : value;
+    }
+    case kShort: {
+        std::int16_t value;
+        std::memcpy(&value, p + component * sizeof(value), sizeof(value));
+        return accessor.normalized ? std::max(value / 32767.0f, -1.0f) : static_cast<float>(value);
+    }
+    default:
+        return 0.0f;
+    }
+}
+
+unsigned int readIndex(const GltfAccessor& accessor, size_t i) {
+    const unsigned char* p = accessor.data + i * accessor.stride;
+    if (accessor.componentType == kUnsignedInt) {
+        std::uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    if (accessor.componentType == kUnsignedShort) {
+        std::uint16_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    return *p;
+}
+
+std::uint32_t readU32(const char* p) {
+    // GLB is little-endian, as is every platform the engine targets
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+size_t componentSize(unsigned int componentType) {
+    switch (componentType) {
+    case kByte:
+    case kUnsignedByte:
+        return 1;
+    case kShort:
+    case kUnsignedShort:
+        return 2;
+    case kUnsignedInt:
+    case kFloat:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+int componentCount(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    return 0;
+}
+
+// Largest integer a double represents exactly
+constexpr double kMaxExactInteger = 9007199254740992.0;
+
+// Sizes and offsets are non-negative integers; -1 marks anything else.
+// The range is checked before the cast, which is undefined out of range.
+long long readInteger(const JsonValue& value, long long fallback = -1) {
+    if (value.isNull()) return fallback;
+    double number = value.asNumber(-1.0);
+    if (!(number >= 0.0 && number <= kMaxExactInteger) || number != std::floor(number)) return -1;
+    return static_cast<long long>(number);
+}
+
+/**
+ * @brief Resolves accessor indices of one document against the BIN chunk
+ */
+class AccessorResolver {
+public:
+    AccessorResolver(const JsonValue& document, const unsigned char* bin, size_t binSize)
+        : m_document(document), m_bin(bin), m_binSize(binSize) {
+    }
+
+    // On failure reason says why the accessor cannot be used
+    bool resolve(const JsonValue& index, GltfAccessor& accessor, std::string& reason) const {
+        long long accessorIndex = readInteger(index);
+        const JsonValue& json = m_document["accessors"].at(static_cast<size_t>(accessorIndex));
+        if (accessorIndex < 0 || !json.isObject()) {
+            reason = "invalid accessor index";
+            return false;
+        }
+        if (json.has("sparse")) {
+            reason = "sparse accessors are not supported";
+            return false;
+        }
+
+        long long viewIndex = readInteger(json["bufferView"]);
+        const JsonValue& view = m_document["bufferViews"].at(static_cast<size_t>(viewIndex));
+        if (viewIndex < 0 || !view.isObject()) {
+            reason = "accessor without a buffer view";
+            return false;
+        }
+        if (readInteger(view["buffer"]) != 0 || m_document["buffers"].at(0).has("uri")) {
+            reason = "external buffers are not supported";
+            return false;
+        }
+
+        long long componentType = readInteger(json["componentType"]);
+        accessor.componentType = componentType < 0 ? 0 : static_cast<unsigned int>(componentType);
+        accessor.components = componentCount(json["type"].asString());
+        accessor.normalized = json["normalized"].asBool();
+        accessor.bufferView = static_cast<int>(viewIndex);
+        accessor.elementSize = componentSize(accessor.componentType) * static_cast<size_t>(accessor.components);
+        if (accessor.elementSize == 0) {
+            reason = "unsupported accessor type";
+            return false;
+        }
+
+        long long count = readInteger(json["count"]);
+        long long accessorOffset = readInteger(json["byteOffset"], 0);
+        long long viewOffset = readInteger(view["byteOffset"], 0);
+        long long viewLength = readInteger(view["byteLength"]);
+        long long stride = readInteger(view["byteStride"], static_cast<long long>(accessor.elementSize));
+        if (count <= 0 || accessorOffset < 0 || viewOffset < 0 || viewLength < 0 || stride <= 0 ||
+            static_cast<size_t>(stride) < accessor.elementSize) {
+            reason = "malformed accessor or buffer view";
+            return false;
+        }
+        if (static_cast<unsigned long long>(viewOffset) + static_cast<unsigned long long>(viewLength) > m_binSize) {
+            reason = "buffer view outside the BIN chunk";
+            return false;
+        }
+        // Divide rather than multiply so a huge count cannot wrap around
+        unsigned long long length = static_cast<unsigned long long>(viewLength);
+        unsigned long long firstEnd = static_cast<unsigned long long>(accessorOffset) + accessor.elementSize;
+        if (firstEnd > length ||
+            static_cast<unsigned long long>(count - 1) > (length - firstEnd) / static_cast<unsigned long long>(stride)) {
+            reason = "accessor outside its buffer view";
+            return false;
+        }
+
+        accessor.data = m_bin + viewOffset + accessorOffset;
+        accessor.viewEnd = m_bin + viewOffset + viewLength;
+        accessor.count = static_cast<size_t>(count);
+        accessor.stride = static_cast<size_t>(stride);
+        return true;
+    }
+
+private:
+    const JsonValue& m_document;
+    const unsigned char* m_bin;
+    size_t m_binSize;
+};
+
+} // namespace
+
+bool GlbParser::parse(const char* data, size_t size, std::vector<GltfMesh>& meshes, std::string& error,
+                      std::vector<std::string>* warnings) {
+    meshes.clear();
+    if (size < kHeaderBytes + kChunkHeaderBytes || readU32(data) != kGlbMagic) {
+        error = "Not a binary glTF file";
+        return false;
+    }
+    if (readU32(data + 4) != 2) {
+        error = "Unsupported glTF version " + std::to_string(readU32(data + 4));
+        return false;
+    }
+    size_t length = readU32(data + 8);
+    if (length > size) {
+        error = "File is truncated";
+        return false;
+    }
+
+    // The JSON chunk comes first, optionally followed by the BIN chunk
+    const char* json = nullptr;
+    size_t jsonSize = 0;
+    const unsigned char* bin = nullptr;
+    size_t binSize = 0;
+    size_t offset = kHeaderBytes;
+    while (offset + kChunkHeaderBytes <= length) {
+        size_t chunkSize = readU32(data + offset);
+        std::uint32_t chunkType = readU32(data + offset + 4);
+        const char* chunk = data + offset + kChunkHeaderBytes;
+        if (chunkSize > length - offset - kChunkHeaderBytes) {
+            error = "Chunk extends past the end of the file";
+            return false;
+        }
+        if (chunkType == kJsonChunk && !json) {
+            json = chunk;
+            jsonSize = chunkSize;
+        } else if (chunkType == kBinChunk && !bin) {
+            bin = reinterpret_cast<const unsigned char*>(chunk);
+            binSize = chunkSize;
+        }
+        offset += kChunkHeaderBytes + chunkSize;
+    }
+    if (!json) {
+        error = "Missing JSON chunk";
+        return false;
+    }
+
+    JsonValue document;
+    std::string jsonError;
+    if (!JsonValue::parse(json, jsonSize, document, jsonError)) {
+        error = "Invalid JSON chunk: " + jsonError;
+        return false;
+    }
+
+    auto warn = [warnings](const std::string& message) {
+        if (warnings) {
+            warnings->push_back(message);
+        }
+    };
+
+    AccessorResolver resolver(document, bin, binSize);
+    const JsonValue& meshArray = document["meshes"];
+    for (size_t m = 0; m < meshArray.size(); ++m) {
+        const JsonValue& meshJson = meshArray.at(m);
+        GltfMesh mesh;
+        mesh.name = meshJson["name"].isString() ? meshJson["name"].asString() : "mesh" + std::to_string(m);
+
+        const JsonValue& primitives = meshJson["primitives"];
+        for (size_t p = 0; p < primitives.size(); ++p) {
+            const JsonValue& primitiveJson = primitives.at(p);
+            std::string where = mesh.name + " primitive " + std::to_string(p) + ": ";
+            if (readInteger(primitiveJson["mode"], kTriangles) != kTriangles) {
+                warn(where + "only triangle lists are supported");
+                continue;
+            }
+
+            const JsonValue& attributes = primitiveJson["attributes"];
+            GltfPrimitive primitive;
+            std::string reason;
+            if (!attributes.has("POSITION")) {
+                warn(where + "no POSITION attribute");
+                continue;
+            }
+            if (!resolver.resolve(attributes["POSITION"], primitive.position, reason) ||
+                (attributes.has("NORMAL") && !resolver.resolve(attributes["NORMAL"], primitive.normal, reason)) ||
+                (attributes.has("TEXCOORD_0") &&
+                 !resolver.resolve(attributes["TEXCOORD_0"], primitive.texCoords, reason)) ||
+                (primitiveJson.has("indices") && !resolver.resolve(primitiveJson["indices"], primitive.indices, reason))) {
+                warn(where + reason);
+                continue;
+            }
+
+            if (primitive.position.componentType != kFloat || primitive.position.components != 3) {
+                warn(where + "positions must be float VEC3");
+                continue;
+            }
+            if (primitive.normal.isValid() &&
+                (primitive.normal.componentType != kFloat || primitive.normal.components != 3)) {
+                warn(where + "normals must be float VEC3");
+                continue;
+            }
+            if (primitive.texCoords.isValid() && primitive.texCoords.components != 2) {
+                warn(where + "texture coordinates must be VEC2");
+                continue;
+            }
+            if (primitive.indices.isValid() &&
+                (primitive.indices.components != 1 || !primitive.indices.isTight() ||
+                 (primitive.indices.componentType != kUnsignedByte &&
+                  primitive.indices.componentType != kUnsignedShort &&
+                  primitive.indices.componentType != kUnsignedInt))) {
+                warn(where + "indices must be tightly packed unsigned integers");
+                continue;
+            }
+            if ((primitive.normal.isValid() && primitive.normal.count != primitive.position.count) ||
+                (primitive.texCoords.isValid() && primitive.texCoords.count != primitive.position.count)) {
+                warn(where + "attribute counts differ");
+                continue;
+            }
+
+            size_t indexCount = primitive.indices.isValid() ? primitive.indices.count : primitive.position.count;
+            bool indicesInRange = indexCount >= 3;
+            for (size_t i = 0; primitive.indices.isValid() && indicesInRange && i < indexCount; ++i) {
+                indicesInRange = readIndex(primitive.indices, i) < primitive.position.count;
+            }
+            if (!indicesInRange) {
+                warn(where + "indices out of range or fewer than three");
+                continue;
+            }
+
+            mesh.primitives.push_back(primitive);
+        }
+
+        if (!mesh.primitives.empty()) {
+            meshes.push_back(std::move(mesh));
+        }
+    }
+    return true;
+}
+
+void GlbParser::readIndices(const GltfPrimitive& primitive, std::vector<unsigned int>& indices) {
+    const GltfAccessor& accessor = primitive.indices;
+    indices.resize(accessor.isValid() ? accessor.count : primitive.position.count);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = accessor.isValid() ? readIndex(accessor, i) : static_cast<unsigned int>(i);
+    }
+}
+
+void GlbParser::decode(const GltfPrimitive& primitive, std::vector<Vertex>& vertices,
+                       std::vector<unsigned int>& indices) {
+    auto decodeVertex = [&primitive](size_t index) {
+        Vertex vertex(glm::vec3(readComponent(primitive.position, index, 0),
+                                readComponent(primitive.position, index, 1),
+                                readComponent(primitive.position, index, 2)),
+                      glm::vec3(0.0f), glm::vec2(0.0f));
+        if (primitive.normal.isValid()) {
+            vertex.normal = glm::vec3(readComponent(primitive.normal, index, 0),
+                                      readComponent(primitive.normal, index, 1),
+                                      readComponent(primitive.normal, index, 2));
+        }
+        if (primitive.texCoords.isValid()) {
+            vertex.texCoords = glm::vec2(readComponent(primitive.texCoords, index, 0),
+                                         readComponent(primitive.texCoords, index, 1));
+        }
+        return vertex;
+    };
+
+    vertices.clear();
+    readIndices(primitive, indices);
+    if (primitive.normal.isValid()) {
+        vertices.reserve(primitive.position.count);
+        for (size_t i = 0; i < primitive.position.count; ++i) {
+            vertices.push_back(decodeVertex(i));
+        }
+        return;
+    }
+
+    // Flat shading needs its own vertex per triangle corner
+    std::vector<unsigned int> sourceIndices;
+    sourceIndices.swap(indices);
+    vertices.reserve(sourceIndices.size());
+    indices.reserve(sourceIndices.size());
+    for (size_t i = 0; i + 2 < sourceIndices.size(); i += 3) {
+        Vertex corners[3] = {decodeVertex(sourceIndices[i]), decodeVertex(sourceIndices[i + 1]),
+                             decodeVertex(sourceIndices[i + 2])};
+        glm::vec3 normal = glm::cross(corners[1].position - corners[0].position,
+                                      corners[2].position - corners[0].position);
+        float length = glm::length(normal);
+        normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        for (Vertex& corner : corners) {
+            corner.normal = normal;
+            indices.push_back(static_cast<unsigned int>(vertices.size()));
+            vertices.push_back(corner);
+        }
+    }
+}
+
+} // namespace RenderEngine
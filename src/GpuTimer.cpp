@@ -0,0 +1,91 @@
+#include "GpuTimer.h"
+
+namespace RenderEngine {
+
+GpuTimer::GpuTimer()
+    : m_current(0)
+    , m_passOpen(false)
+    , m_hasNewResults(false)
+    , m_droppedFrames(0) {
+}
+
+GpuTimer::~GpuTimer() {
+    for (auto& frame : m_frames) {
+        if (!frame.pool.empty()) {
+            glDeleteQueries(static_cast<GLsizei>(frame.pool.size()), frame.pool.data());
+        }
+    }
+}
+
+void GpuTimer::beginFrame() {
+    endPass();
+
+    m_current = (m_current + 1) % kFrameLatency;
+    FrameQueries& frame = m_frames[m_current];
+
+    m_hasNewResults = false;
+    if (!frame.passes.empty()) {
+        if (resolve(frame)) {
+            m_hasNewResults = true;
+        } else {
+            m_droppedFrames++;
+        }
+    }
+    frame.passes.clear();
+}
+
+void GpuTimer::beginPass(const char* name) {
+    endPass();
+
+    FrameQueries& frame = m_frames[m_current];
+    size_t index = frame.passes.size();
+    if (index == frame.pool.size()) {
+        unsigned int query = 0;
+        glGenQueries(1, &query);
+        frame.pool.push_back(query);
+    }
+
+    unsigned int query = frame.pool[index];
+    frame.passes.push_back(PassQuery{ name, query });
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    m_passOpen = true;
+}
+
+void GpuTimer::endPass() {
+    if (!m_passOpen) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    m_passOpen = false;
+}
+
+bool GpuTimer::resolve(FrameQueries& frame) {
+    // Queries complete in submission order, so the last one being ready
+    // means the whole set is
+    GLint available = 0;
+    glGetQueryObjectiv(frame.passes.back().query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return false;
+    }
+
+    m_results.clear();
+    for (const auto& pass : frame.passes) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(pass.query, GL_QUERY_RESULT, &elapsed);
+
+        // Passes recorded several times in a frame are summed
+        bool merged = false;
+        for (auto& result : m_results) {
+            if (result.name == pass.name) {
+                result.milliseconds += static_cast<double>(elapsed) * 1e-6;
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) {
+            m_results.push_back(GpuPassTiming{ pass.name, static_cast<double>(elapsed) * 1e-6 });
+        }
+    }
+    return true;
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,40 @@
+#include "InstanceBuffer.h"
+#include "GLStateCache.h"
+#include "GeometryArena.h"
+
+namespace RenderEngine {
+
+InstanceBuffer::InstanceBuffer(size_t stride, const std::vector<InstanceAttribute>& attributes)
+    : m_VBO(0), m_stride(stride), m_capacity(0), m_count(0), m_attributes(attributes) {
+    glGenBuffers(1, &m_VBO);
+}
+
+InstanceBuffer::~InstanceBuffer() {
+    if (m_VBO != 0) {
+        if (GeometryArena* arena = GeometryArena::current()) {
+            arena->forgetInstanceBuffer(m_VBO);
+        }
+        GLStateCache::current().forgetBuffer(m_VBO);
+        glDeleteBuffers(1, &m_VBO);
+    }
+}
+
+void InstanceBuffer::upload(const void* data, size_t count) {
+    size_t size = count * m_stride;
+    m_count = count;
+
+    if (size > m_capacity) {
+        // Grow geometrically so a slowly rising instance count does not
+        // reallocate the buffer every frame
+        m_capacity = size + size / 2;
+    }
+
+    // Orphan the old storage instead of synchronising with the GPU
+    GLStateCache::current().bindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+    if (size > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+    }
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,350 @@
+#include "Json.h"
+#include <cmath>
+
+namespace RenderEngine {
+
+namespace {
+
+// Deeper documents are rejected instead of overflowing the stack
+constexpr int kMaxDepth = 256;
+
+const double kPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+const JsonValue& nullValue() {
+    static const JsonValue value;
+    return value;
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void appendUtf8(std::string& out, unsigned int codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Recursive-descent reader filling a JsonValue tree
+ */
+class JsonReader {
+public:
+    JsonReader(const char* text, size_t size)
+        : m_begin(text), m_p(text), m_end(text + size) {
+    }
+
+    bool read(JsonValue& value, std::string& error) {
+        bool ok = readValue(value, 0);
+        if (ok) {
+            skipSpace();
+            if (m_p != m_end) {
+                ok = fail("Unexpected data after the document");
+            }
+        }
+        if (!ok) {
+            error = m_error + " at byte " + std::to_string(m_p - m_begin);
+        }
+        return ok;
+    }
+
+private:
+    bool fail(const char* message) {
+        if (m_error.empty()) {
+            m_error = message;
+        }
+        return false;
+    }
+
+    void skipSpace() {
+        while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r')) {
+            ++m_p;
+        }
+    }
+
+    bool consume(const char* literal) {
+        const char* p = m_p;
+        for (; *literal; ++literal, ++p) {
+            if (p == m_end || *p != *literal) return false;
+        }
+        m_p = p;
+        return true;
+    }
+
+    bool readValue(JsonValue& value, int depth) {
+        if (depth > kMaxDepth) {
+            return fail("Document nested too deeply");
+        }
+        skipSpace();
+        if (m_p == m_end) {
+            return fail("Unexpected end of document");
+        }
+
+        switch (*m_p) {
+        case '{':
+            return readObject(value, depth);
+        case '[':
+            return readArray(value, depth);
+        case '"':
+            value.m_type = JsonValue::Type::String;
+            return readString(value.m_string);
+        case 't':
+        case 'f':
+            value.m_type = JsonValue::Type::Bool;
+            value.m_bool = *m_p == 't';
+            return consume(value.m_bool ? "true" : "false") || fail("Invalid literal");
+        case 'n':
+            value.m_type = JsonValue::Type::Null;
+            return consume("null") || fail("Invalid literal");
+        default:
+            value.m_type = JsonValue::Type::Number;
+            return readNumber(value.m_number);
+        }
+    }
+
+    bool readObject(JsonValue& value, int depth) {
+        value.m_type = JsonValue::Type::Object;
+        ++m_p;
+        skipSpace();
+        if (m_p < m_end && *m_p == '}') {
+            ++m_p;
+            return true;
+        }
+
+        while (true) {
+            skipSpace();
+            if (m_p == m_end || *m_p != '"') {
+                return fail("Expected a member name");
+            }
+            value.m_members.emplace_back();
+            auto& member = value.m_members.back();
+            if (!readString(member.first)) return false;
+
+            skipSpace();
+            if (m_p == m_end || *m_p != ':') {
+                return fail("Expected ':' after a member name");
+            }
+            ++m_p;
+            if (!readValue(member.second, depth + 1)) return false;
+
+            skipSpace();
+            if (m_p < m_end && *m_p == ',') {
+                ++m_p;
+            } else if (m_p < m_end && *m_p == '}') {
+                ++m_p;
+                return true;
+            } else {
+                return fail("Expected ',' or '}' in an object");
+            }
+        }
+    }
+
+    bool readArray(JsonValue& value, int depth) {
+        value.m_type = JsonValue::Type::Array;
+        ++m_p;
+        skipSpace();
+        if (m_p < m_end && *m_p == ']') {
+            ++m_p;
+            return true;
+        }
+
+        while (true) {
+            value.m_elements.emplace_back();
+            if (!readValue(value.m_elements.back(), depth + 1)) return false;
+
+            skipSpace();
+            if (m_p < m_end && *m_p == ',') {
+                ++m_p;
+            } else if (m_p < m_end && *m_p == ']') {
+                ++m_p;
+                return true;
+            } else {
+                return fail("Expected ',' or ']' in an array");
+            }
+        }
+    }
+
+    bool readHex4(unsigned int& codeUnit) {
+        if (m_end - m_p < 4) {
+            return fail("Truncated \\u escape");
+        }
+        codeUnit = 0;
+        for (int i = 0; i < 4; ++i) {
+            int digit = hexDigit(*m_p++);
+            if (digit < 0) {
+                return fail("Invalid \\u escape");
+            }
+            codeUnit = codeUnit * 16 + static_cast<unsigned int>(digit);
+        }
+        return true;
+    }
+
+    bool readString(std::string& out) {
+        ++m_p;
+        while (true) {
+            // Copy the run up to the next quote or escape at once
+            const char* run = m_p;
+            while (m_p < m_end && *m_p != '"' && *m_p != '\\') {
+                if (static_cast<unsigned char>(*m_p) < 0x20) {
+                    return fail("Control character in a string");
+                }
+                ++m_p;
+            }
+            out.append(run, m_p);
+            if (m_p == m_end) {
+                return fail("Unterminated string");
+            }
+            if (*m_p++ == '"') {
+                return true;
+            }
+
+            if (m_p == m_end) {
+                return fail("Unterminated string");
+            }
+            char escape = *m_p++;
+            switch (escape) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned int codePoint;
+                if (!readHex4(codePoint)) return false;
+                if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                    unsigned int low;
+                    if (!consume("\\u") || !readHex4(low) || low < 0xDC00 || low >= 0xE000) {
+                        return fail("Unpaired surrogate in a string");
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                return fail("Invalid escape in a string");
+            }
+        }
+    }
+
+    bool readNumber(double& value) {
+        const char* p = m_p;
+        bool negative = false;
+        if (p < m_end && *p == '-') {
+            negative = true;
+            ++p;
+        }
+        if (p == m_end || !isDigit(*p)) {
+            return fail("Invalid value");
+        }
+
+        // Digits beyond double precision only shift the exponent
+        double mantissa = 0.0;
+        int exponent = 0;
+        int digits = 0;
+        for (; p < m_end && isDigit(*p); ++p) {
+            if (digits++ < 18) {
+                mantissa = mantissa * 10.0 + (*p - '0');
+            } else {
+                ++exponent;
+            }
+        }
+        if (p < m_end && *p == '.') {
+            ++p;
+            if (p == m_end || !isDigit(*p)) {
+                return fail("Invalid number");
+            }
+            for (; p < m_end && isDigit(*p); ++p) {
+                if (digits++ < 18) {
+                    mantissa = mantissa * 10.0 + (*p - '0');
+                    --exponent;
+                }
+            }
+        }
+        if (p < m_end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            bool negativeExponent = false;
+            if (p < m_end && (*p == '-' || *p == '+')) {
+                negativeExponent = *p == '-';
+                ++p;
+            }
+            if (p == m_end || !isDigit(*p)) {
+                return fail("Invalid number");
+            }
+            int explicitExponent = 0;
+            for (; p < m_end && isDigit(*p); ++p) {
+                if (explicitExponent < 10000) {
+                    explicitExponent = explicitExponent * 10 + (*p - '0');
+                }
+            }
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+        }
+
+        if (exponent > 0) {
+            mantissa *= exponent <= 22 ? kPowersOfTen[exponent] : std::pow(10.0, exponent);
+        } else if (exponent < 0) {
+            mantissa /= -exponent <= 22 ? kPowersOfTen[-exponent] : std::pow(10.0, -exponent);
+        }
+        value = negative ? -mantissa : mantissa;
+        m_p = p;
+        return true;
+    }
+
+    const char* m_begin;
+    const char* m_p;
+    const char* m_end;
+    std::string m_error;
+};
+
+bool JsonValue::parse(const char* text, size_t size, JsonValue& value, std::string& error) {
+    value = JsonValue();
+    JsonReader reader(text, size);
+    return reader.read(value, error);
+}
+
+const JsonValue& JsonValue::at(size_t index) const {
+    if (m_type != Type::Array || index >= m_elements.size()) {
+        return nullValue();
+    }
+    return m_elements[index];
+}
+
+const JsonValue& JsonValue::operator[](const char* key) const {
+    if (m_type == Type::Object) {
+        for (const auto& member : m_members) {
+            if (member.first == key) {
+                return member.second;
+            }
+        }
+    }
+    return nullValue();
+}
+
+} // namespace RenderEngine
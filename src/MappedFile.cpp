@@ -0,0 +1,132 @@
+#include "MappedFile.h"
+#include <iostream>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace RenderEngine {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : m_data(nullptr), m_size(0), m_open(false), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr) {
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                         FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size)) {
+        std::cerr << "Failed to query file size: " << path << std::endl;
+        close();
+        return false;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    m_open = true;
+    if (m_size == 0) {
+        return true;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping) {
+        m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!m_data) {
+        std::cerr << "Failed to map file: " << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : m_data(nullptr), m_size(0), m_open(false) {
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        std::cerr << "Failed to query file size: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+    m_size = static_cast<size_t>(info.st_size);
+    m_open = true;
+
+    if (m_size > 0) {
+        void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Failed to map file: " << path << std::endl;
+            ::close(fd);
+            close();
+            return false;
+        }
+        // Parsers read front to back
+        madvise(mapping, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(mapping);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+} // namespace RenderEngine
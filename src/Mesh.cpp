@@ -1,99 +1,159 @@
 #include "Mesh.h"
+#include "StagedModel.h"
+#include "GLStateCache.h"
+#include <algorithm>
 #include <iostream>
 
 namespace RenderEngine {
 
-Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
-    : m_vertices(vertices), m_indices(indices), m_VAO(0), m_VBO(0), m_EBO(0) {
-    setupMesh();
-}
+unsigned int Mesh::s_drawCallCount = 0;
+unsigned int Mesh::s_nextId = 1;
 
-Mesh::~Mesh() {
-    if (m_VAO != 0) {
-        glDeleteVertexArrays(1, &m_VAO);
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices,
+           VertexPacking packing, bool optimize)
+    : m_packing(packing), m_positionTransform(1.0f), m_boundingRadius(0.0f), m_indexType(GL_UNSIGNED_INT)
+    , m_vertexCount(0), m_indexCount(0), m_vertexBytes(0), m_id(s_nextId++) {
+    for (const Vertex& vertex : vertices) {
+        m_boundingRadius = std::max(m_boundingRadius, glm::length(vertex.position));
     }
-    if (m_VBO != 0) {
-        glDeleteBuffers(1, &m_VBO);
-    }
-    if (m_EBO != 0) {
-        glDeleteBuffers(1, &m_EBO);
+    if (optimize) {
+        m_optimizationReport = MeshOptimizer::optimize(vertices, indices);
+    } else {
+        m_optimizationReport.before = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+        m_optimizationReport.after = m_optimizationReport.before;
     }
+    setupMesh(vertices, indices);
+}
+
+Mesh::Mesh(const VertexFormat& format, VertexPacking packing, const void* const* streams, size_t vertexCount,
+           const void* indices, size_t indexCount, GLenum indexType, const glm::mat4& positionTransform)
+    : m_packing(packing), m_positionTransform(positionTransform), m_boundingRadius(0.0f), m_indexType(indexType)
+    , m_vertexCount(vertexCount), m_indexCount(indexCount), m_vertexBytes(vertexCount * format.stride)
+    , m_id(s_nextId++) {
+    size_t indexSize = indexType == GL_UNSIGNED_BYTE ? 1 : indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+    upload(format, streams, indices, indexCount * indexSize);
+}
+
+Mesh::Mesh(const StagedMesh& staged)
+    : Mesh(staged.format, staged.packing, staged.streams, staged.vertexCount, staged.indices, staged.indexCount,
+           staged.indexType, staged.positionTransform) {
+    m_boundingRadius = staged.boundingRadius;
+}
+
+Mesh::~Mesh() {
+    releaseGeometry();
 }
 
 Mesh::Mesh(Mesh&& other) noexcept
-    : m_vertices(std::move(other.m_vertices))
-    , m_indices(std::move(other.m_indices))
-    , m_VAO(other.m_VAO)
-    , m_VBO(other.m_VBO)
-    , m_EBO(other.m_EBO) {
-    other.m_VAO = 0;
-    other.m_VBO = 0;
-    other.m_EBO = 0;
+    : m_packing(other.m_packing)
+    , m_positionTransform(other.m_positionTransform)
+    , m_boundingRadius(other.m_boundingRadius)
+    , m_indexType(other.m_indexType)
+    , m_vertexCount(other.m_vertexCount)
+    , m_indexCount(other.m_indexCount)
+    , m_vertexBytes(other.m_vertexBytes)
+    , m_optimizationReport(other.m_optimizationReport)
+    , m_allocation(other.m_allocation)
+    , m_id(other.m_id) {
+    other.m_allocation = GeometryAllocation();
 }
 
 Mesh& Mesh::operator=(Mesh&& other) noexcept {
     if (this != &other) {
-        if (m_VAO != 0) {
-            glDeleteVertexArrays(1, &m_VAO);
-        }
-        if (m_VBO != 0) {
-            glDeleteBuffers(1, &m_VBO);
-        }
-        if (m_EBO != 0) {
-            glDeleteBuffers(1, &m_EBO);
-        }
-
-        m_vertices = std::move(other.m_vertices);
-        m_indices = std::move(other.m_indices);
-        m_VAO = other.m_VAO;
-        m_VBO = other.m_VBO;
-        m_EBO = other.m_EBO;
-
-        other.m_VAO = 0;
-        other.m_VBO = 0;
-        other.m_EBO = 0;
+        releaseGeometry();
+
+        m_packing = other.m_packing;
+        m_positionTransform = other.m_positionTransform;
+        m_boundingRadius = other.m_boundingRadius;
+        m_indexType = other.m_indexType;
+        m_vertexCount = other.m_vertexCount;
+        m_indexCount = other.m_indexCount;
+        m_vertexBytes = other.m_vertexBytes;
+        m_optimizationReport = other.m_optimizationReport;
+        m_allocation = other.m_allocation;
+        m_id = other.m_id;
+
+        other.m_allocation = GeometryAllocation();
     }
     return *this;
 }
 
-void Mesh::setupMesh() {
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glGenBuffers(1, &m_EBO);
+void Mesh::setupMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    const VertexFormat& format = getVertexFormat(m_packing);
+    m_vertexCount = vertices.size();
+    m_indexCount = indices.size();
+    m_vertexBytes = vertices.size() * format.stride;
+
+    // Float vertices already have the GPU layout
+    std::vector<unsigned char> packed;
+    const void* stream = vertices.data();
+    if (m_packing != VertexPacking::Float) {
+        m_positionTransform = packVertices(vertices, m_packing, packed);
+        stream = packed.data();
+    }
 
-    glBindVertexArray(m_VAO);
+    if (MeshOptimizer::fitsShortIndices(vertices.size())) {
+        std::vector<std::uint16_t> shortIndices(indices.begin(), indices.end());
+        m_indexType = GL_UNSIGNED_SHORT;
+        upload(format, &stream, shortIndices.data(), shortIndices.size() * sizeof(std::uint16_t));
+    } else {
+        m_indexType = GL_UNSIGNED_INT;
+        upload(format, &stream, indices.data(), indices.size() * sizeof(unsigned int));
+    }
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(Vertex), 
-                 m_vertices.data(), GL_STATIC_DRAW);
+void Mesh::upload(const VertexFormat& format, const void* const* streams, const void* indices, size_t indexBytes) {
+    GeometryArena* arena = GeometryArena::current();
+    if (!arena) {
+        std::cerr << "Mesh created without a GeometryArena; create the Renderer first" << std::endl;
+        return;
+    }
+    m_allocation = arena->allocate(format, streams, m_vertexCount, indices, indexBytes);
+}
+
+void Mesh::releaseGeometry() {
+    GeometryArena* arena = GeometryArena::current();
+    if (arena && m_allocation.isValid()) {
+        arena->release(m_allocation);
+    }
+    m_allocation = GeometryAllocation();
+}
+
+unsigned int Mesh::getVAO() const {
+    GeometryArena* arena = GeometryArena::current();
+    return arena ? arena->getVertexArray(m_allocation) : 0;
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int),
-                 m_indices.data(), GL_STATIC_DRAW);
+size_t Mesh::getGeometryBytes() const {
+    size_t indexSize = m_indexType == GL_UNSIGNED_INT ? 4 : m_indexType == GL_UNSIGNED_SHORT ? 2 : 1;
+    return m_vertexBytes + m_indexCount * indexSize;
+}
 
-    // Position attribute
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                         (void*)offsetof(Vertex, position));
+void Mesh::draw() const {
+    if (!m_allocation.isValid()) return;
 
-    // Normal attribute
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                         (void*)offsetof(Vertex, normal));
+    // Meshes in the same arena page share the VAO, so runs of them skip the rebind
+    GLStateCache::current().bindVertexArray(getVAO());
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(m_indexCount), m_indexType,
+                             (void*)m_allocation.indexOffset, static_cast<GLint>(m_allocation.baseVertex));
+    s_drawCallCount++;
+}
 
-    // Texture coordinate attribute
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                         (void*)offsetof(Vertex, texCoords));
+void Mesh::drawInstanced(size_t instanceCount) const {
+    if (!m_allocation.isValid()) return;
 
-    glBindVertexArray(0);
+    GLStateCache::current().bindVertexArray(getVAO());
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(m_indexCount), m_indexType,
+                                      (void*)m_allocation.indexOffset, static_cast<GLsizei>(instanceCount),
+                                      static_cast<GLint>(m_allocation.baseVertex));
+    s_drawCallCount++;
 }
 
-void Mesh::draw() const {
-    glBindVertexArray(m_VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_indices.size()), 
-                   GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+void Mesh::bindInstanceBuffer(const InstanceBuffer& buffer, size_t firstInstance) const {
+    GeometryArena* arena = GeometryArena::current();
+    if (arena) {
+        arena->bindInstanceBuffer(m_allocation, buffer, firstInstance);
+    }
 }
 
 } // namespace RenderEngine
@@ -0,0 +1,394 @@
+#include "MeshOptimizer.h"
+#include "Vertex.h"
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+
+namespace RenderEngine {
+
+namespace {
+
+// Forsyth's tuning constants for an LRU cache of 32 entries
+constexpr size_t kCacheSize = 32;
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kLastTriangleScore = 0.75f;
+constexpr float kValenceBoostScale = 2.0f;
+constexpr float kValenceBoostPower = 0.5f;
+
+constexpr unsigned int kUnmapped = 0xFFFFFFFFu;
+
+float vertexScore(int cachePosition, unsigned int remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // The last triangle's vertices are penalized so the strip keeps moving
+            score = kLastTriangleScore;
+        } else {
+            float scale = 1.0f / static_cast<float>(kCacheSize - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, kCacheDecayPower);
+        }
+    }
+
+    // Vertices with few triangles left are finished first to avoid stranding them
+    score += kValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -kValenceBoostPower);
+    return score;
+}
+
+glm::vec3 triangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    return glm::cross(b - a, c - a);
+}
+
+} // namespace
+
+MeshOptimizationReport MeshOptimizer::optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    MeshOptimizationReport report;
+    report.before = analyzeVertexCache(indices, vertices.size());
+
+    optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices);
+
+    report.after = analyzeVertexCache(indices, vertices.size());
+    return report;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2 || vertexCount == 0) {
+        return;
+    }
+
+    // Triangle adjacency per vertex; the first remaining[v] entries of each
+    // vertex's range are the triangles not emitted yet
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        remaining[indices[i]]++;
+    }
+    std::vector<size_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+    }
+    std::vector<unsigned int> adjacency(adjacencyOffset[vertexCount]);
+    {
+        std::vector<size_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int corner = 0; corner < 3; ++corner) {
+                adjacency[fill[indices[t * 3 + corner]]++] = static_cast<unsigned int>(t);
+            }
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        scores[v] = vertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+    }
+
+    std::vector<unsigned int> output;
+    output.reserve(triangleCount * 3);
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> nextCache;
+    cache.reserve(kCacheSize + 3);
+    nextCache.reserve(kCacheSize + 3);
+
+    size_t best = static_cast<size_t>(std::max_element(triangleScores.begin(), triangleScores.end()) -
+                                      triangleScores.begin());
+    size_t fallback = 0;
+
+    while (output.size() < triangleCount * 3) {
+        if (best == triangleCount) {
+            // Nothing adjacent to the cache is left: continue with the next unused triangle
+            while (emitted[fallback]) {
+                ++fallback;
+            }
+            best = fallback;
+        }
+
+        const unsigned int* triangle = &indices[best * 3];
+        emitted[best] = true;
+        nextCache.assign(triangle, triangle + 3);
+        for (int corner = 0; corner < 3; ++corner) {
+            unsigned int v = triangle[corner];
+            output.push_back(v);
+
+            unsigned int* begin = &adjacency[adjacencyOffset[v]];
+            unsigned int* end = begin + remaining[v];
+            unsigned int* found = std::find(begin, end, static_cast<unsigned int>(best));
+            std::swap(*found, *(end - 1));
+            remaining[v]--;
+        }
+        for (unsigned int v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                nextCache.push_back(v);
+            }
+        }
+        cache.swap(nextCache);
+
+        // Rescore everything that moved within or fell out of the cache and
+        // pick the best triangle touching the cache for the next step
+        best = triangleCount;
+        float bestScore = -1.0f;
+        for (size_t i = 0; i < cache.size(); ++i) {
+            unsigned int v = cache[i];
+            cachePosition[v] = i < kCacheSize ? static_cast<int>(i) : -1;
+            float score = vertexScore(cachePosition[v], remaining[v]);
+            float delta = score - scores[v];
+            scores[v] = score;
+
+            const unsigned int* live = &adjacency[adjacencyOffset[v]];
+            for (unsigned int j = 0; j < remaining[v]; ++j) {
+                triangleScores[live[j]] += delta;
+            }
+        }
+        for (size_t i = 0; i < cache.size() && i < kCacheSize; ++i) {
+            unsigned int v = cache[i];
+            const unsigned int* live = &adjacency[adjacencyOffset[v]];
+            for (unsigned int j = 0; j < remaining[v]; ++j) {
+                if (triangleScores[live[j]] > bestScore) {
+                    bestScore = triangleScores[live[j]];
+                    best = live[j];
+                }
+            }
+        }
+        if (cache.size() > kCacheSize) {
+            cache.resize(kCacheSize);
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+                                     float threshold) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // Split where the cache starts over (all three vertices miss) as long as
+    // the cluster so far is about as cache efficient as the whole mesh
+    float meshAcmr = analyzeVertexCache(indices, vertices.size()).acmr;
+    std::vector<size_t> clusterStarts;
+    {
+        std::vector<size_t> stamps(vertices.size(), 0);
+        size_t time = kAnalysisCacheSize + 1;
+        size_t clusterMisses = 0;
+        size_t clusterTriangles = 0;
+
+        for (size_t t = 0; t < triangleCount; ++t) {
+            unsigned int misses = 0;
+            for (int corner = 0; corner < 3; ++corner) {
+                unsigned int v = indices[t * 3 + corner];
+                if (time - stamps[v] > kAnalysisCacheSize) {
+                    stamps[v] = time++;
+                    misses++;
+                }
+            }
+
+            if (clusterTriangles == 0 ||
+                (misses == 3 && static_cast<float>(clusterMisses) <= meshAcmr * threshold * clusterTriangles)) {
+                clusterStarts.push_back(t);
+                clusterMisses = 0;
+                clusterTriangles = 0;
+            }
+            clusterMisses += misses;
+            clusterTriangles++;
+        }
+    }
+    if (clusterStarts.size() < 2) {
+        return;
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // Area-weighted centroid of the mesh
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const glm::vec3& a = vertices[indices[t * 3]].position;
+        const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+        const glm::vec3& c = vertices[indices[t * 3 + 2]].position;
+        float area = glm::length(triangleNormal(a, b, c));
+        meshCenter += (a + b + c) * (area / 3.0f);
+        meshArea += area;
+    }
+    if (meshArea > 0.0f) {
+        meshCenter = meshCenter / meshArea;
+    }
+
+    // Clusters whose average normal points away from the center are on the
+    // outside of the mesh and likely to occlude the others
+    struct Cluster {
+        size_t begin;
+        size_t end;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+    clusters.reserve(clusterStarts.size() - 1);
+    for (size_t i = 0; i + 1 < clusterStarts.size(); ++i) {
+        glm::vec3 center(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusterStarts[i]; t < clusterStarts[i + 1]; ++t) {
+            const glm::vec3& a = vertices[indices[t * 3]].position;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& c = vertices[indices[t * 3 + 2]].position;
+            glm::vec3 n = triangleNormal(a, b, c);
+            float triangleArea = glm::length(n);
+            center += (a + b + c) * (triangleArea / 3.0f);
+            normal += n;
+            area += triangleArea;
+        }
+
+        float sortKey = 0.0f;
+        float normalLength = glm::length(normal);
+        if (area > 0.0f && normalLength > 0.0f) {
+            sortKey = glm::dot(center / area - meshCenter, normal / normalLength);
+        }
+        clusters.push_back({clusterStarts[i], clusterStarts[i + 1], sortKey});
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> reordered;
+    reordered.reserve(indices.size());
+    for (const Cluster& cluster : clusters) {
+        reordered.insert(reordered.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+    }
+    std::copy(reordered.begin(), reordered.end(), indices.begin());
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    std::vector<unsigned int> remap(vertices.size(), kUnmapped);
+    std::vector<unsigned int> order;
+    order.reserve(vertices.size());
+
+    for (unsigned int& index : indices) {
+        if (remap[index] == kUnmapped) {
+            remap[index] = static_cast<unsigned int>(order.size());
+            order.push_back(index);
+        }
+        index = remap[index];
+    }
+
+    std::vector<Vertex> reordered;
+    reordered.reserve(order.size());
+    for (unsigned int source : order) {
+        reordered.push_back(vertices[source]);
+    }
+    vertices.swap(reordered);
+}
+
+bool MeshOptimizer::simplify(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, float cellSize) {
+    if (vertices.empty() || cellSize <= 0.0f) {
+        return !indices.empty();
+    }
+
+    glm::vec3 boundsMin = vertices[0].position;
+    for (const Vertex& vertex : vertices) {
+        boundsMin = glm::min(boundsMin, vertex.position);
+    }
+
+    // 21 bits per axis keep the cell coordinates in one 64-bit key
+    struct Cluster {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec2 texCoords;
+        float weight;
+    };
+    std::unordered_map<std::uint64_t, unsigned int> cells;
+    std::vector<Cluster> clusters;
+    std::vector<unsigned int> remap(vertices.size());
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        const Vertex& vertex = vertices[v];
+        glm::vec3 cell = (vertex.position - boundsMin) / cellSize;
+        std::uint64_t key = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            std::uint64_t coordinate = static_cast<std::uint64_t>(std::min(cell[axis], 2097151.0f));
+            key = (key << 21) | coordinate;
+        }
+
+        auto inserted = cells.emplace(key, static_cast<unsigned int>(clusters.size()));
+        if (inserted.second) {
+            clusters.push_back({glm::vec3(0.0f), glm::vec3(0.0f), glm::vec2(0.0f), 0.0f});
+        }
+        Cluster& cluster = clusters[inserted.first->second];
+        cluster.position += vertex.position;
+        cluster.normal += vertex.normal;
+        cluster.texCoords += vertex.texCoords;
+        cluster.weight += 1.0f;
+        remap[v] = inserted.first->second;
+    }
+
+    size_t kept = 0;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        unsigned int a = remap[indices[t]];
+        unsigned int b = remap[indices[t + 1]];
+        unsigned int c = remap[indices[t + 2]];
+        if (a == b || b == c || a == c) continue;
+        indices[kept++] = a;
+        indices[kept++] = b;
+        indices[kept++] = c;
+    }
+    indices.resize(kept);
+
+    std::vector<Vertex> merged;
+    merged.reserve(clusters.size());
+    for (const Cluster& cluster : clusters) {
+        float length = glm::length(cluster.normal);
+        merged.emplace_back(cluster.position / cluster.weight,
+                            length > 0.0f ? cluster.normal / length : glm::vec3(0.0f, 1.0f, 0.0f),
+                            cluster.texCoords / cluster.weight);
+    }
+    vertices.swap(merged);
+
+    // Drops the clusters no remaining triangle uses
+    optimizeVertexFetch(vertices, indices);
+    return !indices.empty();
+}
+
+VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount,
+                                                   size_t cacheSize) {
+    VertexCacheStats stats;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) {
+        return stats;
+    }
+
+    // A vertex is cached while fewer than cacheSize misses happened since
+    // its own; the stamps start old enough to miss
+    std::vector<size_t> stamps(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    size_t time = cacheSize + 1;
+    size_t misses = 0;
+    size_t uniqueVertices = 0;
+
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        unsigned int v = indices[i];
+        if (!referenced[v]) {
+            referenced[v] = true;
+            uniqueVertices++;
+        }
+        if (time - stamps[v] > cacheSize) {
+            stamps[v] = time++;
+            misses++;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(uniqueVertices);
+    return stats;
+}
+
+} // namespace RenderEngine
@@ -1,29 +1,150 @@
 #include "Model.h"
 #include "Mesh.h"
+#include "StagedModel.h"
+#include "AllocationCounter.h"
+#include "AssetCache.h"
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <functional>
+#include <algorithm>
+#include <iostream>
 
 namespace RenderEngine {
 
-Model::Model() {
+namespace {
+
+// Largest silhouette deviation, in pixels, tolerated before a finer LOD is used
+constexpr float kLodMaxErrorPixels = 1.0f;
+
+std::shared_ptr<Mesh> createSphereMesh(int segments) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+
+    const float pi = 3.14159265358979323846f;
+    
+    for (int y = 0; y <= segments; ++y) {
+        for (int x = 0; x <= segments; ++x) {
+            float xSegment = (float)x / (float)segments;
+            float ySegment = (float)y / (float)segments;
+            float xPos = std::cos(xSegment * 2.0f * pi) * std::sin(ySegment * pi);
+            float yPos = std::cos(ySegment * pi);
+            float zPos = std::sin(xSegment * 2.0f * pi) * std::sin(ySegment * pi);
+
+            glm::vec3 position(xPos * 0.5f, yPos * 0.5f, zPos * 0.5f);
+            glm::vec3 normal = glm::normalize(position);
+            glm::vec2 texCoords(xSegment, ySegment);
+
+            vertices.emplace_back(position, normal, texCoords);
+        }
+    }
+
+    for (int y = 0; y < segments; ++y) {
+        for (int x = 0; x < segments; ++x) {
+            int first = y * (segments + 1) + x;
+            int second = first + segments + 1;
+
+            indices.push_back(first);
+            indices.push_back(second);
+            indices.push_back(first + 1);
+
+            indices.push_back(second);
+            indices.push_back(second + 1);
+            indices.push_back(first + 1);
+        }
+    }
+
+    return std::make_shared<Mesh>(std::move(vertices), std::move(indices));
 }
 
-void Model::addMesh(std::shared_ptr<Mesh> mesh) {
-    m_meshes.push_back(mesh);
+} // namespace
+
+Model::Model()
+    : m_lods(1)
+    , m_boundingRadius(0.0f) {
+}
+
+void Model::addMesh(std::shared_ptr<Mesh> mesh, size_t lod) {
+    if (lod >= m_lods.size()) {
+        m_lods.resize(lod + 1);
+    }
+    m_boundingRadius = std::max(m_boundingRadius, mesh->getBoundingRadius());
+    m_lods[lod].push_back(mesh);
+}
+
+size_t Model::getGeometryBytes() const {
+    size_t bytes = 0;
+    for (const auto& level : m_lods) {
+        for (const auto& mesh : level) {
+            bytes += mesh->getGeometryBytes();
+        }
+    }
+    return bytes;
+}
+
+bool Model::sharesGeometry() const {
+    for (const auto& level : m_lods) {
+        for (const auto& mesh : level) {
+            if (mesh.use_count() > 1) {
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
 void Model::draw(std::shared_ptr<Shader> shader) const {
-    for (const auto& mesh : m_meshes) {
+    for (const auto& mesh : m_lods[0]) {
         mesh->draw();
     }
 }
 
 void Model::draw() const {
-    for (const auto& mesh : m_meshes) {
+    for (const auto& mesh : m_lods[0]) {
         mesh->draw();
     }
 }
 
-std::shared_ptr<Model> Model::createCube() {
+void Model::drawInstanced(size_t instanceCount, size_t lod) const {
+    if (instanceCount == 0) return;
+
+    for (const auto& mesh : m_lods[lod]) {
+        mesh->drawInstanced(instanceCount);
+    }
+}
+
+void Model::bindInstanceBuffer(const InstanceBuffer& buffer, size_t lod) {
+    for (const auto& mesh : m_lods[lod]) {
+        mesh->bindInstanceBuffer(buffer);
+    }
+}
+
+size_t Model::selectLod(float screenRadius, size_t currentLod) const {
+    size_t lod = std::min(currentLod, m_lods.size() - 1);
+
+    // Refine only once the radius clearly exceeds the threshold and coarsen
+    // only once it is clearly below, so objects sitting near a boundary do
+    // not flip levels every frame
+    while (lod > 0 && lod - 1 < m_lodThresholds.size() &&
+           screenRadius >= m_lodThresholds[lod - 1] * (1.0f + kLodHysteresis)) {
+        --lod;
+    }
+    while (lod + 1 < m_lods.size() && lod < m_lodThresholds.size() &&
+           screenRadius < m_lodThresholds[lod] * (1.0f - kLodHysteresis)) {
+        ++lod;
+    }
+    return lod;
+}
+
+namespace {
+
+// Goes through the current AssetCache, if there is one
+std::shared_ptr<Model> getCached(const std::string& key, const std::function<std::shared_ptr<Model>()>& build) {
+    AssetCache* cache = AssetCache::current();
+    return cache ? cache->getOrCreate(key, build) : build();
+}
+
+std::shared_ptr<Model> buildCube() {
     auto model = std::make_shared<Model>();
     
     std::vector<Vertex> vertices = {
@@ -68,56 +189,31 @@ std::shared_ptr<Model> Model::createCube() {
         20, 21, 22, 22, 23, 20  // Left
     };
 
-    auto mesh = std::make_shared<Mesh>(vertices, indices);
+    auto mesh = std::make_shared<Mesh>(std::move(vertices), std::move(indices));
     model->addMesh(mesh);
     return model;
 }
 
-std::shared_ptr<Model> Model::createSphere(int segments) {
+std::shared_ptr<Model> buildSphere(int segments, int lodLevels) {
     auto model = std::make_shared<Model>();
-    
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
+    model->addMesh(createSphereMesh(segments));
 
+    // A level is good enough while its chords stay within
+    // kLodMaxErrorPixels of the true silhouette: the sagitta of a chord
+    // spanning pi / n radians is r * (1 - cos(pi / n))
     const float pi = 3.14159265358979323846f;
-    
-    for (int y = 0; y <= segments; ++y) {
-        for (int x = 0; x <= segments; ++x) {
-            float xSegment = (float)x / (float)segments;
-            float ySegment = (float)y / (float)segments;
-            float xPos = std::cos(xSegment * 2.0f * pi) * std::sin(ySegment * pi);
-            float yPos = std::cos(ySegment * pi);
-            float zPos = std::sin(xSegment * 2.0f * pi) * std::sin(ySegment * pi);
-
-            glm::vec3 position(xPos * 0.5f, yPos * 0.5f, zPos * 0.5f);
-            glm::vec3 normal = glm::normalize(position);
-            glm::vec2 texCoords(xSegment, ySegment);
-
-            vertices.emplace_back(position, normal, texCoords);
-        }
-    }
-
-    for (int y = 0; y < segments; ++y) {
-        for (int x = 0; x < segments; ++x) {
-            int first = y * (segments + 1) + x;
-            int second = first + segments + 1;
-
-            indices.push_back(first);
-            indices.push_back(second);
-            indices.push_back(first + 1);
-
-            indices.push_back(second);
-            indices.push_back(second + 1);
-            indices.push_back(first + 1);
-        }
+    std::vector<float> thresholds;
+    for (int lod = 1; lod < lodLevels && segments > 4; ++lod) {
+        segments = std::max(4, segments / 2);
+        model->addMesh(createSphereMesh(segments), lod);
+        thresholds.push_back(kLodMaxErrorPixels / (1.0f - std::cos(pi / segments)));
     }
+    model->setLodThresholds(thresholds);
 
-    auto mesh = std::make_shared<Mesh>(vertices, indices);
-    model->addMesh(mesh);
     return model;
 }
 
-std::shared_ptr<Model> Model::createPlane(float size) {
+std::shared_ptr<Model> buildPlane(float size) {
     auto model = std::make_shared<Model>();
     
     float halfSize = size * 0.5f;
@@ -134,10 +230,90 @@ std::shared_ptr<Model> Model::createPlane(float size) {
         2, 3, 0
     };
 
-    auto mesh = std::make_shared<Mesh>(vertices, indices);
+    auto mesh = std::make_shared<Mesh>(std::move(vertices), std::move(indices));
     model->addMesh(mesh);
     return model;
 }
 
-} // namespace RenderEngine
+// Uploads every mesh of an opened file, logging what loading cost
+std::shared_ptr<Model> buildStaged(StagedModel& staged, std::chrono::steady_clock::time_point start) {
+    std::string error;
+    if (!staged.stage(error)) {
+        std::cerr << "Failed to load " << staged.getPath() << ": " << error << std::endl;
+        return nullptr;
+    }
+    for (const auto& warning : staged.getWarnings()) {
+        std::cerr << staged.getPath() << ": skipped " << warning << std::endl;
+    }
+
+    auto model = std::make_shared<Model>();
+    size_t mappedMeshes = 0;
+    for (const StagedMesh& mesh : staged.getMeshes()) {
+        model->addMesh(std::make_shared<Mesh>(mesh), mesh.lod);
+        mappedMeshes += mesh.mapped ? 1 : 0;
+    }
+    model->setLodThresholds(staged.getLodThresholds());
+
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Loaded " << staged.getPath() << ": " << staged.getMeshes().size() << " meshes in "
+              << model->getLodCount() << " levels (" << mappedMeshes << " from the mapped file), "
+              << model->getGeometryBytes() / 1024 << " KB of geometry in " << milliseconds << " ms, peak RSS "
+              << AllocationCounter::getPeakResidentBytes() / (1024 * 1024) << " MB" << std::endl;
+    return model;
+}
+
+std::shared_ptr<Model> loadStaged(const std::string& path, ModelFileType type, VertexPacking packing) {
+    auto start = std::chrono::steady_clock::now();
+
+    StagedModel staged;
+    if (!staged.open(path, type, packing)) {
+        return nullptr;
+    }
+
+    AssetCache* cache = AssetCache::current();
+    if (!cache) {
+        return buildStaged(staged, start);
+    }
+    if (std::shared_ptr<Model> model = cache->findFile(staged.getFileKey())) {
+        return model;
+    }
+    // Unknown or changed file: hash it, since the content may still be cached
+    const std::string& key = staged.getContentKey();
+    std::shared_ptr<Model> model = cache->getOrCreate(key, [&]() { return buildStaged(staged, start); });
+    if (model) {
+        cache->addFileKey(staged.getFileKey(), key);
+    }
+    return model;
+}
 
+} // namespace
+
+std::shared_ptr<Model> Model::createCube() {
+    return getCached("cube", buildCube);
+}
+
+std::shared_ptr<Model> Model::createSphere(int segments, int lodLevels) {
+    std::string key = "sphere:" + std::to_string(segments) + ":" + std::to_string(lodLevels);
+    return getCached(key, [=]() { return buildSphere(segments, lodLevels); });
+}
+
+std::shared_ptr<Model> Model::createPlane(float size) {
+    // Enough digits to tell every float apart
+    char key[32];
+    std::snprintf(key, sizeof(key), "plane:%.9g", size);
+    return getCached(key, [=]() { return buildPlane(size); });
+}
+
+std::shared_ptr<Model> Model::loadOBJ(const std::string& path, VertexPacking packing) {
+    return loadStaged(path, ModelFileType::OBJ, packing);
+}
+
+std::shared_ptr<Model> Model::loadGLB(const std::string& path) {
+    return loadStaged(path, ModelFileType::GLB, VertexPacking::Float);
+}
+
+std::shared_ptr<Model> Model::loadCooked(const std::string& path) {
+    return loadStaged(path, ModelFileType::Cooked, VertexPacking::Float);
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,506 @@
+#include "ObjParser.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+namespace RenderEngine {
+
+namespace {
+
+constexpr int kAbsent = std::numeric_limits<int>::min();
+
+// Bits of Corner::relative: the index counts back from the chunk's own
+// element count and still needs the chunk's base added
+constexpr unsigned char kRelativePosition = 1;
+constexpr unsigned char kRelativeTexCoord = 2;
+constexpr unsigned char kRelativeNormal = 4;
+
+struct Corner {
+    int position;
+    int texCoord;
+    int normal;
+    unsigned char relative;
+};
+
+struct GroupStart {
+    size_t triangle;            // Chunk-local triangle index
+    const char* name;
+    size_t nameLength;
+};
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<Corner> corners;    // Three per triangle
+    std::vector<GroupStart> groups;
+    const char* errorAt = nullptr;
+    const char* errorMessage = nullptr;
+};
+
+const double kPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool isDigit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+const char* skipSpace(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// Decimal float without locale lookups; accumulates up to 19 significant
+// digits in an integer and scales once. Returns null if no number starts at p.
+const char* parseFloat(const char* p, const char* end, float& value) {
+    p = skipSpace(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    while (p < end && isDigit(*p)) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+            digits += mantissa != 0;
+        } else {
+            ++exponent;
+        }
+        any = true;
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && isDigit(*p)) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+                digits += mantissa != 0;
+                --exponent;
+            }
+            any = true;
+            ++p;
+        }
+    }
+    if (!any) {
+        return nullptr;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negativeExponent = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            negativeExponent = *q == '-';
+            ++q;
+        }
+        if (q < end && isDigit(*q)) {
+            int e = 0;
+            while (q < end && isDigit(*q)) {
+                e = std::min(e * 10 + (*q - '0'), 10000);
+                ++q;
+            }
+            exponent += negativeExponent ? -e : e;
+            p = q;
+        }
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (exponent > 0) {
+        result *= exponent <= 22 ? kPowersOfTen[exponent] : std::pow(10.0, exponent);
+    } else if (exponent < 0) {
+        result /= -exponent <= 22 ? kPowersOfTen[-exponent] : std::pow(10.0, -exponent);
+    }
+    value = static_cast<float>(negative ? -result : result);
+    return p;
+}
+
+const char* parseIndex(const char* p, const char* end, int& value) {
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        ++p;
+    }
+    if (p >= end || !isDigit(*p)) {
+        return nullptr;
+    }
+    long long result = 0;
+    while (p < end && isDigit(*p)) {
+        result = std::min(result * 10 + (*p - '0'), 0x7FFFFFFFll);
+        ++p;
+    }
+    value = static_cast<int>(negative ? -result : result);
+    return p;
+}
+
+// Converts a 1-based or negative OBJ index; count is the number of
+// elements defined so far in the chunk
+bool resolveLocal(int index, size_t count, unsigned char relativeBit, int& out, unsigned char& relative) {
+    if (index > 0) {
+        out = index - 1;
+        return true;
+    }
+    if (index < 0) {
+        out = static_cast<int>(count) + index;
+        relative |= relativeBit;
+        return true;
+    }
+    return false;
+}
+
+const char* parseFace(Chunk& chunk, const char* p, const char* end, std::vector<Corner>& polygon) {
+    polygon.clear();
+    while (true) {
+        p = skipSpace(p, end);
+        if (p >= end) break;
+
+        Corner corner = {kAbsent, kAbsent, kAbsent, 0};
+        int index;
+        p = parseIndex(p, end, index);
+        if (!p || !resolveLocal(index, chunk.positions.size(), kRelativePosition, corner.position, corner.relative)) {
+            return nullptr;
+        }
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/') {
+                p = parseIndex(p, end, index);
+                if (!p || !resolveLocal(index, chunk.texCoords.size(), kRelativeTexCoord,
+                                        corner.texCoord, corner.relative)) {
+                    return nullptr;
+                }
+            }
+            if (p < end && *p == '/') {
+                ++p;
+                p = parseIndex(p, end, index);
+                if (!p || !resolveLocal(index, chunk.normals.size(), kRelativeNormal,
+                                        corner.normal, corner.relative)) {
+                    return nullptr;
+                }
+            }
+        }
+        if (p < end && !isSpace(*p)) {
+            return nullptr;
+        }
+        polygon.push_back(corner);
+    }
+
+    if (polygon.size() < 3) {
+        return nullptr;
+    }
+    for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+        chunk.corners.push_back(polygon[0]);
+        chunk.corners.push_back(polygon[i]);
+        chunk.corners.push_back(polygon[i + 1]);
+    }
+    return p;
+}
+
+void parseChunk(Chunk& chunk) {
+    std::vector<Corner> polygon;
+    const char* p = chunk.begin;
+
+    while (p < chunk.end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+        if (!lineEnd) {
+            lineEnd = chunk.end;
+        }
+        const char* line = skipSpace(p, lineEnd);
+        size_t length = lineEnd - line;
+
+        if (length >= 2 && line[0] == 'v' && isSpace(line[1])) {
+            glm::vec3 position;
+            const char* q = parseFloat(line + 2, lineEnd, position.x);
+            q = q ? parseFloat(q, lineEnd, position.y) : nullptr;
+            q = q ? parseFloat(q, lineEnd, position.z) : nullptr;
+            if (!q) {
+                chunk.errorAt = line;
+                chunk.errorMessage = "Malformed vertex position";
+                return;
+            }
+            chunk.positions.push_back(position);
+        } else if (length >= 3 && line[0] == 'v' && line[1] == 'n' && isSpace(line[2])) {
+            glm::vec3 normal;
+            const char* q = parseFloat(line + 3, lineEnd, normal.x);
+            q = q ? parseFloat(q, lineEnd, normal.y) : nullptr;
+            q = q ? parseFloat(q, lineEnd, normal.z) : nullptr;
+            if (!q) {
+                chunk.errorAt = line;
+                chunk.errorMessage = "Malformed vertex normal";
+                return;
+            }
+            chunk.normals.push_back(normal);
+        } else if (length >= 3 && line[0] == 'v' && line[1] == 't' && isSpace(line[2])) {
+            glm::vec2 texCoords(0.0f);
+            const char* q = parseFloat(line + 3, lineEnd, texCoords.x);
+            if (!q) {
+                chunk.errorAt = line;
+                chunk.errorMessage = "Malformed texture coordinate";
+                return;
+            }
+            // The second coordinate is optional
+            parseFloat(q, lineEnd, texCoords.y);
+            chunk.texCoords.push_back(texCoords);
+        } else if (length >= 2 && line[0] == 'f' && isSpace(line[1])) {
+            if (!parseFace(chunk, line + 2, lineEnd, polygon)) {
+                chunk.errorAt = line;
+                chunk.errorMessage = "Malformed face";
+                return;
+            }
+        } else if (length >= 1 && (line[0] == 'o' || line[0] == 'g') && (length == 1 || isSpace(line[1]))) {
+            const char* name = skipSpace(line + 1, lineEnd);
+            const char* nameEnd = lineEnd;
+            while (nameEnd > name && isSpace(nameEnd[-1])) {
+                --nameEnd;
+            }
+            chunk.groups.push_back({chunk.corners.size() / 3, name, static_cast<size_t>(nameEnd - name)});
+        }
+
+        p = lineEnd + 1;
+    }
+}
+
+// Open-addressing map from position/texcoord/normal triplets to vertex
+// indices. Bumping the generation empties it without touching the slots.
+class CornerTable {
+public:
+    CornerTable() : m_mask(0), m_size(0), m_generation(1) {}
+
+    void clear() {
+        m_size = 0;
+        m_generation++;
+    }
+
+    // Returns the stored vertex index, or inserts next and returns it
+    unsigned int findOrInsert(const Corner& corner, unsigned int next) {
+        if ((m_size + 1) * 2 > m_slots.size()) {
+            grow();
+        }
+        size_t slot = hash(corner) & m_mask;
+        while (m_slots[slot].generation == m_generation) {
+            const Slot& existing = m_slots[slot];
+            if (existing.position == corner.position && existing.texCoord == corner.texCoord &&
+                existing.normal == corner.normal) {
+                return existing.vertex;
+            }
+            slot = (slot + 1) & m_mask;
+        }
+        m_slots[slot] = {corner.position, corner.texCoord, corner.normal, next, m_generation};
+        m_size++;
+        return next;
+    }
+
+private:
+    struct Slot {
+        int position;
+        int texCoord;
+        int normal;
+        unsigned int vertex;
+        unsigned int generation;
+    };
+
+    static size_t hash(const Corner& corner) {
+        std::uint64_t h = static_cast<std::uint32_t>(corner.position) * 0x9E3779B97F4A7C15ull;
+        h ^= static_cast<std::uint32_t>(corner.texCoord) * 0xC2B2AE3D27D4EB4Full;
+        h ^= static_cast<std::uint32_t>(corner.normal) * 0x165667B19E3779F9ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(m_slots);
+        m_slots.assign(std::max<size_t>(64, old.size() * 2), Slot{0, 0, 0, 0, 0});
+        m_mask = m_slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.generation != m_generation) continue;
+            size_t index = hash({slot.position, slot.texCoord, slot.normal, 0}) & m_mask;
+            while (m_slots[index].generation == m_generation) {
+                index = (index + 1) & m_mask;
+            }
+            m_slots[index] = slot;
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    size_t m_mask;
+    size_t m_size;
+    unsigned int m_generation;
+};
+
+} // namespace
+
+bool ObjParser::parse(const char* text, size_t size, std::vector<ObjGroup>& groups, std::string& error,
+                      unsigned int threadCount) {
+    groups.clear();
+    if (!text || size == 0) {
+        error = "File is empty";
+        return false;
+    }
+
+    // Split at line boundaries, at least kMinChunkBytes per chunk
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, size / kMinChunkBytes));
+    std::vector<Chunk> chunks(chunkCount);
+    const char* end = text + size;
+    const char* begin = text;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char* chunkEnd = i + 1 == chunkCount ? end : text + size / chunkCount * (i + 1);
+        if (chunkEnd < begin) {
+            chunkEnd = begin;
+        }
+        const char* newline = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+        chunkEnd = newline ? newline + 1 : end;
+        chunks[i].begin = begin;
+        chunks[i].end = chunkEnd;
+        begin = chunkEnd;
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunkCount; ++i) {
+        workers.emplace_back(parseChunk, std::ref(chunks[i]));
+    }
+    parseChunk(chunks[0]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (const Chunk& chunk : chunks) {
+        if (chunk.errorMessage) {
+            size_t line = 1 + std::count(text, chunk.errorAt, '\n');
+            error = std::string(chunk.errorMessage) + " on line " + std::to_string(line);
+            return false;
+        }
+    }
+
+    // Concatenate the attribute arrays and make every face index absolute
+    size_t positionCount = 0;
+    size_t texCoordCount = 0;
+    size_t normalCount = 0;
+    for (const Chunk& chunk : chunks) {
+        positionCount += chunk.positions.size();
+        texCoordCount += chunk.texCoords.size();
+        normalCount += chunk.normals.size();
+    }
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> normals;
+    positions.reserve(positionCount);
+    texCoords.reserve(texCoordCount);
+    normals.reserve(normalCount);
+
+    bool needsNormals = false;
+    for (Chunk& chunk : chunks) {
+        int positionBase = static_cast<int>(positions.size());
+        int texCoordBase = static_cast<int>(texCoords.size());
+        int normalBase = static_cast<int>(normals.size());
+
+        for (Corner& corner : chunk.corners) {
+            if (corner.relative & kRelativePosition) corner.position += positionBase;
+            if (corner.relative & kRelativeTexCoord) corner.texCoord += texCoordBase;
+            if (corner.relative & kRelativeNormal) corner.normal += normalBase;
+
+            if (corner.position < 0 || corner.position >= static_cast<int>(positionCount) ||
+                corner.texCoord >= static_cast<int>(texCoordCount) ||
+                corner.normal >= static_cast<int>(normalCount) ||
+                (corner.texCoord < 0 && corner.texCoord != kAbsent) ||
+                (corner.normal < 0 && corner.normal != kAbsent)) {
+                error = "Face index out of range";
+                return false;
+            }
+            needsNormals |= corner.normal == kAbsent;
+        }
+
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        std::vector<glm::vec3>().swap(chunk.positions);
+        std::vector<glm::vec2>().swap(chunk.texCoords);
+        std::vector<glm::vec3>().swap(chunk.normals);
+    }
+
+    // Smooth normals for faces that have none, weighted by triangle area
+    std::vector<glm::vec3> generatedNormals;
+    if (needsNormals) {
+        generatedNormals.assign(positions.size(), glm::vec3(0.0f));
+        for (const Chunk& chunk : chunks) {
+            for (size_t i = 0; i + 2 < chunk.corners.size(); i += 3) {
+                const Corner* triangle = &chunk.corners[i];
+                if (triangle[0].normal != kAbsent && triangle[1].normal != kAbsent &&
+                    triangle[2].normal != kAbsent) {
+                    continue;
+                }
+                const glm::vec3& a = positions[triangle[0].position];
+                glm::vec3 faceNormal = glm::cross(positions[triangle[1].position] - a,
+                                                  positions[triangle[2].position] - a);
+                for (int corner = 0; corner < 3; ++corner) {
+                    generatedNormals[triangle[corner].position] += faceNormal;
+                }
+            }
+        }
+        for (auto& normal : generatedNormals) {
+            float length = glm::length(normal);
+            normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+
+    // Merge identical corners into indexed vertices, one group at a time
+    CornerTable table;
+    groups.emplace_back();
+    for (const Chunk& chunk : chunks) {
+        size_t nextGroup = 0;
+        size_t triangleCount = chunk.corners.size() / 3;
+        for (size_t t = 0; t <= triangleCount; ++t) {
+            while (nextGroup < chunk.groups.size() && chunk.groups[nextGroup].triangle == t) {
+                const GroupStart& start = chunk.groups[nextGroup++];
+                if (!groups.back().indices.empty()) {
+                    groups.emplace_back();
+                    table.clear();
+                }
+                groups.back().name.assign(start.name, start.nameLength);
+            }
+            if (t == triangleCount) break;
+
+            ObjGroup& group = groups.back();
+            for (int c = 0; c < 3; ++c) {
+                const Corner& corner = chunk.corners[t * 3 + c];
+                unsigned int next = static_cast<unsigned int>(group.vertices.size());
+                unsigned int vertex = table.findOrInsert(corner, next);
+                if (vertex == next) {
+                    group.vertices.emplace_back(
+                        positions[corner.position],
+                        corner.normal != kAbsent ? normals[corner.normal] : generatedNormals[corner.position],
+                        corner.texCoord != kAbsent ? texCoords[corner.texCoord] : glm::vec2(0.0f));
+                }
+                group.indices.push_back(vertex);
+            }
+        }
+    }
+
+    if (groups.back().indices.empty()) {
+        groups.pop_back();
+    }
+    if (groups.empty()) {
+        error = "File contains no faces";
+        return false;
+    }
+    return true;
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,343 @@
+#include "Profiler.h"
+
+#ifdef RENDERENGINE_ENABLE_PROFILER
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace RenderEngine {
+
+namespace {
+
+constexpr std::uint32_t kRootPath = 0xFFFFFFFFu;
+constexpr int kMaxDepth = 64;
+constexpr size_t kRingCapacity = 1 << 14;
+
+// Log-spaced histogram from 1us to ~17min with ~4% wide buckets, used to
+// estimate percentiles with fixed memory regardless of session length
+constexpr int kHistogramBuckets = 512;
+constexpr double kHistogramMinMs = 0.001;
+constexpr double kHistogramGrowth = 1.04;
+
+std::uint64_t now() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+struct ZoneEvent {
+    std::uint32_t path;
+    const char* name;
+    std::uint64_t start;
+    std::uint64_t end;
+};
+
+/**
+ * Single-producer single-consumer ring owned by one thread; endFrame()
+ * is the only consumer.
+ */
+struct ThreadBuffer {
+    std::array<ZoneEvent, kRingCapacity> events;
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+    std::atomic<std::uint64_t> dropped{0};
+
+    // Only touched by the owning thread
+    std::uint32_t stack[kMaxDepth];
+    const char* names[kMaxDepth];
+    std::uint64_t starts[kMaxDepth];
+    int depth = 0;
+    std::unordered_map<std::uint64_t, std::uint32_t> pathCache;
+};
+
+struct PathInfo {
+    const char* name;
+    std::uint32_t parent;
+    int depth;
+};
+
+struct PathStats {
+    std::uint64_t frames = 0;
+    std::uint64_t calls = 0;
+    double total = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    std::array<std::uint32_t, kHistogramBuckets> histogram{};
+
+    // Accumulated during the current frame
+    double frameTime = 0.0;
+    std::uint32_t frameCalls = 0;
+    bool touched = false;
+};
+
+struct ProfilerState {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::vector<PathInfo> paths;
+    std::map<std::pair<std::uint32_t, std::string>, std::uint32_t> pathIds;
+
+    // Aggregation is only touched from endFrame()/recordSample() on the main thread
+    std::vector<PathStats> stats;
+    std::vector<std::uint32_t> touchedPaths;
+    std::uint64_t frameCount = 0;
+};
+
+ProfilerState& state() {
+    static ProfilerState instance;
+    return instance;
+}
+
+ThreadBuffer& threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto created = std::make_shared<ThreadBuffer>();
+        ProfilerState& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.buffers.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+std::uint32_t internPath(std::uint32_t parent, const char* name) {
+    ProfilerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto key = std::make_pair(parent, std::string(name));
+    auto it = s.pathIds.find(key);
+    if (it != s.pathIds.end()) {
+        return it->second;
+    }
+
+    int depth = parent == kRootPath ? 0 : s.paths[parent].depth + 1;
+    std::uint32_t id = static_cast<std::uint32_t>(s.paths.size());
+    s.paths.push_back(PathInfo{ name, parent, depth });
+    s.pathIds.emplace(std::move(key), id);
+    return id;
+}
+
+std::uint32_t lookupPath(ThreadBuffer& buffer, std::uint32_t parent, const char* name) {
+    // Names are string literals, so the pointer is a stable per-thread cache key
+    std::uint64_t key = (static_cast<std::uint64_t>(parent) << 32)
+                      ^ static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(name));
+    auto it = buffer.pathCache.find(key);
+    if (it != buffer.pathCache.end()) {
+        return it->second;
+    }
+    std::uint32_t id = internPath(parent, name);
+    buffer.pathCache.emplace(key, id);
+    return id;
+}
+
+int histogramBucket(double milliseconds) {
+    if (milliseconds <= kHistogramMinMs) {
+        return 0;
+    }
+    int bucket = static_cast<int>(std::log(milliseconds / kHistogramMinMs) / std::log(kHistogramGrowth)) + 1;
+    return bucket < kHistogramBuckets ? bucket : kHistogramBuckets - 1;
+}
+
+double histogramValue(int bucket) {
+    return kHistogramMinMs * std::pow(kHistogramGrowth, bucket);
+}
+
+double percentile(const PathStats& stats, double fraction) {
+    std::uint64_t target = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(stats.frames)));
+    std::uint64_t seen = 0;
+    for (int i = 0; i < kHistogramBuckets; ++i) {
+        seen += stats.histogram[i];
+        if (seen >= target) {
+            double value = histogramValue(i);
+            return value < stats.max ? value : stats.max;
+        }
+    }
+    return stats.max;
+}
+
+PathStats& statsFor(ProfilerState& s, std::uint32_t path) {
+    if (path >= s.stats.size()) {
+        s.stats.resize(path + 1);
+    }
+    PathStats& stats = s.stats[path];
+    if (!stats.touched) {
+        stats.touched = true;
+        s.touchedPaths.push_back(path);
+    }
+    return stats;
+}
+
+void printPath(std::ostream& out, const ProfilerState& s, std::uint32_t path,
+               const std::vector<std::vector<std::uint32_t>>& children) {
+    const PathInfo& info = s.paths[path];
+    if (path < s.stats.size() && s.stats[path].frames > 0) {
+        const PathStats& stats = s.stats[path];
+        std::string label = std::string(static_cast<size_t>(info.depth) * 2, ' ') + info.name;
+        out << std::left << std::setw(36) << label << std::right
+            << std::setw(10) << static_cast<double>(stats.calls) / static_cast<double>(stats.frames)
+            << std::setw(10) << stats.min
+            << std::setw(10) << stats.total / static_cast<double>(stats.frames)
+            << std::setw(10) << percentile(stats, 0.99)
+            << std::setw(10) << stats.max << '\n';
+    }
+    for (std::uint32_t child : children[path]) {
+        printPath(out, s, child, children);
+    }
+}
+
+} // namespace
+
+void Profiler::beginZone(const char* name) {
+    ThreadBuffer& buffer = threadBuffer();
+    if (buffer.depth >= kMaxDepth) {
+        buffer.depth++;
+        return;
+    }
+
+    std::uint32_t parent = buffer.depth > 0 ? buffer.stack[buffer.depth - 1] : kRootPath;
+    buffer.stack[buffer.depth] = lookupPath(buffer, parent, name);
+    buffer.names[buffer.depth] = name;
+    buffer.starts[buffer.depth] = now();
+    buffer.depth++;
+}
+
+void Profiler::endZone() {
+    std::uint64_t end = now();
+    ThreadBuffer& buffer = threadBuffer();
+    buffer.depth--;
+    if (buffer.depth >= kMaxDepth || buffer.depth < 0) {
+        return;
+    }
+
+    size_t head = buffer.head.load(std::memory_order_relaxed);
+    size_t tail = buffer.tail.load(std::memory_order_acquire);
+    if (head - tail >= kRingCapacity) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.events[head % kRingCapacity] = ZoneEvent{
+        buffer.stack[buffer.depth], buffer.names[buffer.depth], buffer.starts[buffer.depth], end };
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::endFrame() {
+    ProfilerState& s = state();
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        buffers = s.buffers;
+    }
+
+    for (const auto& buffer : buffers) {
+        size_t tail = buffer->tail.load(std::memory_order_relaxed);
+        size_t head = buffer->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const ZoneEvent& event = buffer->events[tail % kRingCapacity];
+
+            PathStats& stats = statsFor(s, event.path);
+            stats.frameTime += static_cast<double>(event.end - event.start) * 1e-6;
+            stats.frameCalls++;
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+    }
+
+    // Fold this frame's per-path totals into the running statistics
+    for (std::uint32_t path : s.touchedPaths) {
+        PathStats& stats = s.stats[path];
+        double value = stats.frameTime;
+        stats.min = stats.frames == 0 ? value : (value < stats.min ? value : stats.min);
+        stats.max = stats.frames == 0 ? value : (value > stats.max ? value : stats.max);
+        stats.total += value;
+        stats.calls += stats.frameCalls;
+        stats.frames++;
+        stats.histogram[histogramBucket(value)]++;
+
+        stats.frameTime = 0.0;
+        stats.frameCalls = 0;
+        stats.touched = false;
+    }
+    s.touchedPaths.clear();
+    s.frameCount++;
+}
+
+void Profiler::recordSample(const char* name, double milliseconds) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::uint32_t path = lookupPath(buffer, kRootPath, name);
+    PathStats& stats = statsFor(state(), path);
+    stats.frameTime += milliseconds;
+    stats.frameCalls++;
+}
+
+void Profiler::printReport(std::ostream& out) {
+    ProfilerState& s = state();
+
+    std::vector<std::vector<std::uint32_t>> children;
+    std::vector<std::uint32_t> roots;
+    std::uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        children.resize(s.paths.size());
+        for (std::uint32_t i = 0; i < s.paths.size(); ++i) {
+            if (s.paths[i].parent == kRootPath) {
+                roots.push_back(i);
+            } else {
+                children[s.paths[i].parent].push_back(i);
+            }
+        }
+        for (const auto& buffer : s.buffers) {
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+    }
+
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << "\n=== Profiler (" << s.frameCount << " frames, times in ms per frame) ===\n";
+    out << std::left << std::setw(36) << "Zone" << std::right
+        << std::setw(10) << "calls" << std::setw(10) << "min" << std::setw(10) << "avg"
+        << std::setw(10) << "p99" << std::setw(10) << "max" << '\n';
+    out << std::fixed << std::setprecision(3);
+    for (std::uint32_t root : roots) {
+        printPath(out, s, root, children);
+    }
+    if (dropped > 0) {
+        out << "(" << dropped << " zone events dropped: ring buffer full)\n";
+    }
+    out << std::flush;
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void Profiler::reset() {
+    ProfilerState& s = state();
+    s.stats.clear();
+    s.touchedPaths.clear();
+    s.frameCount = 0;
+}
+
+} // namespace RenderEngine
+
+#else
+
+namespace RenderEngine {
+
+void Profiler::beginZone(const char*) {}
+void Profiler::endZone() {}
+void Profiler::endFrame() {}
+void Profiler::recordSample(const char*, double) {}
+void Profiler::printReport(std::ostream&) {}
+void Profiler::reset() {}
+
+} // namespace RenderEngine
+
+#endif
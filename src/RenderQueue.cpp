@@ -0,0 +1,172 @@
+#include "RenderQueue.h"
+#include "Shader.h"
+#include "Mesh.h"
+#include "Profiler.h"
+#include <cstring>
+#include <utility>
+
+namespace RenderEngine {
+
+namespace {
+
+// Key layout, most significant bit first:
+//   opaque:      0 | program:10 | mesh:16 | material:13 | depth:24
+//   transparent: 1 | ~depth:24  | program:10 | mesh:16 | material:13
+// Ids are truncated program names, mesh ids and per-flush material indices;
+// truncation only costs batching opportunities, never correctness, as runs are
+// formed by comparing the packets themselves.
+constexpr uint64_t kProgramMask = 0x3FF;
+constexpr uint64_t kMeshMask = 0xFFFF;
+constexpr uint64_t kMaterialMask = 0x1FFF;
+constexpr uint64_t kDepthMask = 0xFFFFFF;
+
+// The bit pattern of a non-negative float orders like its value, so the
+// top 24 bits of it are a monotonic depth key
+uint64_t depthBits(float depth) {
+    if (!(depth > 0.0f)) {
+        return 0;
+    }
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return (bits >> 8) & kDepthMask;
+}
+
+constexpr uint32_t kObjectColorUniform = hashUniformName("objectColor");
+constexpr uint32_t kShininessUniform = hashUniformName("shininess");
+
+bool canBatch(const DrawPacket& a, const DrawPacket& b) {
+    return a.shader == b.shader && a.mesh == b.mesh &&
+           a.transparent == b.transparent && a.material == b.material;
+}
+
+} // namespace
+
+RenderQueue::RenderQueue()
+    : m_transformBuffer(sizeof(glm::mat4), {
+          {kInstanceTransformLocation + 0, 4, 0 * sizeof(glm::vec4)},
+          {kInstanceTransformLocation + 1, 4, 1 * sizeof(glm::vec4)},
+          {kInstanceTransformLocation + 2, 4, 2 * sizeof(glm::vec4)},
+          {kInstanceTransformLocation + 3, 4, 3 * sizeof(glm::vec4)}
+      })
+    , m_batchCount(0)
+    , m_packetCount(0) {
+}
+
+void RenderQueue::submit(const DrawPacket& packet) {
+    if (!packet.shader || !packet.mesh) {
+        return;
+    }
+    m_entries.push_back({makeKey(packet), static_cast<uint32_t>(m_packets.size())});
+    m_packets.push_back(packet);
+}
+
+void RenderQueue::flush() {
+    if (m_packets.empty()) {
+        return;
+    }
+    PROFILE_SCOPE("RenderQueue::flush");
+
+    sortEntries();
+
+    // One upload for the whole queue; runs index into it by offset
+    m_transforms.clear();
+    for (const SortEntry& entry : m_entries) {
+        const DrawPacket& packet = m_packets[entry.index];
+        if (packet.mesh->getPacking() == VertexPacking::Quantized) {
+            m_transforms.push_back(packet.transform * packet.mesh->getPositionTransform());
+        } else {
+            m_transforms.push_back(packet.transform);
+        }
+    }
+    m_transformBuffer.upload(m_transforms.data(), m_transforms.size());
+
+    const Shader* shader = nullptr;
+    const Material* material = nullptr;
+    UniformHandle<glm::vec3> colorUniform;
+    UniformHandle<float> shininessUniform;
+
+    size_t first = 0;
+    while (first < m_entries.size()) {
+        const DrawPacket& packet = m_packets[m_entries[first].index];
+        size_t last = first + 1;
+        while (last < m_entries.size() && canBatch(packet, m_packets[m_entries[last].index])) {
+            ++last;
+        }
+
+        if (packet.shader != shader) {
+            shader = packet.shader;
+            shader->use();
+            colorUniform = shader->getUniform<glm::vec3>(kObjectColorUniform);
+            shininessUniform = shader->getUniform<float>(kShininessUniform);
+            material = nullptr;
+        }
+        if (!material || !(*material == packet.material)) {
+            material = &packet.material;
+            shader->set(colorUniform, material->color);
+            shader->set(shininessUniform, material->shininess);
+        }
+
+        packet.mesh->bindInstanceBuffer(m_transformBuffer, first);
+        packet.mesh->drawInstanced(last - first);
+        m_batchCount++;
+        first = last;
+    }
+
+    m_packetCount += static_cast<unsigned int>(m_packets.size());
+    m_packets.clear();
+    m_entries.clear();
+    m_materials.clear();
+}
+
+uint64_t RenderQueue::makeKey(const DrawPacket& packet) {
+    uint64_t program = packet.shader->getId() & kProgramMask;
+    uint64_t mesh = packet.mesh->getId() & kMeshMask;
+    uint64_t material = getMaterialIndex(packet.material) & kMaterialMask;
+    uint64_t depth = depthBits(packet.depth);
+
+    if (packet.transparent) {
+        return (1ull << 63) | ((~depth & kDepthMask) << 39) | (program << 29) | (mesh << 13) | material;
+    }
+    return (program << 53) | (mesh << 37) | (material << 24) | depth;
+}
+
+uint32_t RenderQueue::getMaterialIndex(const Material& material) {
+    // Scenes use a handful of materials, and consecutive submits usually
+    // share one, so search from the most recently added
+    for (size_t i = m_materials.size(); i-- > 0;) {
+        if (m_materials[i] == material) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    m_materials.push_back(material);
+    return static_cast<uint32_t>(m_materials.size() - 1);
+}
+
+void RenderQueue::sortEntries() {
+    // Stable LSD radix sort on 8-bit digits; digits that are identical
+    // across all keys (common for the high id bits) are skipped
+    m_scratch.resize(m_entries.size());
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {};
+        for (const SortEntry& entry : m_entries) {
+            counts[(entry.key >> shift) & 0xFF]++;
+        }
+        if (counts[(m_entries[0].key >> shift) & 0xFF] == m_entries.size()) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t& count : counts) {
+            size_t bucketSize = count;
+            count = offset;
+            offset += bucketSize;
+        }
+        for (const SortEntry& entry : m_entries) {
+            m_scratch[counts[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        std::swap(m_entries, m_scratch);
+    }
+}
+
+} // namespace RenderEngine
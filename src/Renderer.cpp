@@ -2,50 +2,55 @@
 #include "Shader.h"
 #include "Mesh.h"
 #include "Model.h"
+#include "GpuTimer.h"
+#include "Profiler.h"
+#include "Tracer.h"
 #include <iostream>
 
 namespace RenderEngine {
 
-Renderer::Renderer() {
-    // Create default shader with embedded source
-    m_defaultShader = std::make_shared<Shader>();
-    
-    const std::string vertexSource = R"(
-#version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
+Renderer::Renderer()
+    : m_gpuTimer(std::make_unique<GpuTimer>())
+    , m_frameUBO(0)
+    , m_frameUniformsDirty(true) {
+    m_stateCache.makeCurrent();
+    m_geometryArena.makeCurrent();
+    m_assetCache.makeCurrent();
+
+    // Per-frame uniform buffer, bound once for the lifetime of the context
+    glGenBuffers(1, &m_frameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameUniformsBinding, m_frameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Create default shaders with embedded source, one per vertex input layout
+    const std::string vertexBody = R"(
+layout (location = 5) in mat4 aModel;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    TexCoord = aTexCoord;
+    FragPos = vec3(aModel * vec4(vertexPosition(), 1.0));
+    Normal = mat3(transpose(inverse(aModel))) * vertexNormal();
+    TexCoord = vertexTexCoords();
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
 )";
 
-    const std::string fragmentSource = R"(
+    const std::string fragmentSource = std::string(R"(
 #version 330 core
+)") + kFrameUniformsGLSL + R"(
 out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
 
-uniform vec3 viewPos;
 uniform vec3 objectColor;
-uniform vec3 lightPos;
-uniform vec3 lightColor;
 uniform float shininess;
-uniform float time;
 
 void main() {
     // Ambient
@@ -78,87 +83,175 @@ void main() {
 }
 )";
 
-    if (!m_defaultShader->loadFromSource(vertexSource, fragmentSource)) {
-        std::cerr << "Failed to create default shader" << std::endl;
+    for (VertexPacking packing : {VertexPacking::Float, VertexPacking::Compact}) {
+        auto shader = std::make_shared<Shader>();
+        const std::string vertexSource = std::string("\n#version 330 core\n") + kFrameUniformsGLSL +
+                                         getVertexInputGLSL(packing) + vertexBody;
+        if (!shader->loadFromSource(vertexSource, fragmentSource)) {
+            std::cerr << "Failed to create default shader" << std::endl;
+        }
+        m_defaultShaders[static_cast<size_t>(packing)] = shader;
     }
+    // Compact and quantized vertices share their shader inputs
+    m_defaultShaders[static_cast<size_t>(VertexPacking::Quantized)] =
+        m_defaultShaders[static_cast<size_t>(VertexPacking::Compact)];
 
     enableDepthTest(true);
     setClearColor(0.1f, 0.1f, 0.15f, 1.0f);
 }
 
 Renderer::~Renderer() {
+    if (m_frameUBO != 0) {
+        glDeleteBuffers(1, &m_frameUBO);
+    }
 }
 
 void Renderer::beginFrame() {
+    PROFILE_SCOPE("Renderer::beginFrame");
+
     // Frame setup is handled by Window::clear()
+    Mesh::resetDrawCallCount();
+    m_stateCache.resetStats();
+    m_renderQueue.resetStats();
+    m_gpuTimer->beginFrame();
+
+    // Results resolved this frame belong to a frame kFrameLatency back
+    if (m_gpuTimer->hasNewResults()) {
+        for (const auto& pass : m_gpuTimer->getResults()) {
+            PROFILE_SAMPLE(pass.name, pass.milliseconds);
+            Tracer::counter(pass.name, pass.milliseconds);
+        }
+    }
 }
 
 void Renderer::endFrame() {
-    // Frame cleanup if needed
+    PROFILE_SCOPE("Renderer::endFrame");
+
+    flush();
+    m_gpuTimer->endPass();
+    m_frameStats.drawCalls = Mesh::getDrawCallCount();
+    m_frameStats.queuedPackets = m_renderQueue.getPacketCount();
+    m_frameStats.queueBatches = m_renderQueue.getBatchCount();
+    m_frameStats.stateCalls = m_stateCache.getStats();
+
+    // Releases cached models dropped during the frame if over budget
+    m_assetCache.trim();
+}
+
+void Renderer::beginPass(const char* name) {
+    m_gpuTimer->beginPass(name);
+}
+
+void Renderer::endPass() {
+    m_gpuTimer->endPass();
+}
+
+const std::vector<GpuPassTiming>& Renderer::getGpuPassTimings() const {
+    return m_gpuTimer->getResults();
 }
 
 void Renderer::setViewMatrix(const glm::mat4& view) {
-    m_viewMatrix = view;
+    m_frameUniforms.view = view;
+    m_frameUniformsDirty = true;
 }
 
 void Renderer::setProjectionMatrix(const glm::mat4& projection) {
-    m_projectionMatrix = projection;
+    m_frameUniforms.projection = projection;
+    m_frameUniformsDirty = true;
 }
 
 void Renderer::setViewPosition(const glm::vec3& position) {
-    m_viewPosition = position;
+    m_frameUniforms.viewPos = position;
+    m_frameUniformsDirty = true;
+}
+
+void Renderer::setLight(const glm::vec3& position, const glm::vec3& color) {
+    m_frameUniforms.lightPos = position;
+    m_frameUniforms.lightColor = color;
+    m_frameUniformsDirty = true;
+}
+
+void Renderer::setTime(float time) {
+    m_frameUniforms.time = time;
+    m_frameUniformsDirty = true;
+}
+
+void Renderer::updateFrameUniforms() {
+    if (!m_frameUniformsDirty) {
+        return;
+    }
+
+    // Orphan so the upload never waits on draws still reading last frame's block
+    glBindBuffer(GL_UNIFORM_BUFFER, m_frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &m_frameUniforms);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    m_frameUniformsDirty = false;
+}
+
+void Renderer::submit(const DrawPacket& packet) {
+    m_renderQueue.submit(packet);
 }
 
 void Renderer::drawMesh(const Mesh& mesh, const glm::mat4& model) {
-    m_defaultShader->use();
-    m_defaultShader->setMat4("model", model);
-    m_defaultShader->setMat4("view", m_viewMatrix);
-    m_defaultShader->setMat4("projection", m_projectionMatrix);
-    m_defaultShader->setVec3("viewPos", m_viewPosition);
-    
-    // Default lighting
-    m_defaultShader->setVec3("lightPos", glm::vec3(5.0f, 10.0f, 5.0f));
-    m_defaultShader->setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
-    m_defaultShader->setFloat("shininess", 32.0f);
-    m_defaultShader->setVec3("objectColor", glm::vec3(0.8f, 0.8f, 0.8f));
-    
-    mesh.draw();
+    DrawPacket packet;
+    packet.shader = &getDefaultShader(mesh.getPacking());
+    packet.mesh = &mesh;
+    packet.transform = model;
+    packet.depth = getViewDepth(model);
+    m_renderQueue.submit(packet);
 }
 
 void Renderer::drawModel(const Model& model, const glm::mat4& modelMatrix) {
-    m_defaultShader->use();
-    m_defaultShader->setMat4("model", modelMatrix);
-    m_defaultShader->setMat4("view", m_viewMatrix);
-    m_defaultShader->setMat4("projection", m_projectionMatrix);
-    m_defaultShader->setVec3("viewPos", m_viewPosition);
-    
-    // Default lighting
-    m_defaultShader->setVec3("lightPos", glm::vec3(5.0f, 10.0f, 5.0f));
-    m_defaultShader->setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
-    m_defaultShader->setFloat("shininess", 32.0f);
-    m_defaultShader->setVec3("objectColor", glm::vec3(0.8f, 0.8f, 0.8f));
-    
-    model.draw();
+    DrawPacket packet;
+    packet.transform = modelMatrix;
+    packet.depth = getViewDepth(modelMatrix);
+    for (const auto& mesh : model.getMeshes()) {
+        packet.shader = &getDefaultShader(mesh->getPacking());
+        packet.mesh = mesh.get();
+        m_renderQueue.submit(packet);
+    }
 }
 
-void Renderer::enableDepthTest(bool enable) {
-    if (enable) {
-        glEnable(GL_DEPTH_TEST);
-    } else {
-        glDisable(GL_DEPTH_TEST);
+const Shader& Renderer::getDefaultShader(VertexPacking packing) const {
+    return *m_defaultShaders[static_cast<size_t>(packing)];
+}
+
+void Renderer::drawModel(const Model& model, const glm::mat4& modelMatrix, const Shader& shader,
+                         const Material& material, bool transparent) {
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.material = material;
+    packet.transform = modelMatrix;
+    packet.depth = getViewDepth(modelMatrix);
+    packet.transparent = transparent;
+    for (const auto& mesh : model.getMeshes()) {
+        packet.mesh = mesh.get();
+        m_renderQueue.submit(packet);
     }
 }
 
+void Renderer::flush() {
+    updateFrameUniforms();
+    m_renderQueue.flush();
+}
+
+float Renderer::getViewDepth(const glm::mat4& transform) const {
+    // Distance along the view direction of the object's origin
+    glm::vec4 viewPosition = m_frameUniforms.view * transform[3];
+    return -viewPosition.z;
+}
+
+void Renderer::enableDepthTest(bool enable) {
+    m_stateCache.setDepthTest(enable);
+}
+
 void Renderer::enableBlending(bool enable) {
-    if (enable) {
-        glEnable(GL_BLEND);
-    } else {
-        glDisable(GL_BLEND);
-    }
+    m_stateCache.setBlending(enable);
 }
 
 void Renderer::setClearColor(float r, float g, float b, float a) {
-    glClearColor(r, g, b, a);
+    m_stateCache.setClearColor(glm::vec4(r, g, b, a));
 }
 
 } // namespace RenderEngine
@@ -1,4 +1,7 @@
 #include "Shader.h"
+#include "FrameUniforms.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -10,20 +13,25 @@ Shader::Shader() : m_id(0) {
 
 Shader::~Shader() {
     if (m_id != 0) {
+        GLStateCache::current().forgetProgram(m_id);
         glDeleteProgram(m_id);
     }
 }
 
-Shader::Shader(Shader&& other) noexcept : m_id(other.m_id) {
+Shader::Shader(Shader&& other) noexcept
+    : m_id(other.m_id)
+    , m_uniforms(std::move(other.m_uniforms)) {
     other.m_id = 0;
 }
 
 Shader& Shader::operator=(Shader&& other) noexcept {
     if (this != &other) {
         if (m_id != 0) {
+            GLStateCache::current().forgetProgram(m_id);
             glDeleteProgram(m_id);
         }
         m_id = other.m_id;
+        m_uniforms = std::move(other.m_uniforms);
         other.m_id = 0;
     }
     return *this;
@@ -41,6 +49,8 @@ bool Shader::loadFromFiles(const std::string& vertexPath, const std::string& fra
 }
 
 bool Shader::loadFromSource(const std::string& vertexSource, const std::string& fragmentSource) {
+    PROFILE_SCOPE("Shader::loadFromSource");
+
     unsigned int vertex, fragment;
     
     // Compile vertex shader
@@ -70,12 +80,56 @@ bool Shader::loadFromSource(const std::string& vertexSource, const std::string&
     // Clean up
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    // Programs sharing the per-frame block all read the Renderer's buffer
+    bindUniformBlock(kFrameUniformsBlockName, kFrameUniformsBinding);
+    if (!reflectUniforms()) {
+        glDeleteProgram(m_id);
+        m_id = 0;
+        return false;
+    }
     
     return true;
 }
 
 void Shader::use() const {
-    glUseProgram(m_id);
+    GLStateCache::current().useProgram(m_id);
+}
+
+void Shader::set(UniformHandle<bool> handle, bool value) const {
+    glUniform1i(handle.location, (int)value);
+}
+
+void Shader::set(UniformHandle<int> handle, int value) const {
+    glUniform1i(handle.location, value);
+}
+
+void Shader::set(UniformHandle<float> handle, float value) const {
+    glUniform1f(handle.location, value);
+}
+
+void Shader::set(UniformHandle<glm::vec2> handle, const glm::vec2& value) const {
+    glUniform2fv(handle.location, 1, &value[0]);
+}
+
+void Shader::set(UniformHandle<glm::vec3> handle, const glm::vec3& value) const {
+    glUniform3fv(handle.location, 1, &value[0]);
+}
+
+void Shader::set(UniformHandle<glm::vec4> handle, const glm::vec4& value) const {
+    glUniform4fv(handle.location, 1, &value[0]);
+}
+
+void Shader::set(UniformHandle<glm::mat2> handle, const glm::mat2& value) const {
+    glUniformMatrix2fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::set(UniformHandle<glm::mat3> handle, const glm::mat3& value) const {
+    glUniformMatrix3fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::set(UniformHandle<glm::mat4> handle, const glm::mat4& value) const {
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
 void Shader::setBool(const std::string& name, bool value) const {
@@ -114,6 +168,13 @@ void Shader::setMat4(const std::string& name, const glm::mat4& value) const {
     glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 }
 
+void Shader::bindUniformBlock(const std::string& blockName, unsigned int bindingPoint) const {
+    unsigned int index = glGetUniformBlockIndex(m_id, blockName.c_str());
+    if (index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(m_id, index, bindingPoint);
+    }
+}
+
 bool Shader::compileShader(unsigned int& shader, const std::string& source, GLenum type) {
     shader = glCreateShader(type);
     const char* src = source.c_str();
@@ -161,8 +222,62 @@ std::string Shader::readFile(const std::string& filepath) {
     return buffer.str();
 }
 
+bool Shader::reflectUniforms() {
+    m_uniforms.clear();
+
+    int count = 0;
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count);
+
+    char name[256];
+    for (int i = 0; i < count; ++i) {
+        int length = 0;
+        int size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_id, static_cast<GLuint>(i), sizeof(name), &length, &size, &type, name);
+
+        // Members of uniform blocks have no location
+        int location = glGetUniformLocation(m_id, name);
+        if (location < 0) {
+            continue;
+        }
+
+        // Arrays are reported as "name[0]"; register the bare name too and
+        // each element, whose locations are not guaranteed to be contiguous
+        std::string baseName(name, static_cast<size_t>(length));
+        if (baseName.size() > 3 && baseName.compare(baseName.size() - 3, 3, "[0]") == 0) {
+            baseName.resize(baseName.size() - 3);
+            for (int element = 1; element < size; ++element) {
+                std::string elementName = baseName + "[" + std::to_string(element) + "]";
+                m_uniforms.add(elementName, glGetUniformLocation(m_id, elementName.c_str()), type);
+            }
+            m_uniforms.add(name, location, type);
+        }
+        m_uniforms.add(baseName, location, type);
+    }
+
+    return m_uniforms.build();
+}
+
+int Shader::findUniform(uint32_t nameHash, GLenum expectedType) const {
+    const UniformTable::UniformInfo* info = m_uniforms.find(nameHash);
+    if (!info) {
+        return -1;
+    }
+
+    // Samplers are set through int handles
+    bool matches = info->type == expectedType ||
+                   (expectedType == GL_INT && (info->type == GL_SAMPLER_2D || info->type == GL_SAMPLER_CUBE));
+    if (!matches) {
+        std::cerr << "Shader uniform type mismatch at location " << info->location << std::endl;
+        return -1;
+    }
+
+    return info->location;
+}
+
 int Shader::getUniformLocation(const std::string& name) const {
-    return glGetUniformLocation(m_id, name.c_str());
+    const UniformTable::UniformInfo* info = m_uniforms.find(name);
+    return info ? info->location : -1;
 }
 
 } // namespace RenderEngine
@@ -0,0 +1,121 @@
+#include "SpatialHash.h"
+#include <algorithm>
+
+namespace RenderEngine {
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+SpatialHash::SpatialHash(float cellSize, size_t bucketCount)
+    : m_buckets(roundUpToPowerOfTwo(std::max<size_t>(bucketCount, 1)), kInvalidId)
+    , m_bucketMask(m_buckets.size() - 1)
+    , m_count(0)
+    , m_cellSize(cellSize)
+    , m_invCellSize(1.0f / cellSize)
+    , m_maxRadius(0.0f) {
+}
+
+size_t SpatialHash::bucketIndex(std::int32_t x, std::int32_t y, std::int32_t z) const {
+    std::uint32_t h = static_cast<std::uint32_t>(x) * 73856093u
+                    ^ static_cast<std::uint32_t>(y) * 19349663u
+                    ^ static_cast<std::uint32_t>(z) * 83492791u;
+    return h & m_bucketMask;
+}
+
+void SpatialHash::insert(Id id, const glm::vec3& center, float radius) {
+    if (id >= m_entries.size()) {
+        m_entries.resize(id + 1, Entry{glm::vec3(0.0f), 0.0f, 0, 0, 0, kInvalidId, kInvalidId, false});
+    }
+    if (m_entries[id].active) {
+        remove(id);
+    }
+
+    Entry& entry = m_entries[id];
+    entry.center = center;
+    entry.radius = radius;
+    entry.cellX = cellCoord(center.x);
+    entry.cellY = cellCoord(center.y);
+    entry.cellZ = cellCoord(center.z);
+    entry.active = true;
+
+    // Push to the front of the bucket list
+    Id& head = m_buckets[bucketIndex(entry.cellX, entry.cellY, entry.cellZ)];
+    entry.prev = kInvalidId;
+    entry.next = head;
+    if (head != kInvalidId) {
+        m_entries[head].prev = id;
+    }
+    head = id;
+
+    m_maxRadius = std::max(m_maxRadius, radius);
+    ++m_count;
+}
+
+void SpatialHash::remove(Id id) {
+    if (!contains(id)) return;
+
+    Entry& entry = m_entries[id];
+    if (entry.prev != kInvalidId) {
+        m_entries[entry.prev].next = entry.next;
+    } else {
+        m_buckets[bucketIndex(entry.cellX, entry.cellY, entry.cellZ)] = entry.next;
+    }
+    if (entry.next != kInvalidId) {
+        m_entries[entry.next].prev = entry.prev;
+    }
+
+    entry.prev = kInvalidId;
+    entry.next = kInvalidId;
+    entry.active = false;
+    --m_count;
+}
+
+void SpatialHash::update(Id id, const glm::vec3& center, float radius) {
+    if (contains(id)) {
+        Entry& entry = m_entries[id];
+        // Staying in the same cell only needs the bounds refreshed
+        if (entry.cellX == cellCoord(center.x) &&
+            entry.cellY == cellCoord(center.y) &&
+            entry.cellZ == cellCoord(center.z)) {
+            entry.center = center;
+            entry.radius = radius;
+            m_maxRadius = std::max(m_maxRadius, radius);
+            return;
+        }
+    }
+    insert(id, center, radius);
+}
+
+void SpatialHash::clear() {
+    std::fill(m_buckets.begin(), m_buckets.end(), kInvalidId);
+    for (auto& entry : m_entries) {
+        entry.prev = kInvalidId;
+        entry.next = kInvalidId;
+        entry.active = false;
+    }
+    m_count = 0;
+    m_maxRadius = 0.0f;
+}
+
+bool SpatialHash::contains(Id id) const {
+    return id < m_entries.size() && m_entries[id].active;
+}
+
+void SpatialHash::querySphere(const glm::vec3& center, float radius, std::vector<Id>& results) const {
+    forEachInSphere(center, radius, [&results](Id id) { results.push_back(id); });
+}
+
+void SpatialHash::queryAABB(const glm::vec3& min, const glm::vec3& max, std::vector<Id>& results) const {
+    forEachInAABB(min, max, [&results](Id id) { results.push_back(id); });
+}
+
+} // namespace RenderEngine
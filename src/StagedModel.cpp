@@ -0,0 +1,304 @@
+#include "StagedModel.h"
+#include "AssetCache.h"
+#include "GlbParser.h"
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace RenderEngine {
+
+namespace {
+
+// Shader input locations of the glTF attributes, as in every VertexPacking
+constexpr unsigned int kPositionLocation = 0;
+constexpr unsigned int kNormalLocation = 1;
+constexpr unsigned int kTexCoordsLocation = 2;
+
+const char* getKindName(ModelFileType type) {
+    switch (type) {
+        case ModelFileType::GLB: return "glb";
+        case ModelFileType::Cooked: return "rmesh";
+        default: return "obj";
+    }
+}
+
+size_t getIndexSize(GLenum indexType) {
+    return indexType == GL_UNSIGNED_INT ? 4 : indexType == GL_UNSIGNED_SHORT ? 2 : 1;
+}
+
+// Distance from the origin to the farthest corner of a box, which
+// encloses every vertex inside it
+float getBoundsRadius(const float* boundsMin, const float* boundsMax) {
+    glm::vec3 extent(0.0f);
+    for (int axis = 0; axis < 3; ++axis) {
+        extent[axis] = std::max(std::abs(boundsMin[axis]), std::abs(boundsMax[axis]));
+    }
+    return glm::length(extent);
+}
+
+// Mapped glTF positions are always three floats
+float getPositionRadius(const GltfAccessor& position) {
+    float radius = 0.0f;
+    for (size_t i = 0; i < position.count; ++i) {
+        glm::vec3 point;
+        std::memcpy(&point[0], position.data + i * position.stride, sizeof(float) * 3);
+        radius = std::max(radius, glm::length(point));
+    }
+    return radius;
+}
+
+VertexAttribute makeAttribute(unsigned int location, const GltfAccessor& accessor, size_t offset) {
+    return {location, accessor.components, accessor.componentType, accessor.normalized, offset};
+}
+
+// Points the vertex streams straight into the file when the attributes
+// form one interleaved view or are each tightly packed; fails otherwise
+bool stageMappedVertices(const GltfPrimitive& primitive, StagedMesh& mesh) {
+    const GltfAccessor* accessors[] = {&primitive.position, &primitive.normal, &primitive.texCoords};
+    const unsigned int locations[] = {kPositionLocation, kNormalLocation, kTexCoordsLocation};
+    size_t count = primitive.position.count;
+
+    bool interleaved = true;
+    bool planar = true;
+    const unsigned char* base = primitive.position.data;
+    for (const GltfAccessor* accessor : accessors) {
+        if (!accessor->isValid()) continue;
+        interleaved = interleaved && accessor->bufferView == primitive.position.bufferView &&
+                      accessor->stride == primitive.position.stride;
+        planar = planar && accessor->isTight();
+        base = std::min(base, accessor->data);
+    }
+
+    VertexFormat& format = mesh.format;
+    if (interleaved && !planar) {
+        // All vertices are read through the view's stride from the lowest
+        // attribute, so every attribute has to lie within one stride of it
+        // (blocks of different attributes merely sharing a stride do not)
+        // and that span has to stay inside the view
+        size_t stride = primitive.position.stride;
+        for (const GltfAccessor* accessor : accessors) {
+            if (accessor->isValid() && static_cast<size_t>(accessor->data - base) + accessor->elementSize > stride) {
+                return false;
+            }
+        }
+        if (static_cast<size_t>(primitive.position.viewEnd - base) / stride < count) {
+            return false;
+        }
+        format.stride = stride;
+        for (size_t i = 0; i < 3; ++i) {
+            if (accessors[i]->isValid()) {
+                size_t offset = static_cast<size_t>(accessors[i]->data - base);
+                format.attributes.push_back(makeAttribute(locations[i], *accessors[i], offset));
+            }
+        }
+        mesh.streams[0] = base;
+    } else if (planar) {
+        format.planar = true;
+        for (size_t i = 0; i < 3; ++i) {
+            if (accessors[i]->isValid()) {
+                mesh.streams[format.attributes.size()] = accessors[i]->data;
+                format.attributes.push_back(makeAttribute(locations[i], *accessors[i], 0));
+                format.stride += accessors[i]->elementSize;
+            }
+        }
+    } else {
+        return false;
+    }
+
+    // glTF vertices are always float positions and normals, which the
+    // float shader inputs read; a missing texcoord attribute reads as zero
+    mesh.packing = VertexPacking::Float;
+    mesh.vertexCount = count;
+    mesh.boundingRadius = getPositionRadius(primitive.position);
+    mesh.mapped = true;
+    return true;
+}
+
+} // namespace
+
+size_t StagedMesh::getGeometryBytes() const {
+    return vertexCount * format.stride + indexCount * getIndexSize(indexType);
+}
+
+bool StagedModel::open(const std::string& path, ModelFileType type, VertexPacking packing) {
+    m_path = path;
+    m_type = type;
+    m_packing = packing;
+    m_fileKey.clear();
+    m_contentKey.clear();
+    if (!m_file.open(path)) {
+        return false;
+    }
+    m_fileKey = makeFileKey(path, type, packing);
+    return true;
+}
+
+std::string StagedModel::makeFileKey(const std::string& path, ModelFileType type, VertexPacking packing) {
+    std::string key = AssetCache::makeFileKey(getKindName(type), path);
+    // OBJ files are packed while staging, so each packing is its own model
+    if (type == ModelFileType::OBJ && !key.empty()) {
+        key += ":" + std::to_string(static_cast<int>(packing));
+    }
+    return key;
+}
+
+const std::string& StagedModel::getContentKey() {
+    if (m_contentKey.empty() && m_file.isOpen()) {
+        m_contentKey = AssetCache::makeContentKey(getKindName(m_type), m_file.data(), m_file.size());
+        if (m_type == ModelFileType::OBJ) {
+            m_contentKey += ":" + std::to_string(static_cast<int>(m_packing));
+        }
+    }
+    return m_contentKey;
+}
+
+bool StagedModel::stage(std::string& error, unsigned int parserThreads) {
+    if (!m_file.isOpen()) {
+        error = "file is not open";
+        return false;
+    }
+
+    switch (m_type) {
+        case ModelFileType::OBJ:
+            return stageOBJ(error, parserThreads);
+        case ModelFileType::GLB:
+            return stageGLB(error);
+        case ModelFileType::Cooked:
+            return stageCooked(error);
+    }
+    return false;
+}
+
+size_t StagedModel::getGeometryBytes() const {
+    size_t bytes = 0;
+    for (const auto& mesh : m_meshes) {
+        bytes += mesh.getGeometryBytes();
+    }
+    return bytes;
+}
+
+bool StagedModel::stageOBJ(std::string& error, unsigned int parserThreads) {
+    std::vector<ObjGroup> groups;
+    if (!ObjParser::parse(m_file.data(), m_file.size(), groups, error, parserThreads)) {
+        return false;
+    }
+
+    for (auto& group : groups) {
+        addDecoded(CookedMeshFile::cook(std::move(group.vertices), std::move(group.indices), m_packing), 0);
+    }
+    return true;
+}
+
+bool StagedModel::stageGLB(std::string& error) {
+    std::vector<GltfMesh> meshes;
+    if (!GlbParser::parse(m_file.data(), m_file.size(), meshes, error, &m_warnings)) {
+        return false;
+    }
+
+    std::vector<unsigned int> indices;
+    for (const auto& mesh : meshes) {
+        for (const auto& primitive : mesh.primitives) {
+            StagedMesh staged;
+            if (!primitive.normal.isValid() || !stageMappedVertices(primitive, staged)) {
+                // Anything else is decoded on the CPU, like an OBJ
+                std::vector<Vertex> vertices;
+                GlbParser::decode(primitive, vertices, indices);
+                addDecoded(CookedMeshFile::cook(std::move(vertices), std::move(indices), Mesh::kDefaultPacking), 0);
+                continue;
+            }
+
+            // 16- and 32-bit indices upload from the file; byte indices are
+            // widened since they are a slow path on most GPUs
+            const GltfAccessor& accessor = primitive.indices;
+            staged.indexCount = accessor.isValid() ? accessor.count : staged.vertexCount;
+            staged.indices = accessor.data;
+            staged.indexType = accessor.componentType;
+            if (!accessor.isValid() || accessor.componentType == GL_UNSIGNED_BYTE) {
+                GlbParser::readIndices(primitive, indices);
+                std::vector<unsigned char> bytes;
+                if (MeshOptimizer::fitsShortIndices(staged.vertexCount)) {
+                    std::vector<std::uint16_t> shortIndices(indices.begin(), indices.end());
+                    bytes.resize(shortIndices.size() * sizeof(std::uint16_t));
+                    std::memcpy(bytes.data(), shortIndices.data(), bytes.size());
+                    staged.indexType = GL_UNSIGNED_SHORT;
+                } else {
+                    bytes.resize(indices.size() * sizeof(unsigned int));
+                    std::memcpy(bytes.data(), indices.data(), bytes.size());
+                    staged.indexType = GL_UNSIGNED_INT;
+                }
+                staged.indices = keep(std::move(bytes));
+            }
+            m_meshes.push_back(staged);
+        }
+    }
+    return true;
+}
+
+bool StagedModel::stageCooked(std::string& error) {
+    CookedMeshView view;
+    if (!CookedMeshFile::open(m_file.data(), m_file.size(), view, error)) {
+        return false;
+    }
+
+    for (std::uint32_t lod = 0; lod < view.header->lodCount; ++lod) {
+        const CookedLodEntry& level = view.lods[lod];
+        if (lod + 1 < view.header->lodCount) {
+            m_lodThresholds.push_back(level.screenRadius);
+        }
+
+        for (std::uint32_t i = level.firstMesh; i < level.firstMesh + level.meshCount; ++i) {
+            const CookedMeshEntry& entry = view.meshes[i];
+            StagedMesh staged;
+            staged.format = CookedMeshFile::getVertexFormat(entry);
+            staged.packing = static_cast<VertexPacking>(entry.packing);
+
+            // Planar blobs store the attribute arrays back to back
+            const char* stream = view.data + entry.vertexOffset;
+            for (size_t a = 0; a < staged.format.attributes.size(); ++a) {
+                staged.streams[a] = stream;
+                stream += staged.format.planar ? entry.vertexCount * getAttributeSize(staged.format.attributes[a]) : 0;
+            }
+
+            staged.vertexCount = entry.vertexCount;
+            staged.indices = view.data + entry.indexOffset;
+            staged.indexCount = entry.indexCount;
+            staged.indexType = entry.indexType;
+            std::memcpy(&staged.positionTransform, entry.positionTransform, sizeof(entry.positionTransform));
+            staged.boundingRadius = getBoundsRadius(entry.boundsMin, entry.boundsMax);
+            staged.lod = lod;
+            staged.mapped = true;
+            m_meshes.push_back(staged);
+        }
+    }
+    return true;
+}
+
+void StagedModel::addDecoded(CookedGeometry geometry, size_t lod) {
+    StagedMesh staged;
+    staged.format = geometry.format;
+    staged.packing = geometry.packing;
+    staged.vertexCount = geometry.vertexCount;
+    staged.indexCount = geometry.indexCount;
+    staged.indexType = geometry.indexType;
+    staged.positionTransform = geometry.positionTransform;
+    staged.boundingRadius = getBoundsRadius(&geometry.boundsMin[0], &geometry.boundsMax[0]);
+    staged.lod = lod;
+
+    const unsigned char* stream = static_cast<const unsigned char*>(keep(std::move(geometry.vertices)));
+    for (size_t a = 0; a < staged.format.attributes.size(); ++a) {
+        staged.streams[a] = stream;
+        stream += staged.format.planar ? staged.vertexCount * getAttributeSize(staged.format.attributes[a]) : 0;
+    }
+    staged.indices = keep(std::move(geometry.indices));
+    m_meshes.push_back(staged);
+}
+
+const void* StagedModel::keep(std::vector<unsigned char> bytes) {
+    m_storage.push_back(std::move(bytes));
+    return m_storage.back().data();
+}
+
+} // namespace RenderEngine
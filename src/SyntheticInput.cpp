@@ -0,0 +1,48 @@
+#include "SyntheticInput.h"
+#include <cmath>
+
+namespace RenderEngine {
+
+SyntheticInput::SyntheticInput(std::uint32_t seed, float areaRadius, float mouseSensitivity)
+    : m_rng(seed)
+    , m_areaRadius(areaRadius)
+    , m_mouseSensitivity(mouseSensitivity)
+    , m_direction(0x01)
+    , m_holdTime(0.0f)
+    , m_turnRate(0.0f) {
+}
+
+InputFrame SyntheticInput::next(float deltaTime, const glm::vec3& position, const glm::vec3& front) {
+    m_holdTime -= deltaTime;
+    if (m_holdTime <= 0.0f) {
+        // Mostly walk forward, sometimes strafe or stop
+        static const int kDirections[] = { 0x01, 0x01, 0x01, 0x05, 0x09, 0x04, 0x08, 0x02, 0x00 };
+        std::uniform_int_distribution<int> directionDist(0, static_cast<int>(sizeof(kDirections) / sizeof(kDirections[0])) - 1);
+        std::uniform_real_distribution<float> holdDist(0.5f, 2.0f);
+        std::uniform_real_distribution<float> turnDist(-60.0f, 60.0f);
+
+        m_direction = kDirections[directionDist(m_rng)];
+        m_holdTime = holdDist(m_rng);
+        m_turnRate = turnDist(m_rng);
+    }
+
+    float turnRate = m_turnRate;
+
+    // Steer back toward the origin once outside the play area
+    glm::vec2 flatPosition(position.x, position.z);
+    if (glm::length(flatPosition) > m_areaRadius) {
+        glm::vec2 toCenter = -flatPosition;
+        float cross = front.x * toCenter.y - front.z * toCenter.x;
+        turnRate = cross > 0.0f ? 120.0f : -120.0f;
+        m_direction = 0x01;
+    }
+
+    // Offsets are in mouse units, which the camera scales by its sensitivity
+    InputFrame frame;
+    frame.direction = m_direction;
+    frame.mouseOffsetX = turnRate * deltaTime / m_mouseSensitivity;
+    frame.mouseOffsetY = 0.0f;
+    return frame;
+}
+
+} // namespace RenderEngine
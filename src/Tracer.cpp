@@ -0,0 +1,273 @@
+#include "Tracer.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace RenderEngine {
+
+std::atomic<bool> Tracer::s_active{false};
+
+namespace {
+
+// Events per chunk handed to the writer
+constexpr size_t kChunkEvents = 8192;
+
+enum class EventType : std::uint8_t {
+    Zone,
+    Counter,
+    Instant,
+    Frame
+};
+
+// Recorded on the calling thread and formatted as JSON by the writer, so
+// the game loop only pays for a copy of a few words
+struct Event {
+    const char* name;
+    std::uint64_t startNs;
+    std::uint64_t endNs;      // Zones only
+    double value;             // Counter value or frame number
+    std::uint32_t threadId;
+    EventType type;
+};
+
+struct TracerState {
+    std::mutex appendMutex;
+    std::vector<Event> current;
+    std::uint64_t originNs = 0;
+    std::atomic<std::uint32_t> nextThreadId{0};
+
+    // Shared with the writer thread
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::vector<std::vector<Event>> pending;
+    std::vector<std::vector<Event>> recycled;
+    bool stopping = false;
+
+    // Writer thread only while a capture runs
+    std::ofstream file;
+    std::thread writer;
+    std::string text;
+};
+
+TracerState& state() {
+    static TracerState instance;
+    return instance;
+}
+
+// Appends ns - originNs as microseconds with three decimals; integer
+// formatting keeps the writer cheap enough to share a core with the game
+void appendMicroseconds(std::string& out, std::uint64_t ns, std::uint64_t originNs) {
+    std::uint64_t relative = ns > originNs ? ns - originNs : 0;
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), relative / 1000).ptr;
+    out.append(digits, end);
+    std::uint64_t fraction = relative % 1000;
+    char decimals[4] = { '.', static_cast<char>('0' + fraction / 100),
+                         static_cast<char>('0' + fraction / 10 % 10), static_cast<char>('0' + fraction % 10) };
+    out.append(decimals, sizeof(decimals));
+}
+
+void appendUnsigned(std::string& out, std::uint64_t value) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    out.append(digits, end);
+}
+
+void formatEvent(const Event& event, std::uint64_t originNs, std::string& out) {
+    switch (event.type) {
+        case EventType::Zone:
+            out += "{\"name\":\"";
+            out += event.name;
+            out += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+            appendUnsigned(out, event.threadId);
+            out += ",\"ts\":";
+            appendMicroseconds(out, event.startNs, originNs);
+            out += ",\"dur\":";
+            appendMicroseconds(out, event.endNs, event.startNs);
+            out += "}";
+            break;
+        case EventType::Counter: {
+            char value[32];
+            int length = std::snprintf(value, sizeof(value), "%.6g", event.value);
+            out += "{\"name\":\"";
+            out += event.name;
+            out += "\",\"ph\":\"C\",\"pid\":1,\"ts\":";
+            appendMicroseconds(out, event.startNs, originNs);
+            out += ",\"args\":{\"value\":";
+            out.append(value, static_cast<size_t>(std::max(length, 0)));
+            out += "}}";
+            break;
+        }
+        case EventType::Instant:
+            out += "{\"name\":\"";
+            out += event.name;
+            out += "\",\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"tid\":0,\"ts\":";
+            appendMicroseconds(out, event.startNs, originNs);
+            out += "}";
+            break;
+        case EventType::Frame:
+            // Global-scope instant events draw a frame boundary across all tracks
+            out += "{\"name\":\"Frame ";
+            appendUnsigned(out, static_cast<std::uint64_t>(event.value));
+            out += "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":";
+            appendMicroseconds(out, event.startNs, originNs);
+            out += "}";
+            break;
+    }
+}
+
+void writeChunk(TracerState& s, const std::vector<Event>& chunk) {
+    s.text.clear();
+    for (const Event& event : chunk) {
+        s.text += ",\n";
+        formatEvent(event, s.originNs, s.text);
+    }
+    s.file.write(s.text.data(), static_cast<std::streamsize>(s.text.size()));
+}
+
+void writerLoop() {
+    TracerState& s = state();
+    std::vector<std::vector<Event>> chunks;
+
+    std::unique_lock<std::mutex> lock(s.queueMutex);
+    for (;;) {
+        s.queueCondition.wait(lock, [&s] { return !s.pending.empty() || s.stopping; });
+        chunks.swap(s.pending);
+        bool stopping = s.stopping;
+        lock.unlock();
+
+        for (auto& chunk : chunks) {
+            writeChunk(s, chunk);
+            chunk.clear();
+        }
+
+        lock.lock();
+        for (auto& chunk : chunks) {
+            s.recycled.push_back(std::move(chunk));
+        }
+        chunks.clear();
+        if (stopping && s.pending.empty()) {
+            break;
+        }
+    }
+}
+
+// Caller holds appendMutex
+void submitCurrentChunk(TracerState& s) {
+    std::vector<Event> next;
+    {
+        std::lock_guard<std::mutex> lock(s.queueMutex);
+        s.pending.push_back(std::move(s.current));
+        if (!s.recycled.empty()) {
+            next = std::move(s.recycled.back());
+            s.recycled.pop_back();
+        }
+    }
+    s.queueCondition.notify_one();
+
+    s.current = std::move(next);
+    s.current.reserve(kChunkEvents);
+}
+
+void appendEvent(const Event& event) {
+    TracerState& s = state();
+    std::lock_guard<std::mutex> lock(s.appendMutex);
+    if (!Tracer::isActive()) {
+        return;
+    }
+
+    s.current.push_back(event);
+    if (s.current.size() >= kChunkEvents) {
+        submitCurrentChunk(s);
+    }
+}
+
+} // namespace
+
+bool Tracer::start(const std::string& path) {
+    if (isActive()) {
+        return false;
+    }
+
+    TracerState& s = state();
+    s.file.open(path, std::ios::binary | std::ios::trunc);
+    if (!s.file.is_open()) {
+        std::cerr << "Failed to open trace file: " << path << std::endl;
+        return false;
+    }
+
+    s.file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    s.file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"RenderEngine\"}}";
+    s.current.clear();
+    s.current.reserve(kChunkEvents);
+    s.originNs = nowNs();
+    s.stopping = false;
+    s.writer = std::thread(writerLoop);
+
+    s_active.store(true, std::memory_order_release);
+    return true;
+}
+
+void Tracer::stop() {
+    if (!isActive()) {
+        return;
+    }
+
+    TracerState& s = state();
+    {
+        std::lock_guard<std::mutex> lock(s.appendMutex);
+        s_active.store(false, std::memory_order_release);
+        submitCurrentChunk(s);
+    }
+    {
+        std::lock_guard<std::mutex> lock(s.queueMutex);
+        s.stopping = true;
+    }
+    s.queueCondition.notify_one();
+    s.writer.join();
+
+    s.file << "\n]}\n";
+    s.file.close();
+    s.recycled.clear();
+}
+
+std::uint64_t Tracer::nowNs() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::uint32_t Tracer::getThreadId() {
+    thread_local std::uint32_t threadId = state().nextThreadId.fetch_add(1, std::memory_order_relaxed);
+    return threadId;
+}
+
+void Tracer::zone(const char* name, std::uint32_t threadId, std::uint64_t startNs, std::uint64_t endNs) {
+    if (!isActive()) return;
+    appendEvent(Event{name, startNs, endNs, 0.0, threadId, EventType::Zone});
+}
+
+void Tracer::counter(const char* name, double value) {
+    if (!isActive()) return;
+    appendEvent(Event{name, nowNs(), 0, value, 0, EventType::Counter});
+}
+
+void Tracer::instant(const char* name) {
+    if (!isActive()) return;
+    appendEvent(Event{name, nowNs(), 0, 0.0, 0, EventType::Instant});
+}
+
+void Tracer::frame(std::uint64_t frameNumber) {
+    if (!isActive()) return;
+    appendEvent(Event{nullptr, nowNs(), 0, static_cast<double>(frameNumber), 0, EventType::Frame});
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,51 @@
+#include "UniformTable.h"
+#include <algorithm>
+#include <iostream>
+
+namespace RenderEngine {
+
+void UniformTable::clear() {
+    m_uniforms.clear();
+    m_names.clear();
+}
+
+void UniformTable::add(const std::string& name, int location, unsigned int type) {
+    m_uniforms.push_back({hashUniformName(name.c_str()), location, type});
+    m_names.push_back(name);
+}
+
+bool UniformTable::build() {
+    std::vector<size_t> order(m_uniforms.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [this](size_t a, size_t b) { return m_uniforms[a].nameHash < m_uniforms[b].nameHash; });
+
+    std::vector<UniformInfo> sorted;
+    sorted.reserve(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i > 0 && m_uniforms[order[i]].nameHash == m_uniforms[order[i - 1]].nameHash) {
+            std::cerr << "Shader uniforms \"" << m_names[order[i - 1]] << "\" and \"" << m_names[order[i]]
+                      << "\" have the same name hash; rename one of them" << std::endl;
+            clear();
+            return false;
+        }
+        sorted.push_back(m_uniforms[order[i]]);
+    }
+    m_uniforms.swap(sorted);
+    m_names.clear();
+    m_names.shrink_to_fit();
+    return true;
+}
+
+const UniformTable::UniformInfo* UniformTable::find(uint32_t nameHash) const {
+    auto it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), nameHash,
+                               [](const UniformInfo& info, uint32_t hash) { return info.nameHash < hash; });
+    if (it == m_uniforms.end() || it->nameHash != nameHash) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,204 @@
+#include "VertexFormat.h"
+#include "Vertex.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace RenderEngine {
+
+namespace {
+
+struct CompactVertex {
+    glm::vec3 position;
+    std::int16_t normal[2];
+    std::uint16_t texCoords[2];
+};
+
+struct QuantizedVertex {
+    std::uint16_t position[4];  // xyz, padded to keep the normal aligned
+    std::int16_t normal[2];
+    std::uint16_t texCoords[2];
+};
+
+static_assert(sizeof(CompactVertex) == 20, "CompactVertex must be tightly packed");
+static_assert(sizeof(QuantizedVertex) == 16, "QuantizedVertex must be tightly packed");
+
+const char* const kFloatInputGLSL = R"(
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+vec3 vertexPosition() { return aPos; }
+vec3 vertexNormal() { return aNormal; }
+vec2 vertexTexCoords() { return aTexCoord; }
+)";
+
+const char* const kPackedInputGLSL = R"(
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+vec3 vertexPosition() { return aPos; }
+vec3 vertexNormal() {
+    vec3 n = vec3(aNormal, 1.0 - abs(aNormal.x) - abs(aNormal.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+vec2 vertexTexCoords() { return aTexCoord; }
+)";
+
+} // namespace
+
+const VertexFormat& getVertexFormat(VertexPacking packing) {
+    static const VertexFormat floatFormat = {
+        sizeof(Vertex),
+        {
+            {0, 3, GL_FLOAT, false, offsetof(Vertex, position)},
+            {1, 3, GL_FLOAT, false, offsetof(Vertex, normal)},
+            {2, 2, GL_FLOAT, false, offsetof(Vertex, texCoords)}
+        }
+    };
+    static const VertexFormat compactFormat = {
+        sizeof(CompactVertex),
+        {
+            {0, 3, GL_FLOAT, false, offsetof(CompactVertex, position)},
+            {1, 2, GL_SHORT, true, offsetof(CompactVertex, normal)},
+            {2, 2, GL_HALF_FLOAT, false, offsetof(CompactVertex, texCoords)}
+        }
+    };
+    static const VertexFormat quantizedFormat = {
+        sizeof(QuantizedVertex),
+        {
+            {0, 3, GL_UNSIGNED_SHORT, true, offsetof(QuantizedVertex, position)},
+            {1, 2, GL_SHORT, true, offsetof(QuantizedVertex, normal)},
+            {2, 2, GL_HALF_FLOAT, false, offsetof(QuantizedVertex, texCoords)}
+        }
+    };
+
+    switch (packing) {
+        case VertexPacking::Compact: return compactFormat;
+        case VertexPacking::Quantized: return quantizedFormat;
+        default: return floatFormat;
+    }
+}
+
+glm::mat4 packVertices(const std::vector<Vertex>& vertices, VertexPacking packing, std::vector<unsigned char>& packed) {
+    packed.resize(vertices.size() * getVertexFormat(packing).stride);
+
+    if (packing == VertexPacking::Float) {
+        if (!vertices.empty()) {
+            std::memcpy(packed.data(), vertices.data(), packed.size());
+        }
+        return glm::mat4(1.0f);
+    }
+
+    if (packing == VertexPacking::Compact) {
+        auto* out = reinterpret_cast<CompactVertex*>(packed.data());
+        for (const Vertex& vertex : vertices) {
+            out->position = vertex.position;
+            encodeOctahedral(vertex.normal, out->normal);
+            out->texCoords[0] = encodeHalf(vertex.texCoords.x);
+            out->texCoords[1] = encodeHalf(vertex.texCoords.y);
+            ++out;
+        }
+        return glm::mat4(1.0f);
+    }
+
+    // Quantize against a cube around the bounds so the dequantizing
+    // transform is a uniform scale and leaves normals unaffected
+    glm::vec3 boundsMin(0.0f);
+    glm::vec3 boundsMax(0.0f);
+    if (!vertices.empty()) {
+        boundsMin = boundsMax = vertices[0].position;
+        for (const Vertex& vertex : vertices) {
+            boundsMin = glm::min(boundsMin, vertex.position);
+            boundsMax = glm::max(boundsMax, vertex.position);
+        }
+    }
+    glm::vec3 size = boundsMax - boundsMin;
+    float extent = std::max(std::max(size.x, size.y), size.z);
+    if (extent <= 0.0f) {
+        extent = 1.0f;
+    }
+
+    auto* out = reinterpret_cast<QuantizedVertex*>(packed.data());
+    for (const Vertex& vertex : vertices) {
+        glm::vec3 normalized = (vertex.position - boundsMin) / extent;
+        for (int axis = 0; axis < 3; ++axis) {
+            float value = std::min(std::max(normalized[axis], 0.0f), 1.0f);
+            out->position[axis] = static_cast<std::uint16_t>(std::lround(value * 65535.0f));
+        }
+        out->position[3] = 0;
+        encodeOctahedral(vertex.normal, out->normal);
+        out->texCoords[0] = encodeHalf(vertex.texCoords.x);
+        out->texCoords[1] = encodeHalf(vertex.texCoords.y);
+        ++out;
+    }
+
+    return glm::scale(glm::translate(glm::mat4(1.0f), boundsMin), glm::vec3(extent));
+}
+
+const char* getVertexInputGLSL(VertexPacking packing) {
+    return packing == VertexPacking::Float ? kFloatInputGLSL : kPackedInputGLSL;
+}
+
+void encodeOctahedral(const glm::vec3& normal, std::int16_t encoded[2]) {
+    float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    float x = length > 0.0f ? normal.x / length : 0.0f;
+    float y = length > 0.0f ? normal.y / length : 0.0f;
+
+    // Fold the lower hemisphere over the diagonals of the square
+    if (normal.z < 0.0f) {
+        float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+
+    encoded[0] = static_cast<std::int16_t>(std::lround(std::clamp(x, -1.0f, 1.0f) * 32767.0f));
+    encoded[1] = static_cast<std::int16_t>(std::lround(std::clamp(y, -1.0f, 1.0f) * 32767.0f));
+}
+
+std::uint16_t encodeHalf(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    std::uint32_t sign = (bits >> 16) & 0x8000u;
+    std::uint32_t biased = (bits >> 23) & 0xFFu;
+    std::uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (biased == 0xFFu) {
+        // Infinity stays infinity, NaN stays NaN
+        return static_cast<std::uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+
+    int exponent = static_cast<int>(biased) - 127 + 15;
+    if (exponent >= 31) {
+        return static_cast<std::uint16_t>(sign | 0x7C00u);
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<std::uint16_t>(sign);
+        }
+        // Subnormal half: shift the mantissa including its implicit bit
+        mantissa |= 0x800000u;
+        std::uint32_t shift = static_cast<std::uint32_t>(14 - exponent);
+        std::uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1u) {
+            half += 1;
+        }
+        return static_cast<std::uint16_t>(sign | half);
+    }
+
+    // Rounding may carry into the exponent, which is still the right result
+    std::uint32_t half = sign | (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000u) {
+        half += 1;
+    }
+    return static_cast<std::uint16_t>(half);
+}
+
+} // namespace RenderEngine
@@ -1,4 +1,6 @@
 #include "Window.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
 #include <GLFW/glfw3.h>
 #include <iostream>
 
@@ -52,8 +54,8 @@ Window::Window(int width, int height, const std::string& title)
     #endif
 
     // Enable depth testing
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
+    GLStateCache::current().setDepthTest(true);
+    GLStateCache::current().setBlending(true);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
@@ -71,6 +73,7 @@ bool Window::shouldClose() const {
 }
 
 void Window::swapBuffers() {
+    PROFILE_SCOPE("swapBuffers");
     glfwSwapBuffers(m_window);
 }
 
@@ -79,7 +82,7 @@ void Window::pollEvents() {
 }
 
 void Window::clear(float r, float g, float b, float a) {
-    glClearColor(r, g, b, a);
+    GLStateCache::current().setClearColor(glm::vec4(r, g, b, a));
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
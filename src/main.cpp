@@ -1,6 +1,10 @@
 #include "Game.h"
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
 
 /**
  * @file main.cpp
@@ -16,11 +20,77 @@
  * - Beautiful lighting and shader effects
  */
 
-int main() {
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --tick-rate <hz>           Run the simulation at a fixed tick rate\n"
+              << "  --max-ticks <n>            Max simulation ticks per rendered frame (default 5)\n"
+              << "  --collectibles <n>         Number of collectibles in the world (default 15)\n"
+              << "  --world-size <size>        Edge length of the square world (default 20)\n"
+              << "  --seed <n>                 Seed for spawning and synthetic input\n"
+              << "  --headless                 Simulate without a window or GL context\n"
+              << "  --frames <n>               Headless: number of ticks to run (default 10000)\n"
+              << "  --duration <seconds>       Headless: wall time to run instead of a tick count\n"
+              << "  --trace <file.json>        Write a Chrome trace-event / Perfetto timeline\n"
+              << "  --bvh                      Use a BVH scene index for collisions and culling\n"
+              << "  --ground-model <file>      Load the ground from an .obj, .glb or .rmesh file\n"
+              << "  --collectible-model <file> Load the collectible shape from an .obj, .glb or .rmesh file\n"
+              << "  --help                     Show this message" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
     using namespace RenderEngine;
 
+    GameSettings settings;
     try {
-        Game game;
+        for (int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (std::strcmp(arg, "--tick-rate") == 0 && hasValue) {
+                settings.fixedTimestep = true;
+                settings.tickRate = std::stof(argv[++i]);
+            } else if (std::strcmp(arg, "--max-ticks") == 0 && hasValue) {
+                settings.maxTicksPerFrame = std::stoi(argv[++i]);
+            } else if (std::strcmp(arg, "--collectibles") == 0 && hasValue) {
+                settings.maxCollectibles = std::stoi(argv[++i]);
+            } else if (std::strcmp(arg, "--world-size") == 0 && hasValue) {
+                settings.worldSize = std::stof(argv[++i]);
+            } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+                settings.seed = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+            } else if (std::strcmp(arg, "--headless") == 0) {
+                settings.headless = true;
+            } else if (std::strcmp(arg, "--frames") == 0 && hasValue) {
+                settings.headlessFrames = std::stol(argv[++i]);
+            } else if (std::strcmp(arg, "--duration") == 0 && hasValue) {
+                settings.headlessDuration = std::stof(argv[++i]);
+            } else if (std::strcmp(arg, "--trace") == 0 && hasValue) {
+                settings.tracePath = argv[++i];
+            } else if (std::strcmp(arg, "--bvh") == 0) {
+                settings.useBvh = true;
+            } else if (std::strcmp(arg, "--ground-model") == 0 && hasValue) {
+                settings.groundModelPath = argv[++i];
+            } else if (std::strcmp(arg, "--collectible-model") == 0 && hasValue) {
+                settings.collectibleModelPath = argv[++i];
+            } else if (std::strcmp(arg, "--help") == 0) {
+                printUsage(argv[0]);
+                return EXIT_SUCCESS;
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (settings.tickRate <= 0.0f || settings.maxTicksPerFrame < 1 ||
+            settings.maxCollectibles < 0 || settings.worldSize <= 0.0f) {
+            std::cerr << "Tick rate, max ticks, collectible count and world size must be positive" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        Game game(settings);
         
         if (!game.initialize()) {
             std::cerr << "Failed to initialize game" << std::endl;
@@ -30,9 +100,15 @@ int main() {
         game.run();
         game.shutdown();
 
-        std::cout << "\nThanks for playing!" << std::endl;
+        if (!settings.headless) {
+            std::cout << "\nThanks for playing!" << std::endl;
+        }
         return EXIT_SUCCESS;
 
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Invalid option value (" << e.what() << ")" << std::endl;
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
     } catch (const std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
         return EXIT_FAILURE;
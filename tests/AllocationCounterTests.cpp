@@ -0,0 +1,61 @@
+#include "Test.h"
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+struct alignas(64) CacheLine {
+    float values[16];
+};
+
+} // namespace
+
+TEST_CASE(allocationCounterSeparatesThreads) {
+    CHECK(AllocationCounter::isEnabled());
+    const size_t allocations = 100;
+    // Kept until the end so the compiler cannot elide the allocations
+    std::vector<std::unique_ptr<int>> kept;
+    kept.reserve(allocations + 1);
+    std::atomic<bool> start{false};
+    std::atomic<bool> done{false};
+    std::thread worker([&]() {
+        while (!start.load()) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < allocations; ++i) {
+            kept.push_back(std::make_unique<int>(static_cast<int>(i)));
+        }
+        done.store(true);
+    });
+
+    // Creating the thread allocates, so counting starts once it runs
+    std::uint64_t threadBefore = AllocationCounter::getThreadCount();
+    std::uint64_t processBefore = AllocationCounter::getCount();
+    start.store(true);
+    while (!done.load()) {
+        std::this_thread::yield();
+    }
+    CHECK(AllocationCounter::getThreadCount() == threadBefore);
+    CHECK(AllocationCounter::getCount() - processBefore >= allocations);
+    worker.join();
+
+    kept.push_back(std::make_unique<int>(-1));
+    CHECK(AllocationCounter::getThreadCount() == threadBefore + 1);
+    CHECK(kept.size() == allocations + 1);
+}
+
+TEST_CASE(allocationCounterCountsAlignedAllocations) {
+    std::uint64_t before = AllocationCounter::getThreadCount();
+    auto single = std::make_unique<CacheLine>();
+    auto array = std::make_unique<CacheLine[]>(4);
+    CHECK(AllocationCounter::getThreadCount() == before + 2);
+    CHECK(reinterpret_cast<std::uintptr_t>(single.get()) % alignof(CacheLine) == 0);
+    CHECK(reinterpret_cast<std::uintptr_t>(array.get()) % alignof(CacheLine) == 0);
+    Test::keep(single->values[0] + array[3].values[15]);
+}
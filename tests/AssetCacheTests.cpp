@@ -0,0 +1,145 @@
+#include "Test.h"
+#include "AssetCache.h"
+#include "Mesh.h"
+#include "Model.h"
+#include "StagedModel.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace RenderEngine;
+
+namespace {
+
+void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+// Without a Renderer no GeometryArena is current, so the mesh uploads
+// nothing but still reports its size
+std::shared_ptr<Mesh> makeTriangle() {
+    std::vector<Vertex> vertices = {Vertex(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f)),
+                                    Vertex(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f)),
+                                    Vertex(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f))};
+    return std::make_shared<Mesh>(std::move(vertices), std::vector<unsigned int>{0, 1, 2});
+}
+
+} // namespace
+
+TEST_CASE(assetCacheFindsUnchangedFilesWithoutHashing) {
+    std::string path = (std::filesystem::temp_directory_path() / "renderengine_cache.obj").string();
+    writeFile(path, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+
+    AssetCache cache;
+    std::string fileKey;
+    {
+        StagedModel staged;
+        CHECK(staged.open(path, ModelFileType::OBJ, VertexPacking::Float));
+        fileKey = staged.getFileKey();
+        CHECK(!fileKey.empty());
+        CHECK(fileKey == StagedModel::makeFileKey(path, ModelFileType::OBJ, VertexPacking::Float));
+        CHECK(cache.findFile(fileKey) == nullptr);
+
+        auto model = std::make_shared<Model>();
+        cache.insert(staged.getContentKey(), model);
+        cache.addFileKey(fileKey, staged.getContentKey());
+        CHECK(cache.findFile(fileKey) == model);
+        CHECK(cache.getStats().hits == 1);
+    }
+    // Each packing is a different model of the same file
+    CHECK(fileKey != StagedModel::makeFileKey(path, ModelFileType::OBJ, VertexPacking::Compact));
+
+    // A rewritten file gets a new key and has to be hashed again
+    writeFile(path, "v 0 0 0\nv 2 0 0\nv 0 2 0\nf 1 2 3\n# edited\n");
+    std::string changedKey = StagedModel::makeFileKey(path, ModelFileType::OBJ, VertexPacking::Float);
+    CHECK(changedKey != fileKey);
+    CHECK(cache.findFile(changedKey) == nullptr);
+
+    cache.clear();
+    CHECK(cache.findFile(fileKey) == nullptr);
+    CHECK(AssetCache::makeFileKey("obj", path + ".missing").empty());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE(assetCacheEvictsLeastRecentlyUsed) {
+    AssetCache cache(300);
+    cache.insert("a", std::make_shared<Model>(), 100);
+    cache.insert("b", std::make_shared<Model>(), 100);
+    cache.insert("c", std::make_shared<Model>(), 100);
+    cache.addFileKey("file:b", "b");
+    CHECK(cache.getStats().residentBytes == 300);
+    CHECK(cache.getStats().evictions == 0);
+
+    // Using a makes b the oldest
+    CHECK(cache.find("a") != nullptr);
+    cache.insert("d", std::make_shared<Model>(), 100);
+    CHECK(cache.getStats().evictions == 1);
+    CHECK(cache.getStats().residentBytes == 300);
+    CHECK(cache.getStats().entryCount == 3);
+    CHECK(cache.find("b") == nullptr);
+    CHECK(cache.findFile("file:b") == nullptr);
+
+    // Shrinking the budget trims oldest first: c, then a
+    cache.setBudget(100);
+    CHECK(cache.getStats().evictions == 3);
+    CHECK(cache.getStats().residentBytes == 100);
+    CHECK(cache.find("c") == nullptr);
+    CHECK(cache.find("a") == nullptr);
+    CHECK(cache.find("d") != nullptr);
+
+    // Replacing an entry recharges its size rather than adding to it
+    cache.insert("d", std::make_shared<Model>(), 60);
+    CHECK(cache.getStats().residentBytes == 60);
+    CHECK(cache.getStats().entryCount == 1);
+
+    const AssetCacheStats& stats = cache.getStats();
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 3);
+    CHECK(stats.budgetBytes == 100);
+}
+
+TEST_CASE(assetCacheKeepsModelsInUse) {
+    AssetCache cache(100);
+    auto held = std::make_shared<Model>();
+    cache.insert("held", held, 80);
+    auto shared = std::make_shared<Model>();
+    std::shared_ptr<Mesh> mesh = makeTriangle();
+    shared->addMesh(mesh);
+    CHECK(shared->getGeometryBytes() > 0);
+    cache.insert("shared", shared);
+    shared.reset();
+    cache.insert("free", std::make_shared<Model>(), 80);
+
+    // Only the entry no one else holds can go, so the cache stays over budget
+    CHECK(cache.getStats().evictions == 1);
+    CHECK(cache.find("free") == nullptr);
+    CHECK(cache.getStats().residentBytes == 80 + mesh->getGeometryBytes());
+    CHECK(cache.getStats().residentBytes > cache.getBudget());
+
+    // Its mesh outlives the model, so evicting "shared" would free nothing
+    cache.trim();
+    CHECK(cache.find("shared") != nullptr);
+
+    // Once released, the oldest goes first and trimming stops within budget
+    mesh.reset();
+    held.reset();
+    cache.trim();
+    CHECK(cache.getStats().evictions == 2);
+    CHECK(cache.find("held") == nullptr);
+    CHECK(cache.getStats().entryCount == 1);
+
+    cache.setBudget(0);
+    CHECK(cache.getStats().evictions == 3);
+    CHECK(cache.getStats().entryCount == 0);
+    CHECK(cache.getStats().residentBytes == 0);
+}
+
+TEST_CASE(assetCacheContentKeysIncludeTheSize) {
+    const char data[] = "v 0 0 0\n";
+    std::string key = AssetCache::makeContentKey("obj", data, sizeof(data) - 1);
+    CHECK(key.compare(0, 4, "obj:") == 0);
+    CHECK(key.size() > 2 && key.compare(key.size() - 2, 2, ":8") == 0);
+    CHECK(key != AssetCache::makeContentKey("obj", data, sizeof(data)));
+    CHECK(key != AssetCache::makeContentKey("glb", data, sizeof(data) - 1));
+}
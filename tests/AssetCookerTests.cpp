@@ -0,0 +1,183 @@
+#include "Test.h"
+#include "AssetCooker.h"
+#include "AssetManifest.h"
+#include "CookedMesh.h"
+#include "MappedFile.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const kTriangle = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+const char* const kQuad = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3\nf 1 3 4\n";
+
+void writeFile(const fs::path& path, const std::string& content) {
+    fs::create_directories(path.parent_path());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+// Empty scratch directory under the system temp directory
+fs::path makeScratch(const char* name) {
+    fs::path directory = fs::temp_directory_path() / name;
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    return directory;
+}
+
+AssetManifest loadManifest(const fs::path& output) {
+    AssetManifest manifest;
+    std::string error;
+    CHECK(manifest.load((output / AssetManifest::kFileName).string(), error));
+    return manifest;
+}
+
+CookSettings makeSettings() {
+    CookSettings settings;
+    settings.jobs = 1;
+    settings.lodLevels = 1;
+    return settings;
+}
+
+} // namespace
+
+TEST_CASE(assetCookerSkipsUpToDateSources) {
+    fs::path scratch = makeScratch("renderengine_cooker_skip");
+    fs::path source = scratch / "in" / "shape.obj";
+    fs::path output = scratch / "out";
+    fs::path cooked = output / "shape.rmesh";
+    writeFile(source, kTriangle);
+    const std::vector<std::string> inputs = {source.string()};
+
+    AssetCooker cooker(makeSettings());
+    CHECK(cooker.run(inputs, output.string()));
+    CHECK(cooker.getStats().cooked == 1);
+    CHECK(fs::exists(cooked));
+    CHECK(!fs::exists(cooked.string() + ".tmp"));
+    CHECK(loadManifest(output).find("shape") != nullptr);
+
+    // Unchanged input and settings
+    CHECK(cooker.run(inputs, output.string()));
+    CHECK(cooker.getStats().cooked == 0);
+    CHECK(cooker.getStats().skipped == 1);
+
+    // Other settings produce other output
+    CookSettings quantized = makeSettings();
+    quantized.packing = VertexPacking::Quantized;
+    AssetCooker requantizer(quantized);
+    CHECK(requantizer.run(inputs, output.string()));
+    CHECK(requantizer.getStats().cooked == 1);
+    CHECK(requantizer.run(inputs, output.string()));
+    CHECK(requantizer.getStats().skipped == 1);
+
+    // New content
+    writeFile(source, kQuad);
+    CHECK(requantizer.run(inputs, output.string()));
+    CHECK(requantizer.getStats().cooked == 1);
+
+    // Missing or replaced output
+    fs::remove(cooked);
+    CHECK(requantizer.run(inputs, output.string()));
+    CHECK(requantizer.getStats().cooked == 1);
+    CHECK(fs::exists(cooked));
+    writeFile(cooked, "truncated");
+    CHECK(requantizer.run(inputs, output.string()));
+    CHECK(requantizer.getStats().cooked == 1);
+
+    CookSettings forced = quantized;
+    forced.force = true;
+    AssetCooker forcedCooker(forced);
+    CHECK(forcedCooker.run(inputs, output.string()));
+    CHECK(forcedCooker.getStats().cooked == 1);
+
+    fs::remove_all(scratch);
+}
+
+TEST_CASE(assetCookerDropsFailedAndDeletedSources) {
+    fs::path scratch = makeScratch("renderengine_cooker_prune");
+    fs::path input = scratch / "in";
+    fs::path output = scratch / "out";
+    writeFile(input / "a.obj", kTriangle);
+    writeFile(input / "b.obj", kQuad);
+    writeFile(input / "c.obj", kTriangle);
+    const std::vector<std::string> inputs = {input.string()};
+
+    AssetCooker cooker(makeSettings());
+    CHECK(cooker.run(inputs, output.string()));
+    CHECK(cooker.getStats().cooked == 3);
+    CHECK(loadManifest(output).getEntries().size() == 3);
+
+    // A parse error drops b's stale output; a deleted source drops c's
+    writeFile(input / "b.obj", "v 0 0 0\nf 1 2 9\n");
+    fs::remove(input / "c.obj");
+    CHECK(!cooker.run(inputs, output.string()));
+    CHECK(cooker.getStats().skipped == 1);
+    CHECK(cooker.getStats().failed == 1);
+    CHECK(cooker.getStats().removed == 2);
+    AssetManifest manifest = loadManifest(output);
+    CHECK(manifest.find("a") != nullptr);
+    CHECK(manifest.find("b") == nullptr);
+    CHECK(manifest.find("c") == nullptr);
+    CHECK(!fs::exists(output / "b.rmesh"));
+    CHECK(!fs::exists(output / "c.rmesh"));
+
+    // A second source with a taken stem fails without touching the first
+    writeFile(input / "b.obj", kQuad);
+    writeFile(input / "more" / "a.obj", kQuad);
+    CHECK(!cooker.run(inputs, output.string()));
+    CHECK(cooker.getStats().failed == 1);
+    CHECK(cooker.getStats().removed == 0);
+    manifest = loadManifest(output);
+    CHECK(manifest.find("a") != nullptr);
+    CHECK(manifest.find("a")->source == (input / "a.obj").string());
+    CHECK(manifest.find("b") != nullptr);
+    CHECK(fs::exists(output / "a.rmesh"));
+
+    // Entries from inputs outside this run are left alone
+    writeFile(scratch / "other" / "d.obj", kTriangle);
+    CHECK(cooker.run({(scratch / "other" / "d.obj").string()}, output.string()));
+    fs::remove_all(input / "more");
+    CHECK(cooker.run({(scratch / "other").string()}, output.string()));
+    CHECK(loadManifest(output).getEntries().size() == 3);
+
+    fs::remove_all(scratch);
+}
+
+TEST_CASE(cookedMeshWriteReplacesFilesWhole) {
+    fs::path scratch = makeScratch("renderengine_cooked_write");
+    std::string path = (scratch / "mesh.rmesh").string();
+    std::vector<Vertex> vertices = {Vertex(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f)),
+                                    Vertex(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f)),
+                                    Vertex(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f))};
+    std::vector<std::vector<CookedGeometry>> lods = {
+        {CookedMeshFile::cook(vertices, {0, 1, 2}, VertexPacking::Float)}};
+    std::string error;
+    CHECK(CookedMeshFile::write(path, lods, {}, error));
+
+    // A reader that mapped the old file keeps a complete copy of it
+    MappedFile mapped;
+    CHECK(mapped.open(path));
+    std::vector<char> before(mapped.data(), mapped.data() + mapped.size());
+    lods[0].push_back(CookedMeshFile::cook(vertices, {0, 2, 1}, VertexPacking::Compact));
+    CHECK(CookedMeshFile::write(path, lods, {}, error));
+    CHECK(std::vector<char>(mapped.data(), mapped.data() + mapped.size()) == before);
+    CHECK(!fs::exists(path + ".tmp"));
+
+    MappedFile rewritten;
+    CookedMeshView view;
+    CHECK(rewritten.open(path));
+    CHECK(CookedMeshFile::open(rewritten.data(), rewritten.size(), view, error));
+
+    // Failing to create the file leaves nothing behind
+    std::string unwritable = (scratch / "missing" / "mesh.rmesh").string();
+    CHECK(!CookedMeshFile::write(unwritable, lods, {}, error));
+    CHECK(!fs::exists(unwritable + ".tmp"));
+
+    fs::remove_all(scratch);
+}
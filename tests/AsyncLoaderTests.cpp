@@ -0,0 +1,134 @@
+#include "Test.h"
+#include "AsyncLoader.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Pumps the loader as the frame loop would until done() holds or a few
+// seconds have passed; returns done()
+bool pumpUntil(AsyncLoader& loader, const std::function<bool()>& done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done() && std::chrono::steady_clock::now() < deadline) {
+        loader.update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return done();
+}
+
+// Waits without calling update(), so nothing leaves the staging queue
+bool waitUntil(const std::function<bool()>& done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return done();
+}
+
+} // namespace
+
+TEST_CASE(asyncLoaderFailsMissingFiles) {
+    AsyncLoader loader;
+    LoadHandle<Model> model = loader.loadOBJ(tempPath("renderengine_missing.obj"));
+    CHECK(model.getState() == LoadState::Pending);
+    CHECK(!loader.isIdle());
+
+    // Failures resolve on the GL thread like uploads do
+    CHECK(pumpUntil(loader, [&]() { return loader.isIdle(); }));
+    CHECK(model.hasFailed());
+    CHECK(model.get() == nullptr);
+    CHECK(loader.getStats().failed == 1);
+    CHECK(loader.getStats().completed == 0);
+}
+
+TEST_CASE(asyncLoaderFailsUnreadableShaders) {
+    std::string vertexPath = tempPath("renderengine_loader.vert");
+    std::string emptyPath = tempPath("renderengine_loader_empty.frag");
+    std::ofstream(vertexPath) << "void main() {}\n";
+    std::ofstream(emptyPath).close();
+
+    AsyncLoader loader;
+    LoadHandle<Shader> missing = loader.loadShader(tempPath("renderengine_missing.vert"), emptyPath);
+    LoadHandle<Shader> empty = loader.loadShader(vertexPath, emptyPath);
+    CHECK(pumpUntil(loader, [&]() { return loader.isIdle(); }));
+    CHECK(missing.hasFailed());
+    CHECK(empty.hasFailed());
+    CHECK(loader.getStats().failed == 2);
+
+    std::filesystem::remove(vertexPath);
+    std::filesystem::remove(emptyPath);
+}
+
+TEST_CASE(asyncLoaderBoundsTheStagingQueue) {
+    const unsigned int workers = 2;
+    const size_t requests = AsyncLoader::kMaxStagedAssets + workers + 4;
+    AsyncLoader loader(workers);
+    std::vector<LoadHandle<Model>> handles;
+    for (size_t i = 0; i < requests; ++i) {
+        handles.push_back(loader.loadOBJ(tempPath("renderengine_missing_" + std::to_string(i) + ".obj")));
+    }
+
+    // Without update() the queue fills and the workers stop there, each
+    // holding one more staged asset, while the rest stay unstarted
+    CHECK(waitUntil([&]() { return loader.getStagedCount() == AsyncLoader::kMaxStagedAssets; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(loader.getStagedCount() == AsyncLoader::kMaxStagedAssets);
+    CHECK(loader.getStats().pending == requests);
+
+    // Each budget-free update resolves one asset and frees one place
+    loader.update(0.0);
+    CHECK(loader.getStats().pending == requests - 1);
+
+    CHECK(pumpUntil(loader, [&]() { return loader.isIdle(); }));
+    for (const auto& handle : handles) {
+        CHECK(handle.hasFailed());
+    }
+    CHECK(loader.getStats().failed == requests);
+}
+
+TEST_CASE(asyncLoaderStopFailsUnfinishedRequests) {
+    const size_t requests = AsyncLoader::kMaxStagedAssets * 4;
+    std::vector<LoadHandle<Model>> handles;
+    AsyncLoader loader(1);
+    for (size_t i = 0; i < requests; ++i) {
+        handles.push_back(loader.loadCooked(tempPath("renderengine_missing_" + std::to_string(i) + ".rmesh")));
+    }
+    CHECK(waitUntil([&]() { return loader.getStagedCount() == AsyncLoader::kMaxStagedAssets; }));
+
+    // Queued, staged and blocked requests all resolve without update()
+    loader.stop();
+    CHECK(loader.getStats().pending == 0);
+    CHECK(loader.getStats().failed == requests);
+    CHECK(loader.getStagedCount() == 0);
+    for (const auto& handle : handles) {
+        CHECK(handle.hasFailed());
+    }
+
+    LoadHandle<Model> late = loader.loadGLB(tempPath("renderengine_missing.glb"));
+    CHECK(late.hasFailed());
+    CHECK(loader.isIdle());
+}
+
+TEST_CASE(asyncLoaderDestructorFailsPendingRequests) {
+    std::vector<LoadHandle<Model>> handles;
+    {
+        AsyncLoader loader(1);
+        for (size_t i = 0; i < AsyncLoader::kMaxStagedAssets * 4; ++i) {
+            handles.push_back(loader.loadOBJ(tempPath("renderengine_missing_" + std::to_string(i) + ".obj")));
+        }
+    }
+    for (const auto& handle : handles) {
+        CHECK(handle.hasFailed());
+    }
+}
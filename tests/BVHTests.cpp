@@ -0,0 +1,239 @@
+#include "Test.h"
+#include "AllocationCounter.h"
+#include "BVH.h"
+#include "Frustum.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+struct Sphere {
+    glm::vec3 center;
+    float radius;
+    bool active;
+};
+
+std::vector<Sphere> makeSpheres(size_t count, float extent, std::mt19937& rng) {
+    std::uniform_real_distribution<float> position(-extent, extent);
+    std::uniform_real_distribution<float> radius(0.1f, 1.0f);
+    std::vector<Sphere> spheres(count);
+    for (auto& sphere : spheres) {
+        sphere = {glm::vec3(position(rng), position(rng), position(rng)), radius(rng), true};
+    }
+    return spheres;
+}
+
+std::vector<BVH::Id> querySphere(const BVH& bvh, const glm::vec3& center, float radius) {
+    std::vector<BVH::Id> ids;
+    bvh.forEachInSphere(center, radius, [&](BVH::Id id) { ids.push_back(id); });
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+std::vector<BVH::Id> bruteForceSphere(const std::vector<Sphere>& spheres, const glm::vec3& center, float radius) {
+    std::vector<BVH::Id> ids;
+    for (size_t id = 0; id < spheres.size(); ++id) {
+        glm::vec3 d = spheres[id].center - center;
+        float r = radius + spheres[id].radius;
+        if (spheres[id].active && glm::dot(d, d) < r * r) {
+            ids.push_back(static_cast<BVH::Id>(id));
+        }
+    }
+    return ids;
+}
+
+// Nearest sphere hit by a normalized ray, or -1
+long bruteForceRay(const std::vector<Sphere>& spheres, const glm::vec3& origin, const glm::vec3& direction) {
+    float nearest = std::numeric_limits<float>::infinity();
+    long hit = -1;
+    for (size_t id = 0; id < spheres.size(); ++id) {
+        if (!spheres[id].active) continue;
+        glm::vec3 oc = origin - spheres[id].center;
+        float b = glm::dot(oc, direction);
+        float c = glm::dot(oc, oc) - spheres[id].radius * spheres[id].radius;
+        float discriminant = b * b - c;
+        if (discriminant < 0.0f) continue;
+        float t = -b - std::sqrt(discriminant);
+        if (t < 0.0f) t = -b + std::sqrt(discriminant);
+        if (t >= 0.0f && t < nearest) {
+            nearest = t;
+            hit = static_cast<long>(id);
+        }
+    }
+    return hit;
+}
+
+// Compares sphere, ray and frustum queries with a linear scan
+void checkQueries(const BVH& bvh, const std::vector<Sphere>& spheres, std::mt19937& rng) {
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> radius(0.5f, 10.0f);
+    for (int query = 0; query < 100; ++query) {
+        glm::vec3 center(position(rng), position(rng), position(rng));
+        float r = radius(rng);
+        CHECK(querySphere(bvh, center, r) == bruteForceSphere(spheres, center, r));
+
+        glm::vec3 direction = glm::normalize(glm::vec3(position(rng), position(rng), position(rng)));
+        BVH::Id hitId = 0;
+        float hitDistance = 0.0f;
+        bool hit = bvh.raycast(center, direction, 1000.0f, hitId, hitDistance);
+        long expected = bruteForceRay(spheres, center, direction);
+        CHECK(hit == (expected >= 0));
+        CHECK(!hit || static_cast<long>(hitId) == expected);
+    }
+
+    Frustum frustum(glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 80.0f) *
+                    glm::lookAt(glm::vec3(0.0f, 0.0f, 60.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    std::vector<BVH::Id> visible;
+    bvh.forEachInFrustum(frustum, 0.0f, [&](BVH::Id id) { visible.push_back(id); });
+    std::sort(visible.begin(), visible.end());
+    std::vector<BVH::Id> expected;
+    for (size_t id = 0; id < spheres.size(); ++id) {
+        if (spheres[id].active && frustum.intersectsSphere(spheres[id].center, spheres[id].radius)) {
+            expected.push_back(static_cast<BVH::Id>(id));
+        }
+    }
+    CHECK(visible == expected);
+}
+
+} // namespace
+
+TEST_CASE(bvhQueriesMatchLinearScan) {
+    std::mt19937 rng(3);
+    std::vector<Sphere> spheres = makeSpheres(5000, 50.0f, rng);
+    BVH bvh;
+    for (size_t id = 0; id < spheres.size(); ++id) {
+        bvh.insert(static_cast<BVH::Id>(id), spheres[id].center, spheres[id].radius);
+    }
+    bvh.rebuild();
+    CHECK(bvh.getPendingCount() == 0);
+    checkQueries(bvh, spheres, rng);
+
+    // Removed objects disappear at once; reinserted ones are pending until
+    // the next build
+    for (size_t id = 0; id < spheres.size(); id += 7) {
+        bvh.remove(static_cast<BVH::Id>(id));
+        spheres[id].active = false;
+    }
+    for (size_t id = 0; id < spheres.size(); id += 14) {
+        bvh.insert(static_cast<BVH::Id>(id), spheres[id].center, spheres[id].radius);
+        spheres[id].active = true;
+    }
+    CHECK(bvh.getPendingCount() > 0);
+    checkQueries(bvh, spheres, rng);
+
+    bvh.requestRebuild();
+    CHECK(bvh.isRebuilding());
+    while (!bvh.pollRebuild()) {
+        std::this_thread::yield();
+    }
+    CHECK(!bvh.isRebuilding());
+    CHECK(bvh.getPendingCount() == 0);
+    checkQueries(bvh, spheres, rng);
+}
+
+TEST_CASE(bvhRefitFollowsMovingObjects) {
+    std::mt19937 rng(5);
+    std::vector<Sphere> spheres = makeSpheres(2000, 50.0f, rng);
+    BVH bvh;
+    for (size_t id = 0; id < spheres.size(); ++id) {
+        bvh.insert(static_cast<BVH::Id>(id), spheres[id].center, spheres[id].radius);
+    }
+    bvh.rebuild();
+
+    // Move a fifth of the objects far enough to leave their leaves' bounds,
+    // as a bobbing or drifting object would over time
+    for (size_t id = 0; id < spheres.size(); id += 5) {
+        spheres[id].center += glm::vec3(20.0f, -10.0f, 5.0f);
+        bvh.update(static_cast<BVH::Id>(id), spheres[id].center, spheres[id].radius);
+    }
+    bvh.refit();
+    CHECK(bvh.getPendingCount() == 0);
+    checkQueries(bvh, spheres, rng);
+}
+
+TEST_CASE(bvhRebuildDoesNotAllocateAfterReserve) {
+    std::mt19937 rng(9);
+    std::vector<Sphere> spheres = makeSpheres(4000, 50.0f, rng);
+    BVH bvh;
+    bvh.reserve(spheres.size());
+    for (size_t id = 0; id < spheres.size(); id += 2) {
+        bvh.insert(static_cast<BVH::Id>(id), spheres[id].center, spheres[id].radius);
+    }
+    bvh.rebuild();
+
+    // Counts the worker thread's allocations as well
+    std::uint64_t before = AllocationCounter::getCount();
+    for (int round = 0; round < 4; ++round) {
+        for (size_t id = round % 2; id < spheres.size(); id += 2) {
+            bvh.remove(static_cast<BVH::Id>(id));
+            bvh.insert(static_cast<BVH::Id>(id ^ 1), spheres[id ^ 1].center, spheres[id ^ 1].radius);
+        }
+        bvh.requestRebuild();
+        while (!bvh.pollRebuild()) {
+            std::this_thread::yield();
+        }
+        bvh.rebuild();
+    }
+    CHECK(AllocationCounter::getCount() == before);
+}
+
+BENCHMARK(bvhThroughput) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (size_t count : {size_t(1000), size_t(10000), size_t(100000), size_t(1000000)}) {
+        // Constant density, like a world that grows with its content
+        float extent = 10.0f * std::cbrt(static_cast<float>(count));
+        std::vector<Sphere> spheres = makeSpheres(count, extent, rng);
+        BVH bvh;
+        bvh.reserve(count);
+        for (size_t id = 0; id < count; ++id) {
+            bvh.insert(static_cast<BVH::Id>(id), spheres[id].center, spheres[id].radius);
+        }
+
+        double buildMs = Test::measureMilliseconds([&]() { bvh.rebuild(); });
+        double refitMs = Test::measureMilliseconds([&]() { bvh.refit(); });
+
+        const int queries = 100000;
+        std::vector<glm::vec3> points(queries);
+        std::vector<glm::vec3> directions(queries);
+        for (int i = 0; i < queries; ++i) {
+            points[i] = glm::vec3(unit(rng), unit(rng), unit(rng)) * extent;
+            directions[i] = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+        }
+
+        size_t found = 0;
+        double sphereMs = Test::measureMilliseconds([&]() {
+            for (const glm::vec3& point : points) {
+                bvh.forEachInSphere(point, 2.0f, [&](BVH::Id) { found++; });
+            }
+        });
+        double rayMs = Test::measureMilliseconds([&]() {
+            BVH::Id id = 0;
+            float distance = 0.0f;
+            for (int i = 0; i < queries; ++i) {
+                found += bvh.raycast(points[i], directions[i], 50.0f, id, distance) ? 1 : 0;
+            }
+        });
+        Frustum frustum(glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, extent) *
+                        glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+        const int frustumQueries = 20;
+        double frustumMs = Test::measureMilliseconds([&]() {
+            for (int i = 0; i < frustumQueries; ++i) {
+                bvh.forEachInFrustum(frustum, 0.0f, [&](BVH::Id) { found++; });
+            }
+        }) / frustumQueries;
+        Test::keep(static_cast<double>(found));
+
+        std::cout << count << " objects: build " << buildMs << " ms, refit " << refitMs << " ms, "
+                  << queries / sphereMs / 1000.0 << " M sphere queries/s, " << queries / rayMs / 1000.0
+                  << " M rays/s, frustum query " << frustumMs << " ms" << std::endl;
+    }
+}
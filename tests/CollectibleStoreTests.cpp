@@ -0,0 +1,114 @@
+#include "Test.h"
+#include "CollectibleStore.h"
+#include "GameObject.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+constexpr float kTickDelta = 1.0f / 60.0f;
+
+} // namespace
+
+TEST_CASE(collectibleRemovalKeepsArraysDense) {
+    CollectibleStore store(4);
+    CollectibleStore::Handle a = store.add(glm::vec3(1.0f), glm::vec3(0.3f), 0.0f, 0.0f);
+    CollectibleStore::Handle b = store.add(glm::vec3(2.0f), glm::vec3(0.3f), 0.0f, 0.0f);
+    CollectibleStore::Handle c = store.add(glm::vec3(3.0f), glm::vec3(0.3f), 0.0f, 0.0f);
+
+    CHECK(store.remove(a));
+    CHECK(store.size() == 2);
+    // The last object moved into the hole and its handle follows it
+    CHECK(store.getIndex(c) == 0);
+    CHECK(store.getPositions()[store.getIndex(c)] == glm::vec3(3.0f));
+    CHECK(store.getPositions()[store.getIndex(b)] == glm::vec3(2.0f));
+}
+
+TEST_CASE(collectibleHandlesExpireWithTheirObject) {
+    CollectibleStore store(1);
+    CollectibleStore::Handle first = store.add(glm::vec3(0.0f), glm::vec3(0.3f), 0.0f, 0.0f);
+    CHECK(store.full());
+    CHECK(store.add(glm::vec3(0.0f), glm::vec3(0.3f), 0.0f, 0.0f) == CollectibleStore::kInvalidHandle);
+
+    CHECK(store.remove(first));
+    CHECK(!store.remove(first));
+
+    // The slot is reused under a new generation
+    CollectibleStore::Handle second = store.add(glm::vec3(0.0f), glm::vec3(0.3f), 0.0f, 0.0f);
+    CHECK(second.slot == first.slot);
+    CHECK(!store.isValid(first));
+    CHECK(store.isValid(second));
+}
+
+TEST_CASE(modelRadiusScalesBoundingRadii) {
+    CollectibleStore store(2);
+    CollectibleStore::Handle a = store.add(glm::vec3(0.0f), glm::vec3(0.3f, 0.4f, 0.2f), 0.0f, 0.0f);
+    CHECK(store.getBoundingRadii()[store.getIndex(a)] == 0.5f * 0.4f);
+
+    // A loaded model twice the unit sphere's size doubles existing and new radii
+    store.setModelRadius(1.0f);
+    CollectibleStore::Handle b = store.add(glm::vec3(1.0f), glm::vec3(0.3f), 0.0f, 0.0f);
+    CHECK(store.getBoundingRadii()[store.getIndex(a)] == 0.4f);
+    CHECK(store.getBoundingRadii()[store.getIndex(b)] == 0.3f);
+}
+
+BENCHMARK(collectibleStoreLayout) {
+    const size_t count = 100000;
+    const int ticks = 100;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+
+    CollectibleStore store(count);
+    std::vector<std::shared_ptr<GameObject>> objects;
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 center(position(rng), 0.5f, position(rng));
+        store.add(center, glm::vec3(0.35f), 0.0f, 0.0f);
+        objects.push_back(std::make_shared<GameObject>(nullptr, center, glm::vec3(0.35f)));
+    }
+    // Respawns leave the objects scattered across the heap rather than in
+    // allocation order
+    std::shuffle(objects.begin(), objects.end(), rng);
+
+    // One tick: animate everything, then test every object against the camera sphere
+    const glm::vec3 camera(0.0f, 2.0f, 0.0f);
+    const float reach = 0.8f;
+    double objectMs = Test::measureMilliseconds([&]() {
+        size_t hits = 0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            for (const auto& object : objects) {
+                object->update(kTickDelta);
+            }
+            for (const auto& object : objects) {
+                if (object->isCollected()) continue;
+                float r = reach + object->getBoundingRadius();
+                glm::vec3 d = object->getPosition() - camera;
+                hits += glm::dot(d, d) < r * r ? 1 : 0;
+            }
+        }
+        Test::keep(static_cast<double>(hits));
+    }) / ticks;
+
+    double storeMs = Test::measureMilliseconds([&]() {
+        size_t hits = 0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            store.update(kTickDelta);
+            const auto& positions = store.getPositions();
+            const auto& radii = store.getBoundingRadii();
+            for (size_t i = 0; i < store.size(); ++i) {
+                if (store.isCollected(i)) continue;
+                float r = reach + radii[i];
+                glm::vec3 d = positions[i] - camera;
+                hits += glm::dot(d, d) < r * r ? 1 : 0;
+            }
+        }
+        Test::keep(static_cast<double>(hits));
+    }) / ticks;
+
+    std::cout << count << " collectibles, update + collision scan per tick: vector<shared_ptr<GameObject>> "
+              << objectMs << " ms, CollectibleStore " << storeMs << " ms" << std::endl;
+}
@@ -0,0 +1,195 @@
+#include "Test.h"
+#include "CookedMesh.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace RenderEngine;
+
+namespace {
+
+void makeGrid(int cells, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    int side = cells + 1;
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            vertices.emplace_back(glm::vec3(x * 0.5f, std::sin(x * 0.1f), y * 0.5f), glm::vec3(0.0f, 1.0f, 0.0f),
+                                  glm::vec2(static_cast<float>(x) / cells, static_cast<float>(y) / cells));
+        }
+    }
+    for (int y = 0; y < cells; ++y) {
+        for (int x = 0; x < cells; ++x) {
+            unsigned int a = y * side + x;
+            unsigned int c = a + side;
+            indices.insert(indices.end(), {a, c, a + 1, a + 1, c, c + 1});
+        }
+    }
+}
+
+std::string tempPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Two levels: a Float mesh, then a Quantized one
+bool writeTwoLevels(const std::string& path, std::vector<std::vector<CookedGeometry>>& lods) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    makeGrid(16, vertices, indices);
+    lods = {{CookedMeshFile::cook(vertices, indices, VertexPacking::Float)},
+            {CookedMeshFile::cook(vertices, indices, VertexPacking::Quantized)}};
+    std::string error;
+    return CookedMeshFile::write(path, lods, {120.0f}, error);
+}
+
+std::vector<char> readFile(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path) || file.size() == 0) {
+        return {};
+    }
+    return std::vector<char>(file.data(), file.data() + file.size());
+}
+
+// Drops the file from the page cache so the next read comes from disk
+void evictFromPageCache(const std::string& path) {
+#ifdef __linux__
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fdatasync(fd);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+} // namespace
+
+TEST_CASE(cookedMeshRoundTrips) {
+    std::string path = tempPath("renderengine_roundtrip.rmesh");
+    std::vector<std::vector<CookedGeometry>> lods;
+    CHECK(writeTwoLevels(path, lods));
+
+    MappedFile file;
+    CHECK(file.open(path));
+    CookedMeshView view;
+    std::string error;
+    CHECK(CookedMeshFile::open(file.data(), file.size(), view, error));
+    if (!view.header) return;
+
+    CHECK(view.header->lodCount == 2);
+    CHECK(view.header->meshCount == 2);
+    CHECK(view.lods[0].screenRadius == 120.0f);
+    for (size_t i = 0; i < 2; ++i) {
+        const CookedMeshEntry& entry = view.meshes[view.lods[i].firstMesh];
+        const CookedGeometry& geometry = lods[i][0];
+        CHECK(CookedMeshFile::getVertexFormat(entry) == geometry.format);
+        CHECK(entry.vertexCount == geometry.vertexCount);
+        CHECK(entry.indexCount == geometry.indexCount);
+        CHECK(entry.vertexOffset % kCookedBlobAlignment == 0);
+        // The blobs are byte for byte what the arena uploads
+        CHECK(std::memcmp(file.data() + entry.vertexOffset, geometry.vertices.data(), geometry.vertices.size()) == 0);
+        CHECK(std::memcmp(file.data() + entry.indexOffset, geometry.indices.data(), geometry.indices.size()) == 0);
+    }
+    file.close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE(cookedMeshRejectsCorruptFiles) {
+    std::string path = tempPath("renderengine_corrupt.rmesh");
+    std::vector<std::vector<CookedGeometry>> lods;
+    CHECK(writeTwoLevels(path, lods));
+    const std::vector<char> original = readFile(path);
+    std::remove(path.c_str());
+    CHECK(!original.empty());
+    if (original.empty()) return;
+
+    CookedMeshView view;
+    std::string error;
+    CHECK(CookedMeshFile::open(original.data(), original.size(), view, error));
+    size_t tableOffset = view.header->meshTableOffset;
+    const CookedMeshEntry& entry = view.meshes[0];
+
+    auto rejects = [&](size_t size, auto corrupt) {
+        std::vector<char> data = original;
+        auto* meshes = reinterpret_cast<CookedMeshEntry*>(data.data() + tableOffset);
+        corrupt(data, *reinterpret_cast<CookedMeshHeader*>(data.data()), meshes[0]);
+        CookedMeshView corruptView;
+        std::string corruptError;
+        return !CookedMeshFile::open(data.data(), std::min(size, data.size()), corruptView, corruptError);
+    };
+    CHECK(rejects(original.size(), [](std::vector<char>&, CookedMeshHeader& header, CookedMeshEntry&) {
+        header.magic[0] = 'X';
+    }));
+    CHECK(rejects(original.size() - 16, [](std::vector<char>&, CookedMeshHeader&, CookedMeshEntry&) {}));
+    CHECK(rejects(original.size(), [](std::vector<char>&, CookedMeshHeader& header, CookedMeshEntry&) {
+        header.meshCount = 1000;
+    }));
+    CHECK(rejects(original.size(), [&](std::vector<char>&, CookedMeshHeader&, CookedMeshEntry& mesh) {
+        mesh.vertexOffset = original.size() - 8;
+    }));
+    CHECK(rejects(original.size(), [](std::vector<char>&, CookedMeshHeader&, CookedMeshEntry& mesh) {
+        mesh.attributes[2].offset = mesh.stride;
+    }));
+    CHECK(rejects(original.size(), [](std::vector<char>&, CookedMeshHeader&, CookedMeshEntry& mesh) {
+        mesh.attributes[1].location = mesh.attributes[0].location;
+    }));
+    CHECK(rejects(original.size(), [&](std::vector<char>& data, CookedMeshHeader&, CookedMeshEntry&) {
+        // All ones is past the last vertex at either index width
+        std::memset(data.data() + entry.indexOffset, 0xFF, 4);
+    }));
+}
+
+BENCHMARK(cookedMeshLoading) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    // About 4M vertices
+    makeGrid(2000, vertices, indices);
+    std::vector<std::vector<CookedGeometry>> lods = {
+        {CookedMeshFile::cook(std::move(vertices), std::move(indices), VertexPacking::Quantized, false)}};
+    std::string path = tempPath("renderengine_bench.rmesh");
+    std::string error;
+    if (!CookedMeshFile::write(path, lods, {}, error)) {
+        std::cout << error << std::endl;
+        return;
+    }
+
+    // Map, validate and touch every page, as uploading the blobs would
+    auto load = [&]() {
+        return Test::measureMilliseconds([&]() {
+            MappedFile file;
+            CookedMeshView view;
+            std::string openError;
+            if (!file.open(path) || !CookedMeshFile::open(file.data(), file.size(), view, openError)) {
+                return;
+            }
+            unsigned long sum = 0;
+            for (size_t offset = 0; offset < file.size(); offset += 4096) {
+                sum += static_cast<unsigned char>(file.data()[offset]);
+            }
+            Test::keep(static_cast<double>(sum));
+        });
+    };
+
+    evictFromPageCache(path);
+    double coldMs = load();
+    double warmMs = load();
+#ifdef __linux__
+    const char* cold = "cold page cache";
+#else
+    const char* cold = "first load (page cache not dropped on this platform)";
+#endif
+    std::cout << "Cooked mesh, " << std::filesystem::file_size(path) / (1024.0 * 1024.0) << " MiB: " << cold << " "
+              << coldMs << " ms, warm page cache " << warmMs << " ms" << std::endl;
+    std::remove(path.c_str());
+}
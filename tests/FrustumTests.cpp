@@ -0,0 +1,111 @@
+#include "Test.h"
+#include "Frustum.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+struct Spheres {
+    std::vector<glm::vec3> centers;
+    std::vector<float> radii;
+};
+
+Spheres makeSpheres(size_t count, float extent, std::mt19937& rng) {
+    std::uniform_real_distribution<float> position(-extent, extent);
+    std::uniform_real_distribution<float> radius(0.1f, 2.0f);
+    Spheres spheres;
+    spheres.centers.resize(count);
+    spheres.radii.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        spheres.centers[i] = glm::vec3(position(rng), position(rng), position(rng));
+        spheres.radii[i] = radius(rng);
+    }
+    return spheres;
+}
+
+Frustum makeFrustum(float farPlane) {
+    return Frustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, farPlane) *
+                   glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(1.0f, 1.5f, -3.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+}
+
+// Distance of a sphere's surface from the closest plane
+float closestPlaneDistance(const Frustum& frustum, const glm::vec3& center, float radius) {
+    float closest = std::numeric_limits<float>::infinity();
+    for (int i = 0; i < 6; ++i) {
+        const glm::vec4& plane = frustum.getPlane(i);
+        closest = std::min(closest, std::fabs(plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w + radius));
+    }
+    return closest;
+}
+
+} // namespace
+
+TEST_CASE(simdCullingMatchesIntersectsSphere) {
+    std::mt19937 rng(21);
+    Frustum frustum = makeFrustum(100.0f);
+    // Odd count so the scalar tail after the last full SIMD group runs too
+    for (size_t count : {size_t(1), size_t(7), size_t(13), size_t(10001)}) {
+        Spheres spheres = makeSpheres(count, 80.0f, rng);
+        for (float margin : {0.0f, 0.5f}) {
+            std::vector<uint32_t> visible(count);
+            size_t visibleCount = frustum.cullSpheres(spheres.centers.data(), spheres.radii.data(), count,
+                                                      margin, visible.data());
+            visible.resize(visibleCount);
+            CHECK(std::is_sorted(visible.begin(), visible.end()));
+
+            for (size_t i = 0; i < count; ++i) {
+                bool expected = frustum.intersectsSphere(spheres.centers[i], spheres.radii[i] + margin);
+                bool found = std::binary_search(visible.begin(), visible.end(), static_cast<uint32_t>(i));
+                // The SIMD paths sum the plane terms in a different order, so
+                // spheres touching a plane may round either way
+                CHECK(found == expected ||
+                      closestPlaneDistance(frustum, spheres.centers[i], spheres.radii[i] + margin) < 1e-3f);
+            }
+        }
+    }
+}
+
+BENCHMARK(frustumCulling) {
+    std::mt19937 rng(23);
+    Frustum frustum = makeFrustum(150.0f);
+    std::cout << "Frustum culling with the " << Frustum::getSimdPath() << " path:" << std::endl;
+    for (size_t count : {size_t(1000), size_t(10000), size_t(100000), size_t(1000000)}) {
+        Spheres spheres = makeSpheres(count, 150.0f, rng);
+        std::vector<uint32_t> visible(count);
+        int passes = static_cast<int>(std::max<size_t>(1, 20000000 / count));
+
+        size_t scalarCount = 0;
+        double scalarMs = Test::measureMilliseconds([&]() {
+            for (int pass = 0; pass < passes; ++pass) {
+                scalarCount = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    if (frustum.intersectsSphere(spheres.centers[i], spheres.radii[i])) {
+                        visible[scalarCount++] = static_cast<uint32_t>(i);
+                    }
+                }
+            }
+            Test::keep(static_cast<double>(visible[0]));
+        }) / passes;
+
+        size_t simdCount = 0;
+        double simdMs = Test::measureMilliseconds([&]() {
+            for (int pass = 0; pass < passes; ++pass) {
+                simdCount = frustum.cullSpheres(spheres.centers.data(), spheres.radii.data(), count, 0.0f,
+                                                visible.data());
+            }
+            Test::keep(static_cast<double>(visible[0]));
+        }) / passes;
+
+        std::cout << "  " << count << " spheres: " << simdCount << " visible, " << count - simdCount
+                  << " culled (scalar " << scalarCount << " visible); scalar " << scalarMs * 1e6 / count
+                  << " ns/object, " << Frustum::getSimdPath() << " " << simdMs * 1e6 / count << " ns/object"
+                  << std::endl;
+    }
+}
@@ -0,0 +1,102 @@
+#include "Test.h"
+#include "AllocationCounter.h"
+#include "Game.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+using namespace RenderEngine;
+
+namespace {
+
+// Dense enough that the synthetic camera collects, and so respawns, often
+GameSettings makeSoakSettings() {
+    GameSettings settings;
+    settings.headless = true;
+    settings.headlessFrames = 20000;
+    settings.maxCollectibles = 2000;
+    settings.worldSize = 30.0f;
+    settings.seed = 42;
+    return settings;
+}
+
+} // namespace
+
+TEST_CASE(gameUpdateDoesNotAllocate) {
+    CHECK(AllocationCounter::isEnabled());
+
+    Game game(makeSoakSettings());
+    CHECK(game.initialize());
+    game.run();
+
+    CHECK(game.getCollectiblesCollected() > 0);
+    CHECK(game.getUpdateAllocations() == 0);
+}
+
+// Long enough for respawns to trigger several background rebuilds
+TEST_CASE(gameUpdateWithBvhDoesNotAllocate) {
+    GameSettings settings = makeSoakSettings();
+    settings.useBvh = true;
+    Game game(settings);
+    CHECK(game.initialize());
+    game.run();
+
+    CHECK(game.getCollectiblesCollected() > 0);
+    CHECK(game.getUpdateAllocations() == 0);
+}
+
+// Zones come from PROFILE_SCOPE's TraceScope, so this holds with the
+// profiler compiled out as well
+TEST_CASE(headlessTraceRecordsZones) {
+    std::string path = (std::filesystem::temp_directory_path() / "renderengine_trace.json").string();
+    GameSettings settings = makeSoakSettings();
+    settings.headlessFrames = 200;
+    settings.tracePath = path;
+    {
+        Game game(settings);
+        CHECK(game.initialize());
+        game.run();
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::string trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    CHECK(trace.find("{\"name\":\"update\",\"ph\":\"X\"") != std::string::npos);
+    CHECK(trace.find("{\"name\":\"checkCollisions\",\"ph\":\"X\"") != std::string::npos);
+    CHECK(trace.find("\"name\":\"Frame 199\"") != std::string::npos);
+    CHECK(trace.size() > 4 && trace.compare(trace.size() - 4, 4, "\n]}\n") == 0);
+    file.close();
+    std::filesystem::remove(path);
+}
+
+BENCHMARK(traceOverhead) {
+    std::string path = (std::filesystem::temp_directory_path() / "renderengine_overhead.json").string();
+    GameSettings settings = makeSoakSettings();
+
+    // Best of three for each, alternating so drift affects both alike
+    double plainMs = 1e30;
+    double tracedMs = 1e30;
+    for (int round = 0; round < 3; ++round) {
+        for (bool traced : {false, true}) {
+            settings.tracePath = traced ? path : std::string();
+            Game game(settings);
+            game.initialize();
+            double& best = traced ? tracedMs : plainMs;
+            best = std::min(best, Test::measureMilliseconds([&]() { game.run(); }));
+        }
+    }
+    std::uintmax_t traceBytes = std::filesystem::file_size(path);
+    std::filesystem::remove(path);
+
+    // A headless tick is only microseconds long, so the cost is also given
+    // against the 16.7 ms frame budget of a windowed 60 Hz run
+    double ticks = static_cast<double>(settings.headlessFrames);
+    double costUs = (tracedMs - plainMs) * 1000.0 / ticks;
+    std::cout << "Headless " << settings.headlessFrames << " ticks, " << settings.maxCollectibles
+              << " collectibles: untraced " << plainMs << " ms, traced " << tracedMs << " ms; tracing costs "
+              << costUs << " us per tick (" << (tracedMs - plainMs) / plainMs * 100.0 << "% of a headless tick, "
+              << costUs / (1e6 / 60.0) * 100.0 << "% of a 60 Hz frame), trace " << traceBytes / 1024 << " KB"
+              << std::endl;
+}
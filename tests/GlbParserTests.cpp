@@ -0,0 +1,206 @@
+#include "Test.h"
+#include "AllocationCounter.h"
+#include "GlbParser.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+constexpr std::uint32_t kGlbMagic = 0x46546C67;
+constexpr std::uint32_t kJsonChunk = 0x4E4F534A;
+constexpr std::uint32_t kBinChunk = 0x004E4942;
+
+void appendU32(std::vector<char>& out, std::uint32_t value) {
+    char bytes[4];
+    std::memcpy(bytes, &value, sizeof(bytes));
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+void appendBytes(std::vector<char>& out, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+// A cells x cells grid in the xz plane
+void makeGrid(int cells, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    int side = cells + 1;
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            vertices.emplace_back(glm::vec3(x * 0.5f, std::sin(x * 0.1f), y * 0.5f), glm::vec3(0.0f, 1.0f, 0.0f),
+                                  glm::vec2(static_cast<float>(x) / cells, static_cast<float>(y) / cells));
+        }
+    }
+    for (int y = 0; y < cells; ++y) {
+        for (int x = 0; x < cells; ++x) {
+            unsigned int a = y * side + x;
+            unsigned int c = a + side;
+            indices.insert(indices.end(), {a, c, a + 1, a + 1, c, c + 1});
+        }
+    }
+}
+
+// One mesh with one primitive. Interleaved files keep the vertices in
+// one strided buffer view, as most exporters write them; planar files
+// give every attribute a tightly packed view of its own.
+std::vector<char> makeGlb(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                          bool interleaved) {
+    std::vector<char> bin;
+    std::string views;
+    std::string accessors;
+    std::string count = std::to_string(vertices.size());
+
+    if (interleaved) {
+        appendBytes(bin, vertices.data(), vertices.size() * sizeof(Vertex));
+        views = "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" + std::to_string(bin.size()) +
+                ",\"byteStride\":" + std::to_string(sizeof(Vertex)) + "}";
+        accessors = "{\"bufferView\":0,\"byteOffset\":0,\"componentType\":5126,\"type\":\"VEC3\",\"count\":" + count +
+                    "},{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"type\":\"VEC3\",\"count\":" +
+                    count + "},{\"bufferView\":0,\"byteOffset\":24,\"componentType\":5126,\"type\":\"VEC2\",\"count\":" +
+                    count + "}";
+    } else {
+        const char* types[] = {"VEC3", "VEC3", "VEC2"};
+        for (int attribute = 0; attribute < 3; ++attribute) {
+            size_t offset = bin.size();
+            for (const Vertex& vertex : vertices) {
+                const float* values = attribute == 0 ? &vertex.position.x :
+                                      attribute == 1 ? &vertex.normal.x : &vertex.texCoords.x;
+                appendBytes(bin, values, sizeof(float) * (attribute == 2 ? 2 : 3));
+            }
+            views += (attribute ? "," : "") + std::string("{\"buffer\":0,\"byteOffset\":") + std::to_string(offset) +
+                     ",\"byteLength\":" + std::to_string(bin.size() - offset) + "}";
+            accessors += (attribute ? "," : "") + std::string("{\"bufferView\":") + std::to_string(attribute) +
+                         ",\"componentType\":5126,\"type\":\"" + types[attribute] + "\",\"count\":" + count + "}";
+        }
+    }
+
+    int indexView = interleaved ? 1 : 3;
+    size_t indexOffset = bin.size();
+    appendBytes(bin, indices.data(), indices.size() * sizeof(unsigned int));
+    views += ",{\"buffer\":0,\"byteOffset\":" + std::to_string(indexOffset) + ",\"byteLength\":" +
+             std::to_string(bin.size() - indexOffset) + "}";
+    accessors += ",{\"bufferView\":" + std::to_string(indexView) +
+                 ",\"componentType\":5125,\"type\":\"SCALAR\",\"count\":" + std::to_string(indices.size()) + "}";
+
+    std::string json = "{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":" + std::to_string(bin.size()) +
+                       "}],\"bufferViews\":[" + views + "],\"accessors\":[" + accessors +
+                       "],\"meshes\":[{\"name\":\"grid\",\"primitives\":[{\"attributes\":"
+                       "{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}]}";
+    while (json.size() % 4 != 0) {
+        json += ' ';
+    }
+    while (bin.size() % 4 != 0) {
+        bin.push_back('\0');
+    }
+
+    std::vector<char> glb;
+    appendU32(glb, kGlbMagic);
+    appendU32(glb, 2);
+    appendU32(glb, static_cast<std::uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+    appendU32(glb, static_cast<std::uint32_t>(json.size()));
+    appendU32(glb, kJsonChunk);
+    appendBytes(glb, json.data(), json.size());
+    appendU32(glb, static_cast<std::uint32_t>(bin.size()));
+    appendU32(glb, kBinChunk);
+    appendBytes(glb, bin.data(), bin.size());
+    return glb;
+}
+
+bool sameVertices(const std::vector<Vertex>& a, const std::vector<Vertex>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!(a[i].position == b[i].position) || !(a[i].normal == b[i].normal) ||
+            a[i].texCoords.x != b[i].texCoords.x || a[i].texCoords.y != b[i].texCoords.y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE(glbLayoutsDecodeAlike) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    makeGrid(20, vertices, indices);
+
+    for (bool interleaved : {true, false}) {
+        std::vector<char> glb = makeGlb(vertices, indices, interleaved);
+        std::vector<GltfMesh> meshes;
+        std::string error;
+        std::vector<std::string> warnings;
+        CHECK(GlbParser::parse(glb.data(), glb.size(), meshes, error, &warnings));
+        CHECK(warnings.empty());
+        CHECK(meshes.size() == 1 && meshes[0].primitives.size() == 1);
+        if (meshes.size() != 1 || meshes[0].primitives.size() != 1) continue;
+
+        // Accessors point into the file rather than at copies
+        const GltfPrimitive& primitive = meshes[0].primitives[0];
+        CHECK(meshes[0].name == "grid");
+        CHECK(primitive.position.stride == (interleaved ? sizeof(Vertex) : 12));
+        CHECK(primitive.position.data >= reinterpret_cast<const unsigned char*>(glb.data()) &&
+              primitive.position.data < reinterpret_cast<const unsigned char*>(glb.data() + glb.size()));
+
+        std::vector<Vertex> decoded;
+        std::vector<unsigned int> decodedIndices;
+        GlbParser::decode(primitive, decoded, decodedIndices);
+        CHECK(sameVertices(decoded, vertices));
+        CHECK(decodedIndices == indices);
+    }
+}
+
+TEST_CASE(glbParserRejectsBadFiles) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    makeGrid(2, vertices, indices);
+    std::vector<GltfMesh> meshes;
+    std::string error;
+
+    std::vector<char> glb = makeGlb(vertices, indices, true);
+    CHECK(!GlbParser::parse(glb.data(), glb.size() - 16, meshes, error));
+    CHECK(error == "File is truncated");
+
+    glb[0] = 'x';
+    CHECK(!GlbParser::parse(glb.data(), glb.size(), meshes, error));
+
+    // A primitive with an index past its vertices is skipped, not returned
+    indices[4] = static_cast<unsigned int>(vertices.size());
+    glb = makeGlb(vertices, indices, false);
+    std::vector<std::string> warnings;
+    CHECK(GlbParser::parse(glb.data(), glb.size(), meshes, error, &warnings));
+    CHECK(meshes.empty());
+    CHECK(warnings.size() == 1);
+}
+
+BENCHMARK(glbLoading) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    // About 1M vertices and 2M triangles
+    makeGrid(1000, vertices, indices);
+
+    // The process peak includes building the files, so the decoded size is
+    // reported next to it; parsing itself copies no vertex data
+    for (bool interleaved : {true, false}) {
+        std::vector<char> glb = makeGlb(vertices, indices, interleaved);
+        std::vector<GltfMesh> meshes;
+        std::string error;
+        double parseMs = Test::measureMilliseconds([&]() { GlbParser::parse(glb.data(), glb.size(), meshes, error); });
+        std::vector<Vertex> decoded;
+        std::vector<unsigned int> decodedIndices;
+        double decodeMs = Test::measureMilliseconds([&]() {
+            GlbParser::decode(meshes[0].primitives[0], decoded, decodedIndices);
+        });
+        Test::keep(decoded.back().position.x);
+
+        size_t decodedBytes = decoded.size() * sizeof(Vertex) + decodedIndices.size() * sizeof(unsigned int);
+        std::cout << (interleaved ? "Interleaved" : "Planar") << " GLB, " << glb.size() / (1024.0 * 1024.0)
+                  << " MiB: parse " << parseMs << " ms, decode " << decodeMs << " ms into "
+                  << decodedBytes / (1024.0 * 1024.0) << " MiB, peak RSS "
+                  << AllocationCounter::getPeakResidentBytes() / (1024.0 * 1024.0) << " MiB" << std::endl;
+    }
+}
@@ -0,0 +1,112 @@
+#include "Test.h"
+#include "CollectibleStore.h"
+#include "Game.h"
+#include "GameObject.h"
+#include "Model.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+void fillStore(CollectibleStore& store, size_t count) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+    store.reset(count);
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 center(position(rng), 0.5f, position(rng));
+        store.add(center, glm::vec3(0.35f), angle(rng), angle(rng) * 0.01f);
+    }
+}
+
+std::vector<std::uint32_t> allIndices(const CollectibleStore& store) {
+    std::vector<std::uint32_t> indices(store.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = static_cast<std::uint32_t>(i);
+    }
+    return indices;
+}
+
+// CPU side of the former per-object path: a model matrix per collectible,
+// each followed by nine uniform uploads and its own draw call
+glm::mat4 buildModelMatrix(const glm::vec3& position, const glm::vec3& scale, float rotation, float bobOffset) {
+    float bob = std::sin(bobOffset) * GameObject::kBobAmplitude;
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), position + glm::vec3(0.0f, bob, 0.0f));
+    model = glm::rotate(model, glm::radians(rotation), glm::vec3(0.0f, 1.0f, 0.0f));
+    return glm::scale(model, scale);
+}
+
+} // namespace
+
+TEST_CASE(instancePackingCoversEveryCollectible) {
+    CollectibleStore store;
+    fillStore(store, 100);
+    store.setCollected(3, true);
+    // Every other object visible, the collected one among them
+    std::vector<std::uint32_t> visible;
+    for (std::uint32_t i = 1; i < store.size(); i += 2) {
+        visible.push_back(i);
+    }
+
+    Model model;
+    std::vector<std::vector<CollectibleInstance>> instances(model.getLodCount());
+    packCollectibleInstances(store, visible.data(), visible.size(), model, glm::vec3(0.0f), 500.0f, 0.0f, instances);
+
+    CHECK(instances.size() == 1);
+    CHECK(instances[0].size() == visible.size() - 1);
+    CHECK(instances[0][0].positionRotation == glm::vec4(store.getPositions()[1], store.getRotations()[1]));
+    CHECK(instances[0][1].positionRotation == glm::vec4(store.getPositions()[5], store.getRotations()[5]));
+    CHECK(instances[0][3].scaleBobPhase == glm::vec4(store.getScales()[9], store.getBobOffsets()[9]));
+
+    // Packing again starts from empty lists; lag rewinds the animation
+    const float lag = 0.01f;
+    packCollectibleInstances(store, visible.data(), visible.size(), model, glm::vec3(0.0f), 500.0f, lag, instances);
+    CHECK(instances[0].size() == visible.size() - 1);
+    CHECK(instances[0][0].positionRotation.w ==
+          store.getRotations()[1] - GameObject::kDefaultRotationSpeed * lag);
+    CHECK(instances[0][0].scaleBobPhase.w == store.getBobOffsets()[1] - GameObject::kDefaultBobSpeed * lag);
+    CHECK(store.getLodLevel(1) == 0);
+}
+
+BENCHMARK(collectibleSubmission) {
+    std::cout << "Collectible submission per frame, CPU side without the GL calls:" << std::endl;
+    for (size_t count : {size_t(15), size_t(10000), size_t(1000000)}) {
+        CollectibleStore store;
+        fillStore(store, count);
+        const std::vector<std::uint32_t> visible = allIndices(store);
+        Model model;
+        std::vector<std::vector<CollectibleInstance>> instances(model.getLodCount());
+        instances[0].reserve(count);
+        int frames = static_cast<int>(std::max<size_t>(1, 20000000 / (count * 50)));
+
+        double perObject = Test::measureMilliseconds([&]() {
+            float sum = 0.0f;
+            for (int frame = 0; frame < frames; ++frame) {
+                for (size_t i = 0; i < store.size(); ++i) {
+                    glm::mat4 model = buildModelMatrix(store.getPositions()[i], store.getScales()[i],
+                                                       store.getRotations()[i], store.getBobOffsets()[i]);
+                    sum += model[3][1];
+                }
+            }
+            Test::keep(sum);
+        }) / frames;
+
+        double instanced = Test::measureMilliseconds([&]() {
+            for (int frame = 0; frame < frames; ++frame) {
+                packCollectibleInstances(store, visible.data(), visible.size(), model, glm::vec3(0.0f),
+                                         500.0f, 0.0f, instances);
+            }
+            Test::keep(instances[0].back().positionRotation.x);
+        }) / frames;
+
+        std::cout << "  " << count << " collectibles: per-object " << perObject << " ms (" << count
+                  << " draws, " << count * 9 << " uniform calls), instanced " << instanced << " ms (1 draw, "
+                  << instances[0].size() * sizeof(CollectibleInstance) << " bytes uploaded)" << std::endl;
+    }
+}
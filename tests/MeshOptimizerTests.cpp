@@ -0,0 +1,148 @@
+#include "Test.h"
+#include "MeshOptimizer.h"
+#include "Vertex.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+// Same grid as Model::createSphere, with triangles in random order so the
+// input starts with almost no cache reuse
+void makeShuffledSphere(int segments, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    const float pi = 3.14159265358979323846f;
+    vertices.clear();
+    indices.clear();
+    for (int y = 0; y <= segments; ++y) {
+        for (int x = 0; x <= segments; ++x) {
+            float xSegment = static_cast<float>(x) / static_cast<float>(segments);
+            float ySegment = static_cast<float>(y) / static_cast<float>(segments);
+            glm::vec3 position(std::cos(xSegment * 2.0f * pi) * std::sin(ySegment * pi) * 0.5f,
+                               std::cos(ySegment * pi) * 0.5f,
+                               std::sin(xSegment * 2.0f * pi) * std::sin(ySegment * pi) * 0.5f);
+            vertices.emplace_back(position, glm::normalize(position), glm::vec2(xSegment, ySegment));
+        }
+    }
+
+    std::vector<std::array<unsigned int, 3>> triangles;
+    for (int y = 0; y < segments; ++y) {
+        for (int x = 0; x < segments; ++x) {
+            unsigned int first = static_cast<unsigned int>(y * (segments + 1) + x);
+            unsigned int second = first + static_cast<unsigned int>(segments) + 1;
+            triangles.push_back({first, second, first + 1});
+            triangles.push_back({second, second + 1, first + 1});
+        }
+    }
+    std::mt19937 rng(1);
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+    for (const auto& triangle : triangles) {
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+}
+
+using VertexKey = std::array<float, 8>;
+using TriangleKey = std::array<VertexKey, 3>;
+
+VertexKey makeVertexKey(const Vertex& vertex) {
+    return {vertex.position.x, vertex.position.y, vertex.position.z, vertex.normal.x, vertex.normal.y,
+            vertex.normal.z, vertex.texCoords.x, vertex.texCoords.y};
+}
+
+// Triangles by vertex contents, each rotated to start at its smallest
+// corner: independent of vertex numbering and triangle order, but not of
+// winding
+std::vector<TriangleKey> getTriangles(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    std::vector<TriangleKey> triangles;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        TriangleKey triangle = {makeVertexKey(vertices[indices[i]]), makeVertexKey(vertices[indices[i + 1]]),
+                                makeVertexKey(vertices[indices[i + 2]])};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+} // namespace
+
+TEST_CASE(meshOptimizerKeepsEveryTriangle) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    makeShuffledSphere(32, vertices, indices);
+    const std::vector<TriangleKey> expected = getTriangles(vertices, indices);
+
+    // Each pass on its own, then the whole pipeline
+    std::vector<unsigned int> reordered = indices;
+    MeshOptimizer::optimizeVertexCache(reordered, vertices.size());
+    CHECK(getTriangles(vertices, reordered) == expected);
+    MeshOptimizer::optimizeOverdraw(reordered, vertices);
+    CHECK(getTriangles(vertices, reordered) == expected);
+
+    MeshOptimizer::optimize(vertices, indices);
+    CHECK(getTriangles(vertices, indices) == expected);
+    for (unsigned int index : indices) {
+        CHECK(index < vertices.size());
+    }
+}
+
+TEST_CASE(meshOptimizerDropsUnreferencedVertices) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    makeShuffledSphere(8, vertices, indices);
+    const size_t used = vertices.size();
+    const std::vector<TriangleKey> expected = getTriangles(vertices, indices);
+
+    // Strays at the front shift every index; one at the back must go too
+    const glm::vec3 stray(9.0f);
+    vertices.insert(vertices.begin(), 2, Vertex(stray, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f)));
+    for (unsigned int& index : indices) {
+        index += 2;
+    }
+    vertices.emplace_back(stray, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f));
+
+    MeshOptimizer::optimize(vertices, indices);
+    CHECK(vertices.size() == used);
+    CHECK(std::none_of(vertices.begin(), vertices.end(),
+                       [&](const Vertex& vertex) { return vertex.position == stray; }));
+    CHECK(getTriangles(vertices, indices) == expected);
+
+    // Fetch order is first use
+    unsigned int next = 0;
+    for (unsigned int index : indices) {
+        CHECK(index <= next);
+        next = std::max(next, index + 1);
+    }
+}
+
+TEST_CASE(meshOptimizerImprovesShuffledSphere) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    makeShuffledSphere(32, vertices, indices);
+
+    MeshOptimizationReport report = MeshOptimizer::optimize(vertices, indices);
+    std::cout << "32-segment UV sphere, shuffled: ACMR " << report.before.acmr << " -> " << report.after.acmr
+              << ", ATVR " << report.before.atvr << " -> " << report.after.atvr << std::endl;
+    CHECK(report.after.acmr <= report.before.acmr);
+    CHECK(report.after.acmr < 1.0f);
+
+    // The result matches what analyzeVertexCache() sees in the output
+    VertexCacheStats after = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+    CHECK(after.acmr == report.after.acmr);
+
+    // Already optimized input does not get worse
+    MeshOptimizationReport again = MeshOptimizer::optimize(vertices, indices);
+    CHECK(again.after.acmr <= again.before.acmr + 0.01f);
+}
+
+TEST_CASE(meshOptimizerShortIndexLimit) {
+    // Indices 0..65535 fit in 16 bits; no value is reserved for restart
+    CHECK(MeshOptimizer::fitsShortIndices(0));
+    CHECK(MeshOptimizer::fitsShortIndices(65535));
+    CHECK(MeshOptimizer::fitsShortIndices(65536));
+    CHECK(!MeshOptimizer::fitsShortIndices(65537));
+}
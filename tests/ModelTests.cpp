@@ -0,0 +1,71 @@
+#include "Test.h"
+#include "Mesh.h"
+#include "Model.h"
+#include <memory>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+constexpr float kFineThreshold = 100.0f;     // Level 0 at and above
+constexpr float kCoarseThreshold = 40.0f;    // Level 1 at and above
+
+// Three levels; with no Renderer the meshes upload nothing
+std::shared_ptr<Model> makeLodModel() {
+    auto model = std::make_shared<Model>();
+    for (size_t lod = 0; lod < 3; ++lod) {
+        std::vector<Vertex> vertices = {
+            Vertex(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f)),
+            Vertex(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f)),
+            Vertex(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f))};
+        model->addMesh(std::make_shared<Mesh>(std::move(vertices), std::vector<unsigned int>{0, 1, 2}), lod);
+    }
+    model->setLodThresholds({kFineThreshold, kCoarseThreshold});
+    return model;
+}
+
+} // namespace
+
+TEST_CASE(lodSelectionAppliesHysteresis) {
+    std::shared_ptr<Model> model = makeLodModel();
+    CHECK(model->getLodCount() == 3);
+    const float inside = 1.0f - 0.01f;
+    const float outside = 1.0f + 0.01f;
+    const float up = 1.0f + Model::kLodHysteresis;
+    const float down = 1.0f - Model::kLodHysteresis;
+
+    // Within 15% of either threshold the current level holds
+    CHECK(model->selectLod(kFineThreshold * up * inside, 1) == 1);
+    CHECK(model->selectLod(kFineThreshold, 1) == 1);
+    CHECK(model->selectLod(kCoarseThreshold * down * outside, 1) == 1);
+    CHECK(model->selectLod(kCoarseThreshold, 1) == 1);
+    CHECK(model->selectLod(kFineThreshold * down * outside, 0) == 0);
+    CHECK(model->selectLod(kCoarseThreshold * up * inside, 2) == 2);
+
+    // Crossing one threshold by the margin moves one level
+    CHECK(model->selectLod(kFineThreshold * up * outside, 1) == 0);
+    CHECK(model->selectLod(kCoarseThreshold * down * inside, 1) == 2);
+    CHECK(model->selectLod(kCoarseThreshold * up * outside, 2) == 1);
+    CHECK(model->selectLod(kFineThreshold * down * inside, 0) == 1);
+
+    // A radius clear of both moves all the way in one call
+    CHECK(model->selectLod(kFineThreshold * 2.0f, 2) == 0);
+    CHECK(model->selectLod(kCoarseThreshold * 0.5f, 0) == 2);
+}
+
+TEST_CASE(lodSelectionClampsTheCurrentLevel) {
+    std::shared_ptr<Model> model = makeLodModel();
+
+    // Stale levels, e.g. recorded for a model with more levels, start from
+    // the coarsest one
+    CHECK(model->selectLod(1.0f, 7) == 2);
+    CHECK(model->selectLod(kCoarseThreshold * 1.5f, 7) == 1);
+    CHECK(model->selectLod(kFineThreshold * 2.0f, 255) == 0);
+
+    // A model without levels of detail always draws level 0
+    Model single;
+    CHECK(single.getLodCount() == 1);
+    CHECK(single.selectLod(0.0f, 3) == 0);
+    CHECK(single.selectLod(1000.0f, 0) == 0);
+}
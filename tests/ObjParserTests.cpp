@@ -0,0 +1,188 @@
+#include "Test.h"
+#include "ObjParser.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+// A cells x cells grid of quads split into triangles, every corner with
+// its own texture coordinate and normal indices
+std::string makeGridObj(int cells) {
+    std::string text = "o grid\n";
+    char line[128];
+    int side = cells + 1;
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            float height = 0.25f * std::sin(x * 0.1f) * std::cos(y * 0.1f);
+            std::snprintf(line, sizeof(line), "v %g %g %g\nvt %g %g\nvn 0 1 0\n", x * 0.5f, height, y * 0.5f,
+                          static_cast<float>(x) / cells, static_cast<float>(y) / cells);
+            text += line;
+        }
+    }
+    for (int y = 0; y < cells; ++y) {
+        for (int x = 0; x < cells; ++x) {
+            int a = y * side + x + 1;
+            int b = a + 1;
+            int c = a + side;
+            int d = c + 1;
+            std::snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d\nf %d/%d/%d %d/%d/%d %d/%d/%d\n",
+                          a, a, a, c, c, c, b, b, b, b, b, b, c, c, c, d, d, d);
+            text += line;
+        }
+    }
+    return text;
+}
+
+// The usual first OBJ loader: line by line through iostreams, corners
+// merged through a std::map. Handles only v/vt/vn triangles.
+void parseNaive(const std::string& text, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> normals;
+    std::map<std::tuple<int, int, int>, unsigned int> corners;
+    std::istringstream input(text);
+    std::string line;
+    while (std::getline(input, line)) {
+        std::istringstream stream(line);
+        std::string keyword;
+        stream >> keyword;
+        if (keyword == "v") {
+            glm::vec3 p;
+            stream >> p.x >> p.y >> p.z;
+            positions.push_back(p);
+        } else if (keyword == "vt") {
+            glm::vec2 t;
+            stream >> t.x >> t.y;
+            texCoords.push_back(t);
+        } else if (keyword == "vn") {
+            glm::vec3 n;
+            stream >> n.x >> n.y >> n.z;
+            normals.push_back(n);
+        } else if (keyword == "f") {
+            std::string token;
+            while (stream >> token) {
+                int p = 0, t = 0, n = 0;
+                char slash;
+                std::istringstream corner(token);
+                corner >> p >> slash >> t >> slash >> n;
+                auto key = std::make_tuple(p, t, n);
+                auto it = corners.find(key);
+                if (it == corners.end()) {
+                    it = corners.emplace(key, static_cast<unsigned int>(vertices.size())).first;
+                    vertices.emplace_back(positions[p - 1], normals[n - 1], texCoords[t - 1]);
+                }
+                indices.push_back(it->second);
+            }
+        }
+    }
+}
+
+bool nearlyEqual(const glm::vec3& a, const glm::vec3& b) {
+    glm::vec3 d = a - b;
+    return glm::dot(d, d) < 1e-10f;
+}
+
+} // namespace
+
+TEST_CASE(objParserMergesCornersAndSplitsGroups) {
+    const std::string text =
+        "# quad with shared corners\n"
+        "o first\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+        "vn 0 0 1\n"
+        "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+        "g second\n"
+        "v 0 0 1\nv 1 0 1\nv 0 1 1\n"
+        "f -3 -2 -1\n";
+    std::vector<ObjGroup> groups;
+    std::string error;
+    CHECK(ObjParser::parse(text.data(), text.size(), groups, error));
+    CHECK(groups.size() == 2);
+    if (groups.size() != 2) return;
+
+    // The quad is fanned into two triangles over four shared vertices
+    CHECK(groups[0].name == "first");
+    CHECK(groups[0].vertices.size() == 4);
+    CHECK((groups[0].indices == std::vector<unsigned int>{0, 1, 2, 0, 2, 3}));
+    CHECK(groups[0].vertices[2].position == glm::vec3(1.0f, 1.0f, 0.0f));
+    CHECK(groups[0].vertices[2].texCoords == glm::vec2(1.0f, 1.0f));
+
+    // Relative indices, and a normal generated for the bare triangle
+    CHECK(groups[1].name == "second");
+    CHECK(groups[1].vertices.size() == 3);
+    CHECK(groups[1].vertices[0].position == glm::vec3(0.0f, 0.0f, 1.0f));
+    CHECK(nearlyEqual(groups[1].vertices[0].normal, glm::vec3(0.0f, 0.0f, 1.0f)));
+}
+
+TEST_CASE(objParserRejectsBadFiles) {
+    std::vector<ObjGroup> groups;
+    std::string error;
+    CHECK(!ObjParser::parse("", 0, groups, error));
+
+    const std::string outOfRange = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 9\n";
+    CHECK(!ObjParser::parse(outOfRange.data(), outOfRange.size(), groups, error));
+    CHECK(error == "Face index out of range");
+
+    const std::string noFaces = "v 0 0 0\n";
+    CHECK(!ObjParser::parse(noFaces.data(), noFaces.size(), groups, error));
+}
+
+TEST_CASE(objParserThreadsMatchNaiveParser) {
+    // Large enough to be split into several chunks
+    const std::string text = makeGridObj(250);
+    CHECK(text.size() > 3 * ObjParser::kMinChunkBytes);
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    parseNaive(text, vertices, indices);
+
+    for (unsigned int threads : {1u, 4u}) {
+        std::vector<ObjGroup> groups;
+        std::string error;
+        CHECK(ObjParser::parse(text.data(), text.size(), groups, error, threads));
+        CHECK(groups.size() == 1);
+        if (groups.size() != 1) continue;
+        CHECK(groups[0].indices == indices);
+        CHECK(groups[0].vertices.size() == vertices.size());
+        for (size_t i = 0; i < vertices.size() && i < groups[0].vertices.size(); ++i) {
+            CHECK(nearlyEqual(groups[0].vertices[i].position, vertices[i].position));
+        }
+    }
+}
+
+BENCHMARK(objParsing) {
+    // 708 x 708 cells, just over a million triangles
+    const std::string text = makeGridObj(708);
+    std::cout << "OBJ with 1M triangles, " << text.size() / (1024.0 * 1024.0) << " MiB:" << std::endl;
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    double naiveMs = Test::measureMilliseconds([&]() { parseNaive(text, vertices, indices); });
+    std::cout << "  iostream + std::map: " << naiveMs << " ms" << std::endl;
+
+    std::vector<unsigned int> threadCounts = {1};
+    if (std::thread::hardware_concurrency() > 1) {
+        threadCounts.push_back(std::thread::hardware_concurrency());
+    }
+    for (unsigned int threads : threadCounts) {
+        std::vector<ObjGroup> groups;
+        std::string error;
+        double parseMs = Test::measureMilliseconds([&]() {
+            ObjParser::parse(text.data(), text.size(), groups, error, threads);
+        });
+        Test::keep(static_cast<double>(groups.empty() ? 0 : groups[0].indices.size()));
+        std::cout << "  ObjParser, " << threads << " thread(s): " << parseMs << " ms (" << naiveMs / parseMs
+                  << "x)" << std::endl;
+    }
+}
@@ -0,0 +1,109 @@
+#include "Test.h"
+#include "UniformTable.h"
+#include <iostream>
+#include <string>
+
+using namespace RenderEngine;
+
+namespace {
+
+// Reference values of 32-bit FNV-1a
+static_assert(hashUniformName("") == 2166136261u, "FNV-1a offset basis");
+static_assert(hashUniformName("a") == 0xe40c292cu, "FNV-1a of \"a\"");
+
+constexpr uint32_t kShininessUniform = hashUniformName("shininess");
+
+const char* const kUniformNames[] = {
+    "model", "normalMatrix", "objectColor", "shininess", "diffuseMap", "normalMap",
+    "lightCount", "lightPositions[0]", "lightPositions[1]", "lightPositions[2]", "lightPositions[3]",
+    "lightColors[0]", "lightColors[1]", "lightColors[2]", "lightColors[3]", "time",
+};
+
+// Two names FNV-1a maps to the same hash
+static_assert(hashUniformName("u8kifaaa") == hashUniformName("upyahaaa"), "colliding uniform names");
+
+// Locations follow kUniformNames, as if reflected from one program
+UniformTable makeTable() {
+    UniformTable table;
+    int location = 0;
+    for (const char* name : kUniformNames) {
+        table.add(name, location++, 0);
+    }
+    CHECK(table.build());
+    return table;
+}
+
+int lookup(const UniformTable& table, uint32_t nameHash) {
+    const UniformTable::UniformInfo* info = table.find(nameHash);
+    return info ? info->location : -1;
+}
+
+} // namespace
+
+TEST_CASE(uniformTableFindsEveryName) {
+    UniformTable table = makeTable();
+    CHECK(table.size() == sizeof(kUniformNames) / sizeof(kUniformNames[0]));
+    for (size_t i = 0; i < table.size(); ++i) {
+        CHECK(table.find(kUniformNames[i]) != nullptr);
+        CHECK(lookup(table, hashUniformName(kUniformNames[i])) == static_cast<int>(i));
+    }
+    CHECK(lookup(table, kShininessUniform) == 3);
+    CHECK(table.find("missing") == nullptr);
+}
+
+TEST_CASE(uniformTableRejectsHashCollisions) {
+    UniformTable table;
+    table.add("model", 0, 0);
+    table.add("u8kifaaa", 1, 0);
+    table.add("upyahaaa", 2, 0);
+    CHECK(!table.build());
+    CHECK(table.empty());
+    CHECK(table.find("model") == nullptr);
+
+    // A rebuilt table without the collision loads again
+    table.add("model", 0, 0);
+    table.add("u8kifaaa", 1, 0);
+    CHECK(table.build());
+    CHECK(lookup(table, hashUniformName("u8kifaaa")) == 1);
+
+    // Lookups only see the hash, which is why build() refuses collisions
+    CHECK(lookup(table, hashUniformName("upyahaaa")) == 1);
+}
+
+BENCHMARK(uniformLookup) {
+    const UniformTable table = makeTable();
+    const int calls = 10000000;
+
+    // Name-based setters: a std::string per call, hashed at run time
+    double byName = Test::measureMilliseconds([&]() {
+        long sum = 0;
+        for (int i = 0; i < calls; ++i) {
+            std::string name = "shininess";
+            sum += lookup(table, hashUniformName(name.c_str()));
+        }
+        Test::keep(static_cast<double>(sum));
+    });
+
+    // Hash folded at compile time, table searched per call
+    double byHash = Test::measureMilliseconds([&]() {
+        long sum = 0;
+        for (int i = 0; i < calls; ++i) {
+            sum += lookup(table, kShininessUniform);
+        }
+        Test::keep(static_cast<double>(sum));
+    });
+
+    // Handle resolved once, as RenderQueue and Game do
+    double byHandle = Test::measureMilliseconds([&]() {
+        const int location = lookup(table, kShininessUniform);
+        long sum = 0;
+        for (int i = 0; i < calls; ++i) {
+            sum += location;
+        }
+        Test::keep(static_cast<double>(sum));
+    });
+
+    std::cout << "Uniform lookup per call, CPU side without the GL calls: name " << byName * 1e6 / calls
+              << " ns, constexpr hash " << byHash * 1e6 / calls << " ns, resolved handle "
+              << byHandle * 1e6 / calls << " ns" << std::endl;
+}
@@ -0,0 +1,159 @@
+#include "Test.h"
+#include "SpatialHash.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+struct Sphere {
+    glm::vec3 center;
+    float radius;
+    bool active;
+};
+
+std::vector<SpatialHash::Id> querySphere(const SpatialHash& hash, const glm::vec3& center, float radius) {
+    std::vector<SpatialHash::Id> ids;
+    hash.forEachInSphere(center, radius, [&](SpatialHash::Id id) { ids.push_back(id); });
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+std::vector<SpatialHash::Id> queryAABB(const SpatialHash& hash, const glm::vec3& min, const glm::vec3& max) {
+    std::vector<SpatialHash::Id> ids;
+    hash.forEachInAABB(min, max, [&](SpatialHash::Id id) { ids.push_back(id); });
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+std::vector<SpatialHash::Id> bruteForceSphere(const std::vector<Sphere>& spheres, const glm::vec3& center,
+                                              float radius) {
+    std::vector<SpatialHash::Id> ids;
+    for (size_t id = 0; id < spheres.size(); ++id) {
+        glm::vec3 d = spheres[id].center - center;
+        float r = radius + spheres[id].radius;
+        if (spheres[id].active && glm::dot(d, d) < r * r) {
+            ids.push_back(static_cast<SpatialHash::Id>(id));
+        }
+    }
+    return ids;
+}
+
+std::vector<SpatialHash::Id> bruteForceAABB(const std::vector<Sphere>& spheres, const glm::vec3& min,
+                                            const glm::vec3& max) {
+    std::vector<SpatialHash::Id> ids;
+    for (size_t id = 0; id < spheres.size(); ++id) {
+        glm::vec3 d = spheres[id].center - glm::clamp(spheres[id].center, min, max);
+        if (spheres[id].active && glm::dot(d, d) <= spheres[id].radius * spheres[id].radius) {
+            ids.push_back(static_cast<SpatialHash::Id>(id));
+        }
+    }
+    return ids;
+}
+
+// Sorted results also catch an id reported twice
+void checkQueries(const SpatialHash& hash, const std::vector<Sphere>& spheres, float extent, float maxQuery,
+                  std::mt19937& rng) {
+    std::uniform_real_distribution<float> position(-extent, extent);
+    std::uniform_real_distribution<float> size(0.0f, maxQuery);
+    for (int query = 0; query < 200; ++query) {
+        glm::vec3 center(position(rng), position(rng), position(rng));
+        float radius = size(rng);
+        CHECK(querySphere(hash, center, radius) == bruteForceSphere(spheres, center, radius));
+
+        glm::vec3 halfExtent(size(rng), size(rng), size(rng));
+        CHECK(queryAABB(hash, center - halfExtent, center + halfExtent) ==
+              bruteForceAABB(spheres, center - halfExtent, center + halfExtent));
+    }
+    size_t active = static_cast<size_t>(std::count_if(spheres.begin(), spheres.end(),
+                                                      [](const Sphere& sphere) { return sphere.active; }));
+    CHECK(hash.size() == active);
+}
+
+} // namespace
+
+TEST_CASE(spatialHashQueriesMatchLinearScan) {
+    std::mt19937 rng(5);
+    const float extent = 40.0f;
+    std::uniform_real_distribution<float> position(-extent, extent);
+    std::uniform_real_distribution<float> radius(0.1f, 1.0f);
+
+    // 256 buckets for tens of thousands of cells, so every bucket holds
+    // entries of many cells
+    SpatialHash hash(2.0f, 256);
+    std::vector<Sphere> spheres(3000);
+    for (size_t id = 0; id < spheres.size(); ++id) {
+        spheres[id] = {glm::vec3(position(rng), position(rng), position(rng)), radius(rng), true};
+        hash.insert(static_cast<SpatialHash::Id>(id), spheres[id].center, spheres[id].radius);
+    }
+    // Small queries walk at most 125 cells; large ones cover more cells
+    // than there are buckets and scan the table instead
+    checkQueries(hash, spheres, extent, 1.0f, rng);
+    checkQueries(hash, spheres, extent, 30.0f, rng);
+
+    // Moves within the cell and across cells, with a radius that grows
+    // past every other one
+    std::uniform_real_distribution<float> nudge(-0.2f, 0.2f);
+    for (size_t id = 0; id < spheres.size(); id += 3) {
+        glm::vec3 step = id % 2 == 0 ? glm::vec3(nudge(rng), nudge(rng), nudge(rng))
+                                     : glm::vec3(position(rng), position(rng), position(rng)) - spheres[id].center;
+        spheres[id].center += step;
+        if (id == 300) {
+            spheres[id].radius = 3.0f;
+        }
+        hash.update(static_cast<SpatialHash::Id>(id), spheres[id].center, spheres[id].radius);
+    }
+    checkQueries(hash, spheres, extent, 1.0f, rng);
+    checkQueries(hash, spheres, extent, 30.0f, rng);
+
+    // Removed ids disappear; reinserting one, at its old place or a new
+    // one, brings it back exactly once
+    for (size_t id = 0; id < spheres.size(); id += 5) {
+        hash.remove(static_cast<SpatialHash::Id>(id));
+        spheres[id].active = false;
+    }
+    for (size_t id = 0; id < spheres.size(); id += 10) {
+        if (id % 20 == 0) {
+            spheres[id].center = glm::vec3(position(rng), position(rng), position(rng));
+        }
+        hash.insert(static_cast<SpatialHash::Id>(id), spheres[id].center, spheres[id].radius);
+        spheres[id].active = true;
+    }
+    checkQueries(hash, spheres, extent, 1.0f, rng);
+    checkQueries(hash, spheres, extent, 30.0f, rng);
+}
+
+TEST_CASE(spatialHashSeparatesCellsSharingABucket) {
+    // Cells 64 apart on x land in the same bucket of a 64-bucket table, so
+    // single-cell queries walk a bucket holding entries of other cells
+    SpatialHash hash(1.0f, 64);
+    hash.insert(0, glm::vec3(0.5f), 0.25f);
+    hash.insert(1, glm::vec3(64.5f, 0.5f, 0.5f), 0.25f);
+    hash.insert(2, glm::vec3(-63.5f, 0.5f, 0.5f), 0.25f);
+
+    CHECK(querySphere(hash, glm::vec3(0.5f), 0.1f) == std::vector<SpatialHash::Id>{0});
+    CHECK(queryAABB(hash, glm::vec3(64.4f, 0.4f, 0.4f), glm::vec3(64.6f, 0.6f, 0.6f)) ==
+          std::vector<SpatialHash::Id>{1});
+    CHECK(querySphere(hash, glm::vec3(0.0f), 70.0f) == (std::vector<SpatialHash::Id>{0, 1, 2}));
+
+    // Moving into another cell unlinks from the old one
+    hash.update(1, glm::vec3(0.5f, 0.5f, 3.5f), 0.25f);
+    CHECK(queryAABB(hash, glm::vec3(64.4f, 0.4f, 0.4f), glm::vec3(64.6f, 0.6f, 0.6f)).empty());
+    CHECK(querySphere(hash, glm::vec3(0.5f, 0.5f, 3.5f), 0.1f) == std::vector<SpatialHash::Id>{1});
+
+    // Inserting an id that is present moves it rather than adding a copy
+    hash.insert(2, glm::vec3(0.5f), 0.25f);
+    CHECK(hash.size() == 3);
+    CHECK(querySphere(hash, glm::vec3(0.5f), 0.1f) == (std::vector<SpatialHash::Id>{0, 2}));
+    CHECK(querySphere(hash, glm::vec3(-63.5f, 0.5f, 0.5f), 0.1f).empty());
+
+    hash.remove(0);
+    hash.remove(0);
+    CHECK(hash.size() == 2);
+    CHECK(!hash.contains(0));
+    CHECK(querySphere(hash, glm::vec3(0.5f), 0.1f) == std::vector<SpatialHash::Id>{2});
+    hash.insert(0, glm::vec3(0.5f), 0.25f);
+    CHECK(querySphere(hash, glm::vec3(0.5f), 0.1f) == (std::vector<SpatialHash::Id>{0, 2}));
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+
+namespace RenderEngine {
+namespace Test {
+
+/**
+ * @brief Adds a test or benchmark to engine_tests
+ *
+ * Created at static initialization by TEST_CASE and BENCHMARK. A plain
+ * run executes every test; --bench executes the benchmarks instead, since
+ * they size their workloads for timing rather than for a quick check.
+ * Either can be narrowed to the names containing a filter argument.
+ */
+class Registration {
+public:
+    using Function = void (*)();
+
+    Registration(const char* name, Function function, bool benchmark);
+};
+
+// Records a failed CHECK; the test keeps running
+void reportFailure(const char* file, int line, const char* expression);
+
+// Stores a benchmark result where the optimizer cannot discard it
+void keep(double value);
+
+// Wall time of fn() in milliseconds
+template <typename Fn>
+double measureMilliseconds(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace Test
+} // namespace RenderEngine
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static const ::RenderEngine::Test::Registration name##Registration(#name, name, false); \
+    static void name()
+
+#define BENCHMARK(name) \
+    static void name(); \
+    static const ::RenderEngine::Test::Registration name##Registration(#name, name, true); \
+    static void name()
+
+#define CHECK(expression) \
+    do { \
+        if (!(expression)) { \
+            ::RenderEngine::Test::reportFailure(__FILE__, __LINE__, #expression); \
+        } \
+    } while (false)
@@ -0,0 +1,81 @@
+#include "Test.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+/**
+ * @file TestMain.cpp
+ * @brief Entry point of engine_tests
+ *
+ * engine_tests [--bench] [filter]
+ */
+
+namespace RenderEngine {
+namespace Test {
+
+namespace {
+
+struct Entry {
+    const char* name;
+    Registration::Function function;
+    bool benchmark;
+};
+
+// Function-local so registrations from any translation unit find it constructed
+std::vector<Entry>& getRegistry() {
+    static std::vector<Entry> registry;
+    return registry;
+}
+
+int s_failures = 0;
+volatile double s_sink = 0.0;
+
+} // namespace
+
+Registration::Registration(const char* name, Function function, bool benchmark) {
+    getRegistry().push_back({name, function, benchmark});
+}
+
+void reportFailure(const char* file, int line, const char* expression) {
+    std::cerr << file << ":" << line << ": CHECK(" << expression << ") failed" << std::endl;
+    s_failures++;
+}
+
+void keep(double value) {
+    s_sink = value;
+}
+
+} // namespace Test
+} // namespace RenderEngine
+
+int main(int argc, char** argv) {
+    using namespace RenderEngine::Test;
+
+    bool benchmarks = false;
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bench") == 0) {
+            benchmarks = true;
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    int run = 0;
+    int failed = 0;
+    for (const Entry& entry : getRegistry()) {
+        if (entry.benchmark != benchmarks) continue;
+        if (filter && !std::strstr(entry.name, filter)) continue;
+
+        std::cout << "[ RUN  ] " << entry.name << std::endl;
+        int failuresBefore = s_failures;
+        entry.function();
+        bool passed = s_failures == failuresBefore;
+        std::cout << (passed ? "[  OK  ] " : "[ FAIL ] ") << entry.name << std::endl;
+        run++;
+        failed += passed ? 0 : 1;
+    }
+
+    std::cout << run - failed << "/" << run << (benchmarks ? " benchmarks" : " tests") << " passed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
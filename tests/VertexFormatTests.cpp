@@ -0,0 +1,159 @@
+#include "Test.h"
+#include "VertexFormat.h"
+#include "Vertex.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace RenderEngine;
+
+namespace {
+
+// Mirrors vertexNormal() in the packed GLSL inputs
+glm::vec3 decodeOctahedral(const std::int16_t encoded[2]) {
+    float x = std::max(encoded[0] / 32767.0f, -1.0f);
+    float y = std::max(encoded[1] / 32767.0f, -1.0f);
+    glm::vec3 n(x, y, 1.0f - std::fabs(x) - std::fabs(y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+float decodeHalf(std::uint16_t half) {
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    float magnitude = exponent == 0 ? std::ldexp(static_cast<float>(mantissa), -24)
+                                    : std::ldexp(static_cast<float>(mantissa | 0x400), exponent - 25);
+    return (half & 0x8000) ? -magnitude : magnitude;
+}
+
+glm::vec3 randomUnitVector(std::mt19937& rng) {
+    std::normal_distribution<float> gaussian;
+    glm::vec3 v;
+    do {
+        v = glm::vec3(gaussian(rng), gaussian(rng), gaussian(rng));
+    } while (glm::dot(v, v) < 1e-6f);
+    return glm::normalize(v);
+}
+
+// A bumpy sphere, like a scanned or sculpted asset
+std::vector<Vertex> makeMesh(size_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Vertex> vertices;
+    vertices.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 normal = randomUnitVector(rng);
+        vertices.emplace_back(normal * (5.0f + unit(rng)), normal, glm::vec2(unit(rng), unit(rng)));
+    }
+    return vertices;
+}
+
+template <typename T>
+void readAttribute(const std::vector<unsigned char>& packed, const VertexFormat& format, size_t vertex,
+                   int attribute, T* values, int count) {
+    std::memcpy(values, packed.data() + vertex * format.stride + format.attributes[attribute].offset,
+                sizeof(T) * count);
+}
+
+} // namespace
+
+TEST_CASE(halfEncodingRoundsToNearest) {
+    CHECK(encodeHalf(0.0f) == 0x0000);
+    CHECK(encodeHalf(-0.0f) == 0x8000);
+    CHECK(encodeHalf(1.0f) == 0x3C00);
+    CHECK(encodeHalf(-2.0f) == 0xC000);
+    CHECK(encodeHalf(0.5f) == 0x3800);
+    CHECK(encodeHalf(65504.0f) == 0x7BFF);
+    CHECK(encodeHalf(1e6f) == 0x7C00);
+    CHECK(encodeHalf(std::ldexp(1.0f, -24)) == 0x0001);
+
+    // Texture coordinates in [0, 1] keep 11 significant bits
+    std::mt19937 rng(31);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < 10000; ++i) {
+        float value = unit(rng);
+        CHECK(std::fabs(decodeHalf(encodeHalf(value)) - value) <= std::ldexp(1.0f, -12));
+    }
+}
+
+TEST_CASE(octahedralNormalsStayAccurate) {
+    std::mt19937 rng(33);
+    float worstDegrees = 0.0f;
+    for (int i = 0; i < 100000; ++i) {
+        glm::vec3 normal = randomUnitVector(rng);
+        std::int16_t encoded[2];
+        encodeOctahedral(normal, encoded);
+        // The cross product keeps precision at small angles where acos does not
+        float sine = std::min(glm::length(glm::cross(decodeOctahedral(encoded), normal)), 1.0f);
+        worstDegrees = std::max(worstDegrees, std::asin(sine) * 57.29578f);
+    }
+    for (const glm::vec3& axis : {glm::vec3(1, 0, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1)}) {
+        std::int16_t encoded[2];
+        encodeOctahedral(axis, encoded);
+        CHECK(glm::dot(decodeOctahedral(encoded), axis) > 0.99999f);
+    }
+    CHECK(worstDegrees < 0.01f);
+    std::cout << "Worst octahedral normal error: " << worstDegrees << " degrees" << std::endl;
+}
+
+TEST_CASE(packedVerticesDecodeToTheSource) {
+    std::mt19937 rng(35);
+    std::vector<Vertex> vertices = makeMesh(1000, rng);
+
+    for (VertexPacking packing : {VertexPacking::Float, VertexPacking::Compact, VertexPacking::Quantized}) {
+        const VertexFormat& format = getVertexFormat(packing);
+        std::vector<unsigned char> packed;
+        glm::mat4 transform = packVertices(vertices, packing, packed);
+        CHECK(packed.size() == vertices.size() * format.stride);
+
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            glm::vec3 position;
+            if (packing == VertexPacking::Quantized) {
+                std::uint16_t quantized[3];
+                readAttribute(packed, format, i, 0, quantized, 3);
+                glm::vec4 stored(quantized[0] / 65535.0f, quantized[1] / 65535.0f, quantized[2] / 65535.0f, 1.0f);
+                glm::vec4 world = transform * stored;
+                position = glm::vec3(world.x, world.y, world.z);
+            } else {
+                readAttribute(packed, format, i, 0, &position.x, 3);
+            }
+            // Within a quantization step of the 12-unit bounds per axis
+            glm::vec3 error = position - vertices[i].position;
+            CHECK(glm::dot(error, error) < 3.0f * 2e-4f * 2e-4f);
+
+            if (packing != VertexPacking::Float) {
+                std::int16_t normal[2];
+                std::uint16_t texCoords[2];
+                readAttribute(packed, format, i, 1, normal, 2);
+                readAttribute(packed, format, i, 2, texCoords, 2);
+                CHECK(glm::dot(decodeOctahedral(normal), vertices[i].normal) > 0.9999f);
+                CHECK(std::fabs(decodeHalf(texCoords[0]) - vertices[i].texCoords.x) <= std::ldexp(1.0f, -12));
+            }
+        }
+    }
+}
+
+BENCHMARK(vertexPackingMemory) {
+    const size_t count = 4000000;
+    std::mt19937 rng(37);
+    std::vector<Vertex> vertices = makeMesh(count, rng);
+
+    // Render time needs a GL context; this reports what each packing saves
+    // in vertex memory and bandwidth, and what packing costs at load time
+    std::cout << count << " vertices:" << std::endl;
+    size_t floatBytes = count * getVertexFormat(VertexPacking::Float).stride;
+    for (VertexPacking packing : {VertexPacking::Float, VertexPacking::Compact, VertexPacking::Quantized}) {
+        std::vector<unsigned char> packed;
+        double packMs = Test::measureMilliseconds([&]() { packVertices(vertices, packing, packed); });
+        Test::keep(packed[packed.size() / 2]);
+        const char* name = packing == VertexPacking::Float ? "Float" :
+                           packing == VertexPacking::Compact ? "Compact" : "Quantized";
+        std::cout << "  " << name << ": " << getVertexFormat(packing).stride << " bytes/vertex, "
+                  << packed.size() / (1024.0 * 1024.0) << " MiB (" << 100.0 * packed.size() / floatBytes
+                  << "% of Float), packed in " << packMs << " ms" << std::endl;
+    }
+}
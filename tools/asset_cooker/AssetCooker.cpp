@@ -0,0 +1,319 @@
+#include "AssetCooker.h"
+#include "CookedMesh.h"
+#include "ContentHash.h"
+#include "GlbParser.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace RenderEngine {
+
+namespace {
+
+// The first generated level clusters on a grid of this fraction of the
+// bounding radius; every further level doubles the cell size
+constexpr float kFirstLodCellFraction = 1.0f / 64.0f;
+// A level is only kept if it has at most this fraction of the previous
+// level's triangles
+constexpr float kMinLodReduction = 0.75f;
+// Largest silhouette deviation, in pixels, tolerated before a finer LOD is used
+constexpr float kLodMaxErrorPixels = 1.0f;
+
+struct SourceMesh {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+std::string lowercaseExtension(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+bool isCookable(const fs::path& path) {
+    std::string extension = lowercaseExtension(path);
+    return extension == ".obj" || extension == ".glb";
+}
+
+bool isInsideDirectory(const fs::path& file, const fs::path& directory) {
+    fs::path relative = file.lexically_normal().lexically_relative(directory.lexically_normal());
+    return !relative.empty() && *relative.begin() != "..";
+}
+
+size_t countTriangles(const std::vector<CookedGeometry>& level) {
+    size_t triangles = 0;
+    for (const auto& geometry : level) {
+        triangles += geometry.indexCount / 3;
+    }
+    return triangles;
+}
+
+} // namespace
+
+AssetCooker::AssetCooker(const CookSettings& settings)
+    : m_settings(settings) {
+}
+
+bool AssetCooker::run(const std::vector<std::string>& inputs, const std::string& outputDirectory) {
+    m_stats = CookStats();
+    std::error_code errorCode;
+    fs::create_directories(outputDirectory, errorCode);
+    if (errorCode) {
+        std::cerr << "Cannot create " << outputDirectory << ": " << errorCode.message() << std::endl;
+        return false;
+    }
+
+    // Directories contribute every OBJ and GLB file below them
+    std::vector<std::string> sources;
+    std::vector<std::string> directories;
+    for (const auto& input : inputs) {
+        if (fs::is_directory(input)) {
+            directories.push_back(input);
+            std::vector<std::string> found;
+            for (const auto& item : fs::recursive_directory_iterator(input)) {
+                if (item.is_regular_file() && isCookable(item.path())) {
+                    found.push_back(item.path().string());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            sources.insert(sources.end(), found.begin(), found.end());
+        } else {
+            sources.push_back(input);
+        }
+    }
+
+    std::string manifestPath = (fs::path(outputDirectory) / AssetManifest::kFileName).string();
+    AssetManifest manifest;
+    std::string error;
+    if (fs::exists(manifestPath) && !manifest.load(manifestPath, error)) {
+        std::cerr << error << "; cooking everything again" << std::endl;
+        manifest.clear();
+    }
+
+    std::vector<Job> jobs(sources.size());
+    for (size_t i = 0; i < sources.size(); ++i) {
+        Job& job = jobs[i];
+        job.source = sources[i];
+        job.name = fs::path(job.source).stem().string();
+        job.output = (fs::path(outputDirectory) / (job.name + ".rmesh")).string();
+        for (size_t j = 0; j < i; ++j) {
+            if (jobs[j].name == job.name) {
+                job.failed = true;
+                job.message = "asset name '" + job.name + "' is already used by " + jobs[j].source;
+            }
+        }
+    }
+
+    // Files are cooked in parallel; a single file gets the parser's own threads
+    unsigned int workerCount = m_settings.jobs > 0 ? m_settings.jobs : std::thread::hardware_concurrency();
+    workerCount = static_cast<unsigned int>(std::min<size_t>(std::max(workerCount, 1u), std::max<size_t>(jobs.size(), 1)));
+    unsigned int parserThreads = workerCount > 1 ? 1 : 0;
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            if (!jobs[i].failed) {
+                runJob(jobs[i], manifest, parserThreads);
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < workerCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    bool success = true;
+    std::vector<std::string> failedSources;
+    std::vector<std::string> cookedNames;
+    for (const Job& job : jobs) {
+        if (job.failed) {
+            std::cerr << job.source << ": " << job.message << std::endl;
+            failedSources.push_back(job.source);
+            ++m_stats.failed;
+            success = false;
+            continue;
+        }
+        std::cout << job.source << ": " << job.message << std::endl;
+        job.skipped ? ++m_stats.skipped : ++m_stats.cooked;
+        cookedNames.push_back(job.name);
+        manifest.set({job.name, fs::path(job.output).filename().string(), job.hash, job.bytes, job.source});
+    }
+
+    // A source that failed this run, or that is gone from a directory it
+    // was found in, must not keep its old output listed. Names cooked this
+    // run keep theirs, so a duplicate stem never removes the first file's.
+    std::vector<AssetManifestEntry> stale;
+    for (const auto& entry : manifest.getEntries()) {
+        if (std::find(cookedNames.begin(), cookedNames.end(), entry.name) != cookedNames.end()) {
+            continue;
+        }
+        bool failed = std::find(failedSources.begin(), failedSources.end(), entry.source) != failedSources.end();
+        bool deleted = std::find(sources.begin(), sources.end(), entry.source) == sources.end() &&
+                       std::any_of(directories.begin(), directories.end(), [&entry](const std::string& directory) {
+                           return isInsideDirectory(entry.source, directory);
+                       });
+        if (failed || deleted) {
+            stale.push_back(entry);
+        }
+    }
+    for (const auto& entry : stale) {
+        std::error_code removeError;
+        fs::remove(AssetManifest::resolve(manifestPath, entry), removeError);
+        manifest.remove(entry.name);
+        ++m_stats.removed;
+        std::cout << entry.source << ": removed " << entry.path << " from the manifest" << std::endl;
+    }
+
+    if (!manifest.save(manifestPath, error)) {
+        std::cerr << error << std::endl;
+        success = false;
+    }
+    std::cout << m_stats.cooked << " cooked, " << m_stats.skipped << " up to date, " << m_stats.failed
+              << " failed, " << m_stats.removed << " removed" << std::endl;
+    return success;
+}
+
+void AssetCooker::runJob(Job& job, const AssetManifest& previous, unsigned int parserThreads) const {
+    auto start = std::chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open(job.source)) {
+        job.failed = true;
+        job.message = "cannot open";
+        return;
+    }
+    job.hash = hashContent(file.data(), file.size(), getSettingsHash());
+
+    std::error_code errorCode;
+    const AssetManifestEntry* entry = previous.find(job.name);
+    if (!m_settings.force && entry && entry->sourceHash == job.hash && fs::exists(job.output, errorCode) &&
+        fs::file_size(job.output, errorCode) == entry->bytes) {
+        job.skipped = true;
+        job.bytes = entry->bytes;
+        job.message = "up to date";
+        return;
+    }
+
+    if (!cookFile(job, file.data(), file.size(), parserThreads)) {
+        job.failed = true;
+        return;
+    }
+    job.bytes = fs::file_size(job.output, errorCode);
+
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    job.message += "cooked to " + job.output + " (" + std::to_string(job.bytes / 1024) + " KB) in " +
+                   std::to_string(static_cast<int>(milliseconds)) + " ms";
+}
+
+bool AssetCooker::cookFile(Job& job, const char* data, size_t size, unsigned int parserThreads) const {
+    std::vector<SourceMesh> sources;
+    std::string error;
+    std::string extension = lowercaseExtension(job.source);
+
+    if (extension == ".obj") {
+        std::vector<ObjGroup> groups;
+        if (!ObjParser::parse(data, size, groups, error, parserThreads)) {
+            job.message = error;
+            return false;
+        }
+        for (auto& group : groups) {
+            sources.push_back({std::move(group.vertices), std::move(group.indices)});
+        }
+    } else if (extension == ".glb") {
+        std::vector<GltfMesh> meshes;
+        std::vector<std::string> warnings;
+        if (!GlbParser::parse(data, size, meshes, error, &warnings)) {
+            job.message = error;
+            return false;
+        }
+        for (const auto& warning : warnings) {
+            job.message += "skipped " + warning + "; ";
+        }
+        for (const auto& mesh : meshes) {
+            for (const auto& primitive : mesh.primitives) {
+                SourceMesh source;
+                GlbParser::decode(primitive, source.vertices, source.indices);
+                sources.push_back(std::move(source));
+            }
+        }
+    } else {
+        job.message = "unsupported file type";
+        return false;
+    }
+    if (sources.empty()) {
+        job.message += "no geometry";
+        return false;
+    }
+
+    glm::vec3 boundsMin = sources[0].vertices[0].position;
+    glm::vec3 boundsMax = boundsMin;
+    for (const auto& source : sources) {
+        for (const Vertex& vertex : source.vertices) {
+            boundsMin = glm::min(boundsMin, vertex.position);
+            boundsMax = glm::max(boundsMax, vertex.position);
+        }
+    }
+    // The radius around the origin that the game derives from the cooked
+    // bounds (Model::getBoundingRadius) and projects to compare with the
+    // thresholds, so both measure the same sphere
+    float radius = glm::length(glm::max(glm::abs(boundsMin), glm::abs(boundsMax)));
+
+    std::vector<std::vector<CookedGeometry>> lods(1);
+    for (const auto& source : sources) {
+        lods[0].push_back(CookedMeshFile::cook(source.vertices, source.indices, m_settings.packing));
+    }
+
+    // Each level is clustered from the source so errors do not accumulate.
+    // Clustering moves vertices by at most cellSize * sqrt(3), which stays
+    // under kLodMaxErrorPixels while the projected radius is below the
+    // threshold.
+    std::vector<float> thresholds;
+    float cellSize = radius * kFirstLodCellFraction;
+    for (int level = 1; level < m_settings.lodLevels && radius > 0.0f; ++level, cellSize *= 2.0f) {
+        std::vector<CookedGeometry> geometries;
+        for (const auto& source : sources) {
+            std::vector<Vertex> vertices = source.vertices;
+            std::vector<unsigned int> indices = source.indices;
+            if (MeshOptimizer::simplify(vertices, indices, cellSize)) {
+                geometries.push_back(CookedMeshFile::cook(std::move(vertices), std::move(indices), m_settings.packing));
+            }
+        }
+        if (geometries.empty() ||
+            static_cast<float>(countTriangles(geometries)) > kMinLodReduction * countTriangles(lods.back())) {
+            continue;
+        }
+        thresholds.push_back(kLodMaxErrorPixels * radius / (cellSize * std::sqrt(3.0f)));
+        lods.push_back(std::move(geometries));
+    }
+
+    if (!CookedMeshFile::write(job.output, lods, thresholds, error)) {
+        job.message = error;
+        return false;
+    }
+    job.message += std::to_string(lods.size()) + " levels, ";
+    return true;
+}
+
+std::uint64_t AssetCooker::getSettingsHash() const {
+    // Outputs depend on the settings and the file format as well as the source
+    std::uint32_t values[] = {kCookedMeshVersion, static_cast<std::uint32_t>(m_settings.packing),
+                              static_cast<std::uint32_t>(m_settings.lodLevels)};
+    return hashContent(values, sizeof(values));
+}
+
+} // namespace RenderEngine
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "VertexFormat.h"
+#include "AssetManifest.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace RenderEngine {
+
+/**
+ * @brief Options of one asset cooker run
+ */
+struct CookSettings {
+    VertexPacking packing = VertexPacking::Compact;
+    int lodLevels = 3;        // Including the source level
+    unsigned int jobs = 0;    // Files cooked at once; 0 uses the hardware concurrency
+    bool force = false;       // Cook even when the manifest says the output is current
+};
+
+/**
+ * @brief Outcome of the last AssetCooker::run()
+ */
+struct CookStats {
+    size_t cooked = 0;
+    size_t skipped = 0;    // Up to date according to the manifest
+    size_t failed = 0;
+    size_t removed = 0;    // Manifest entries dropped with their cooked files
+};
+
+/**
+ * @brief Converts OBJ and GLB files into cooked .rmesh files
+ *
+ * Every input becomes one .rmesh named after its stem in the output
+ * directory, holding one mesh per OBJ group or glTF primitive. Meshes are
+ * cache and fetch optimized, packed as configured, and coarser levels of
+ * detail are generated by vertex clustering with screen-radius thresholds
+ * derived from the clustering error.
+ *
+ * Files are cooked in parallel. The output directory's AssetManifest
+ * records a hash of each source's content and the cook settings; sources
+ * whose hash matches and whose output still exists are skipped. Entries
+ * of sources that fail to cook, or that were deleted from an input
+ * directory, are removed along with their cooked files, so the runtime
+ * never finds stale output through the manifest.
+ */
+class AssetCooker {
+public:
+    explicit AssetCooker(const CookSettings& settings);
+
+    // Returns false if any input failed; the manifest is updated either way
+    bool run(const std::vector<std::string>& inputs, const std::string& outputDirectory);
+    const CookStats& getStats() const { return m_stats; }
+
+private:
+    struct Job {
+        std::string source;
+        std::string name;
+        std::string output;
+        std::uint64_t hash = 0;
+        bool skipped = false;
+        bool failed = false;
+        std::string message;
+        std::uint64_t bytes = 0;
+    };
+
+    void runJob(Job& job, const AssetManifest& previous, unsigned int parserThreads) const;
+    bool cookFile(Job& job, const char* data, size_t size, unsigned int parserThreads) const;
+    std::uint64_t getSettingsHash() const;
+
+    CookSettings m_settings;
+    CookStats m_stats;
+};
+
+} // namespace RenderEngine
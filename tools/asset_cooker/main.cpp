@@ -0,0 +1,83 @@
+#include "AssetCooker.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <exception>
+
+/**
+ * @file main.cpp
+ * @brief Entry point for the offline asset cooker
+ *
+ * Converts OBJ and GLB sources into cooked .rmesh files that
+ * Model::loadCooked maps directly, and maintains the manifest the runtime
+ * uses to find them.
+ */
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options] <output dir> <input file or dir>...\n"
+              << "  --packing <name>      float, compact or quantized (default compact)\n"
+              << "  --lods <n>            Levels of detail including the source (default 3)\n"
+              << "  --jobs <n>            Files cooked at once (default: hardware threads)\n"
+              << "  --force               Cook even inputs the manifest lists as up to date\n"
+              << "  --help                Show this message" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace RenderEngine;
+
+    CookSettings settings;
+    std::vector<std::string> paths;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (std::strcmp(arg, "--packing") == 0 && hasValue) {
+                std::string packing = argv[++i];
+                if (packing == "float") {
+                    settings.packing = VertexPacking::Float;
+                } else if (packing == "compact") {
+                    settings.packing = VertexPacking::Compact;
+                } else if (packing == "quantized") {
+                    settings.packing = VertexPacking::Quantized;
+                } else {
+                    std::cerr << "Unknown packing: " << packing << std::endl;
+                    return EXIT_FAILURE;
+                }
+            } else if (std::strcmp(arg, "--lods") == 0 && hasValue) {
+                settings.lodLevels = std::stoi(argv[++i]);
+            } else if (std::strcmp(arg, "--jobs") == 0 && hasValue) {
+                settings.jobs = static_cast<unsigned int>(std::stoul(argv[++i]));
+            } else if (std::strcmp(arg, "--force") == 0) {
+                settings.force = true;
+            } else if (std::strcmp(arg, "--help") == 0) {
+                printUsage(argv[0]);
+                return EXIT_SUCCESS;
+            } else if (arg[0] == '-') {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+            } else {
+                paths.push_back(arg);
+            }
+        }
+    } catch (const std::exception& e) {
+        // std::stoi and std::stoul throw invalid_argument or out_of_range
+        std::cerr << "Invalid option value (" << e.what() << ")" << std::endl;
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (paths.size() < 2 || settings.lodLevels < 1) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    AssetCooker cooker(settings);
+    std::vector<std::string> inputs(paths.begin() + 1, paths.end());
+    return cooker.run(inputs, paths[0]) ? EXIT_SUCCESS : EXIT_FAILURE;
+}